@@ -9,9 +9,19 @@
 #include <gtest/gtest.h>
 
 #include "../../Source/Core/Containers/Array.h"
+#include "../../Source/Core/Containers/InlineArray.h"
 #include "../../Source/Core/Containers/LocklessQueue.h"
+#include "../../Source/Core/Containers/MPSCQueue.h"
+#include "../../Source/Core/Containers/SPSCQueue.h"
 #include "../../Source/Core/Containers/TightlyPackedArray.h"
+#include "../../Source/Core/Containers/WorkStealingDeque.h"
+#include "../../Source/Core/Utility/Timer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
 #include <thread>
+#include <utility>
 
 using namespace Qi;
 
@@ -52,11 +62,19 @@ TEST(Array, Resize)
     a.PushBack(2);
     
     a.Resize(2);
+    EXPECT_EQ(2, a.GetSize());
+    a[0] = 5;
+    a[1] = 6;
+    
+    // New elements go after the ones created by Resize().
     a.PushBack(3);
     a.PushBack(4);
     
-    EXPECT_EQ(3, a[0]);
-    EXPECT_EQ(4, a[1]);
+    EXPECT_EQ(4, a.GetSize());
+    EXPECT_EQ(5, a[0]);
+    EXPECT_EQ(6, a[1]);
+    EXPECT_EQ(3, a[2]);
+    EXPECT_EQ(4, a[3]);
 }
 
 TEST(Array, Clear)
@@ -150,6 +168,303 @@ TEST(Array, SortDescending)
     EXPECT_EQ(1,  a[4]);
 }
 
+TEST(Array, MemoryCategory)
+{
+	Array<int> a(MemoryCategory::kAssets);
+	EXPECT_EQ(MemoryCategory::kAssets, a.GetMemoryCategory());
+
+	// Push past the default size so that the array has to grow.
+	for (int ii = 0; ii < 100; ++ii)
+	{
+		a.PushBack(ii);
+	}
+
+	EXPECT_EQ(9, a[9]);
+	EXPECT_EQ(99, a[99]);
+
+	// Copies allocate from the same category as the original.
+	Array<int> b(a);
+	EXPECT_EQ(MemoryCategory::kAssets, b.GetMemoryCategory());
+	EXPECT_EQ(9, b[9]);
+
+	Array<int> c;
+	EXPECT_EQ(MemoryCategory::kGeneral, c.GetMemoryCategory());
+	c.SetMemoryCategory(MemoryCategory::kRendering);
+	c.PushBack(1);
+	EXPECT_EQ(MemoryCategory::kRendering, c.GetMemoryCategory());
+}
+
+namespace
+{
+    ///
+    /// Element which counts how it is constructed, copied, moved and destroyed.
+    ///
+    struct Tracked
+    {
+        static int live;
+        static int copies;
+        static int moves;
+
+        Tracked() : value(0), self(this) { ++live; }
+        explicit Tracked(int v) : value(v), self(this) { ++live; }
+        Tracked(const Tracked &other) : value(other.value), self(this) { ++live; ++copies; }
+        Tracked(Tracked &&other) : value(other.value), self(this) { ++live; ++moves; other.value = -1; }
+        ~Tracked() { EXPECT_EQ(this, self); --live; }
+
+        Tracked &operator=(const Tracked &other) { value = other.value; ++copies; return *this; }
+        Tracked &operator=(Tracked &&other) { value = other.value; other.value = -1; ++moves; return *this; }
+
+        int value;
+        Tracked *self; ///< Breaks if the element is relocated with memcpy.
+    };
+
+    int Tracked::live   = 0;
+    int Tracked::copies = 0;
+    int Tracked::moves  = 0;
+}
+
+TEST(Array, MoveConstructAndAssign)
+{
+    Array<int> a(MemoryCategory::kAssets);
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        a.PushBack(ii);
+    }
+
+    // Moving takes over the buffer instead of copying it.
+    int *elements = &a[0];
+    Array<int> b(std::move(a));
+    EXPECT_EQ(0, a.GetSize());
+    EXPECT_EQ(0, a.GetAllocateSize());
+    EXPECT_EQ(100, b.GetSize());
+    EXPECT_EQ(elements, &b[0]);
+    EXPECT_EQ(MemoryCategory::kAssets, b.GetMemoryCategory());
+
+    Array<int> c;
+    c.PushBack(5);
+    c = std::move(b);
+    EXPECT_EQ(0, b.GetSize());
+    EXPECT_EQ(elements, &c[0]);
+    EXPECT_EQ(99, c[99]);
+
+    // Copy assignment replaces the previous buffer rather than leaking it.
+    MemoryUsage before;
+    MemorySystem::GetInstance().GetMemoryUsage(before, MemoryCategory::kGeneral);
+
+    Array<int> d;
+    d.PushBack(1);
+    for (int ii = 0; ii < 10; ++ii)
+    {
+        d = c;
+    }
+
+    EXPECT_EQ(100, d.GetSize());
+    EXPECT_EQ(42, d[42]);
+    d.Clear();
+
+    MemoryUsage after;
+    MemorySystem::GetInstance().GetMemoryUsage(after, MemoryCategory::kGeneral);
+    EXPECT_EQ(before.numAllocations, after.numAllocations);
+}
+
+TEST(Array, NonTriviallyCopyableElements)
+{
+    Tracked::live   = 0;
+    Tracked::copies = 0;
+    {
+        Array<Tracked> a;
+        for (int ii = 0; ii < 100; ++ii)
+        {
+            a.EmplaceBack(ii);
+        }
+
+        // Growing moves the elements with their move constructor, nothing is copied.
+        EXPECT_EQ(100, Tracked::live);
+        EXPECT_EQ(0, Tracked::copies);
+        for (int ii = 0; ii < 100; ++ii)
+        {
+            EXPECT_EQ(ii, a[ii].value);
+        }
+
+        a.Erase(0);
+        EXPECT_EQ(99, a.GetSize());
+        EXPECT_EQ(1, a[0].value);
+        EXPECT_EQ(99, a[98].value);
+
+        a.SwapErase(0);
+        EXPECT_EQ(98, a.GetSize());
+        EXPECT_EQ(99, a[0].value);
+        EXPECT_EQ(2, a[1].value);
+
+        a.PopBack();
+        EXPECT_EQ(97, a.GetSize());
+        EXPECT_EQ(97, Tracked::live);
+
+        EXPECT_TRUE(a.ShrinkToFit().IsValid());
+        EXPECT_EQ(97, a.GetAllocateSize());
+        EXPECT_EQ(97, Tracked::live);
+        EXPECT_EQ(2, a[1].value);
+
+        Array<Tracked> copy(a);
+        EXPECT_EQ(2 * 97, Tracked::live);
+        EXPECT_EQ(97, Tracked::copies);
+    }
+
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(Array, ReserveAndEmplace)
+{
+    Array<int> a;
+    EXPECT_TRUE(a.Reserve(1000).IsValid());
+    EXPECT_EQ(1000, a.GetAllocateSize());
+    EXPECT_EQ(0, a.GetSize());
+
+    int *elements = nullptr;
+    for (int ii = 0; ii < 1000; ++ii)
+    {
+        a.EmplaceBack(ii);
+        if (ii == 0)
+        {
+            elements = &a[0];
+        }
+    }
+
+    // Nothing was reallocated.
+    EXPECT_EQ(elements, &a[0]);
+    EXPECT_EQ(1000, a.GetAllocateSize());
+
+    // Pushing an element of the array itself while it grows must not read the freed buffer.
+    Array<Tracked> b;
+    b.EmplaceBack(7);
+    while (b.GetSize() < b.GetAllocateSize())
+    {
+        b.PushBack(b[0]);
+    }
+
+    b.PushBack(b[0]);
+    EXPECT_EQ(7, b[b.GetSize() - 1].value);
+
+    a.Clear();
+    EXPECT_TRUE(a.ShrinkToFit().IsValid());
+    EXPECT_EQ(0, a.GetAllocateSize());
+}
+
+TEST(InlineArray, StaysInline)
+{
+    MemoryUsage before;
+    MemorySystem::GetInstance().GetMemoryUsage(before, MemoryCategory::kGeneral);
+
+    InlineArray<int, 8> a;
+    EXPECT_EQ(0, a.GetSize());
+    EXPECT_EQ(8, a.GetAllocateSize());
+    for (int ii = 0; ii < 8; ++ii)
+    {
+        a.PushBack(ii);
+    }
+
+    EXPECT_TRUE(a.IsInline());
+    EXPECT_EQ(7, a[7]);
+
+    // Nothing was allocated while the elements fit into the object.
+    MemoryUsage after;
+    MemorySystem::GetInstance().GetMemoryUsage(after, MemoryCategory::kGeneral);
+    EXPECT_EQ(before.numAllocations, after.numAllocations);
+
+    a.Erase(0);
+    EXPECT_EQ(7, a.GetSize());
+    EXPECT_EQ(1, a[0]);
+
+    a.Sort(InlineArray<int, 8>::SortOrder::kDescending);
+    EXPECT_EQ(7, a[0]);
+    EXPECT_EQ(1, a[6]);
+}
+
+TEST(InlineArray, SpillAndShrink)
+{
+    Tracked::live   = 0;
+    Tracked::copies = 0;
+    {
+        InlineArray<Tracked, 4> a(MemoryCategory::kAssets);
+        for (int ii = 0; ii < 100; ++ii)
+        {
+            a.EmplaceBack(ii);
+        }
+
+        // Spilling moves the inline elements to the heap, nothing is copied.
+        EXPECT_FALSE(a.IsInline());
+        EXPECT_EQ(100, a.GetSize());
+        EXPECT_EQ(100, Tracked::live);
+        EXPECT_EQ(0, Tracked::copies);
+        for (int ii = 0; ii < 100; ++ii)
+        {
+            EXPECT_EQ(ii, a[ii].value);
+        }
+
+        while (a.GetSize() > 3)
+        {
+            a.PopBack();
+        }
+
+        // Shrinking moves the remaining elements back into the object.
+        EXPECT_TRUE(a.ShrinkToFit().IsValid());
+        EXPECT_TRUE(a.IsInline());
+        EXPECT_EQ(4, a.GetAllocateSize());
+        EXPECT_EQ(3, Tracked::live);
+        EXPECT_EQ(2, a[2].value);
+
+        // Pushing an element of the array itself while it spills must not read the moved-from storage.
+        a.PushBack(a[0]);
+        a.PushBack(a[0]);
+        EXPECT_FALSE(a.IsInline());
+        EXPECT_EQ(0, a[4].value);
+    }
+
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(InlineArray, CopyAndMove)
+{
+    InlineArray<int, 4> small;
+    small.PushBack(1);
+    small.PushBack(2);
+
+    InlineArray<int, 4> large;
+    for (int ii = 0; ii < 50; ++ii)
+    {
+        large.PushBack(ii);
+    }
+
+    InlineArray<int, 4> smallCopy(small);
+    EXPECT_TRUE(smallCopy.IsInline());
+    EXPECT_EQ(2, smallCopy[1]);
+
+    InlineArray<int, 4> largeCopy;
+    largeCopy = large;
+    EXPECT_EQ(50, largeCopy.GetSize());
+    EXPECT_NE(&large[0], &largeCopy[0]);
+    EXPECT_EQ(49, largeCopy[49]);
+
+    // Moving inline elements leaves them in the new object, moving a spilled array takes over its buffer.
+    InlineArray<int, 4> smallMoved(std::move(small));
+    EXPECT_EQ(0, small.GetSize());
+    EXPECT_TRUE(smallMoved.IsInline());
+    EXPECT_EQ(1, smallMoved[0]);
+
+    int *elements = &large[0];
+    InlineArray<int, 4> largeMoved;
+    largeMoved.PushBack(7);
+    largeMoved = std::move(large);
+    EXPECT_EQ(0, large.GetSize());
+    EXPECT_TRUE(large.IsInline());
+    EXPECT_EQ(elements, &largeMoved[0]);
+    EXPECT_EQ(50, largeMoved.GetSize());
+
+    largeMoved.Clear();
+    EXPECT_TRUE(largeMoved.IsInline());
+    EXPECT_EQ(4, largeMoved.GetAllocateSize());
+}
+
 TEST(LocklessQueue, ZeroSized)
 {
     LocklessQueue<int> q;
@@ -251,6 +566,457 @@ TEST(LocklessQueue, ThreadedPushPop)
     EXPECT_EQ(0, q.GetSize());
 }
 
+TEST(LocklessQueue, PowerOfTwoSize)
+{
+    LocklessQueue<int> q;
+    q.Init(5);
+    EXPECT_EQ(8, q.GetAllocatedSize());
+
+    // Wrap around the ring several times.
+    int v;
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        EXPECT_TRUE(q.Push(ii));
+        EXPECT_TRUE(q.Push(ii + 1000));
+        EXPECT_TRUE(q.Pop(v));
+        EXPECT_EQ(ii, v);
+        EXPECT_TRUE(q.Pop(v));
+        EXPECT_EQ(ii + 1000, v);
+    }
+
+    EXPECT_EQ(0, q.GetSize());
+}
+
+TEST(LocklessQueue, ElementLifetimes)
+{
+    Tracked::live = 0;
+    {
+        LocklessQueue<Tracked> q;
+        q.Init(16);
+        for (int ii = 0; ii < 10; ++ii)
+        {
+            q.Push(Tracked(ii));
+        }
+
+        EXPECT_EQ(10, Tracked::live);
+
+        Tracked t;
+        EXPECT_TRUE(q.Pop(t));
+        EXPECT_EQ(0, t.value);
+        EXPECT_EQ(10, Tracked::live);
+
+        // Clearing destroys the elements left in the queue.
+        q.Clear();
+        EXPECT_EQ(1, Tracked::live);
+
+        q.Push(Tracked(42));
+    }
+
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(LocklessQueue, ManyProducersAndConsumers)
+{
+    const int numThreads = 4;
+    const int numValuesPerThread = 10000;
+
+    LocklessQueue<int> q;
+    q.Init(64);
+
+    std::atomic<int> popped(0);
+    std::atomic<long long> sum(0);
+    std::thread threads[2 * numThreads];
+    for (int tt = 0; tt < numThreads; ++tt)
+    {
+        threads[tt] = std::thread([&q, tt]()
+        {
+            for (int ii = 0; ii < numValuesPerThread; ++ii)
+            {
+                while (!q.Push(tt * numValuesPerThread + ii))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        threads[numThreads + tt] = std::thread([&q, &popped, &sum]()
+        {
+            int v;
+            while (popped.load() < numThreads * numValuesPerThread)
+            {
+                if (q.Pop(v))
+                {
+                    sum += v;
+                    ++popped;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int tt = 0; tt < 2 * numThreads; ++tt)
+    {
+        threads[tt].join();
+    }
+
+    // Every value came out exactly once.
+    long long total = (long long)numThreads * numValuesPerThread;
+    EXPECT_EQ(total, popped.load());
+    EXPECT_EQ(total * (total - 1) / 2, sum.load());
+    EXPECT_EQ(0, q.GetSize());
+}
+
+TEST(SPSCQueue, PushPopAndBatches)
+{
+    SPSCQueue<int> q;
+    q.Init(6);
+    EXPECT_EQ(8, q.GetAllocatedSize());
+
+    for (int ii = 0; ii < 8; ++ii)
+    {
+        EXPECT_TRUE(q.Push(ii));
+    }
+
+    EXPECT_FALSE(q.Push(8));
+    EXPECT_EQ(8, q.GetSize());
+
+    int v;
+    for (int ii = 0; ii < 5; ++ii)
+    {
+        EXPECT_TRUE(q.Pop(v));
+        EXPECT_EQ(ii, v);
+    }
+
+    // The batch wraps around the end of the ring and is cut off when the queue fills up.
+    int values[10] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+    EXPECT_EQ(5, q.PushBatch(values, 10));
+    EXPECT_EQ(8, q.GetSize());
+
+    int out[16];
+    EXPECT_EQ(8, q.PopBatch(out, 16));
+    EXPECT_EQ(5, out[0]);
+    EXPECT_EQ(7, out[2]);
+    EXPECT_EQ(10, out[3]);
+    EXPECT_EQ(14, out[7]);
+    EXPECT_EQ(0, q.PopBatch(out, 16));
+    EXPECT_FALSE(q.Pop(v));
+}
+
+TEST(SPSCQueue, ElementLifetimes)
+{
+    Tracked::live = 0;
+    {
+        SPSCQueue<Tracked> q;
+        q.Init(4);
+        q.Push(Tracked(1));
+        q.Push(Tracked(2));
+        q.Push(Tracked(3));
+        EXPECT_EQ(3, Tracked::live);
+
+        Tracked t;
+        EXPECT_TRUE(q.Pop(t));
+        EXPECT_EQ(1, t.value);
+        EXPECT_EQ(3, Tracked::live);
+    }
+
+    // The destructor cleans up the elements which were never popped.
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(SPSCQueue, ThreadedProducerConsumer)
+{
+    const uint32 numValues = 1000000;
+
+    SPSCQueue<uint32> q;
+    q.Init(1024);
+
+    std::thread producer([&q, numValues]()
+    {
+        uint32 batch[32];
+        uint32 next = 0;
+        while (next < numValues)
+        {
+            // Alternate single pushes with batches.
+            if (next & 1)
+            {
+                if (!q.Push(next))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                ++next;
+            }
+            else
+            {
+                uint32 count = std::min<uint32>(32, numValues - next);
+                for (uint32 ii = 0; ii < count; ++ii)
+                {
+                    batch[ii] = next + ii;
+                }
+
+                uint32 pushed = q.PushBatch(batch, count);
+                if (pushed == 0)
+                {
+                    std::this_thread::yield();
+                }
+
+                next += pushed;
+            }
+        }
+    });
+
+    // Every value must come out exactly once and in order.
+    bool inOrder = true;
+    uint32 expected = 0;
+    uint32 batch[17];
+    while (expected < numValues)
+    {
+        uint32 count = q.PopBatch(batch, 17);
+        if (count == 0)
+        {
+            std::this_thread::yield();
+        }
+
+        for (uint32 ii = 0; ii < count; ++ii)
+        {
+            inOrder &= (batch[ii] == expected++);
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(0, q.GetSize());
+}
+
+TEST(MPSCQueue, PushPopAndGrow)
+{
+    MPSCQueue<int> q;
+    EXPECT_TRUE(q.Init(16).IsValid());
+    uint32 initialNodes = q.GetNumAllocatedNodes();
+
+    int v;
+    EXPECT_FALSE(q.Pop(v));
+
+    // The queue is unbounded, pushing past the initial pool adds chunks.
+    for (int ii = 0; ii < 1000; ++ii)
+    {
+        EXPECT_TRUE(q.Push(ii));
+    }
+
+    uint32 peakNodes = q.GetNumAllocatedNodes();
+    EXPECT_GT(peakNodes, initialNodes);
+
+    for (int ii = 0; ii < 1000; ++ii)
+    {
+        EXPECT_TRUE(q.Pop(v));
+        EXPECT_EQ(ii, v);
+    }
+
+    EXPECT_FALSE(q.Pop(v));
+
+    // Popped nodes are recycled, refilling the queue does not allocate again.
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int ii = 0; ii < 1000; ++ii)
+        {
+            q.Push(ii);
+        }
+
+        for (int ii = 0; ii < 1000; ++ii)
+        {
+            q.Pop(v);
+        }
+    }
+
+    EXPECT_EQ(peakNodes, q.GetNumAllocatedNodes());
+}
+
+TEST(MPSCQueue, ElementLifetimes)
+{
+    Tracked::live = 0;
+    {
+        MPSCQueue<Tracked> q;
+        q.Init();
+        q.Emplace(1);
+        q.Push(Tracked(2));
+        q.Emplace(3);
+        EXPECT_EQ(3, Tracked::live);
+
+        Tracked t;
+        EXPECT_TRUE(q.Pop(t));
+        EXPECT_EQ(1, t.value);
+        EXPECT_EQ(3, Tracked::live);
+    }
+
+    // The destructor cleans up the elements which were never popped.
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(MPSCQueue, ThreadedProducers)
+{
+    const int numProducers = 4;
+    const int numValuesPerProducer = 50000;
+
+    MPSCQueue<int> q;
+    q.Init();
+
+    std::thread producers[numProducers];
+    for (int tt = 0; tt < numProducers; ++tt)
+    {
+        producers[tt] = std::thread([&q, tt]()
+        {
+            for (int ii = 0; ii < numValuesPerProducer; ++ii)
+            {
+                // Encode the producer in the value to check the per-producer ordering.
+                EXPECT_TRUE(q.Push(ii * numProducers + tt));
+            }
+        });
+    }
+
+    // Elements of one producer come out in the order they were pushed.
+    bool inOrder = true;
+    int next[numProducers] = { 0 };
+    int popped = 0;
+    int v;
+    while (popped < numProducers * numValuesPerProducer)
+    {
+        if (!q.Pop(v))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        int producer = v % numProducers;
+        inOrder &= (v / numProducers == next[producer]);
+        ++next[producer];
+        ++popped;
+    }
+
+    for (int tt = 0; tt < numProducers; ++tt)
+    {
+        producers[tt].join();
+    }
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_FALSE(q.Pop(v));
+}
+
+TEST(WorkStealingDeque, OwnerAndThiefOrder)
+{
+    WorkStealingDeque<int> d;
+    EXPECT_TRUE(d.Init(4).IsValid());
+
+    // Pushing past the initial size grows the buffer.
+    for (int ii = 0; ii < 100; ++ii)
+    {
+        EXPECT_TRUE(d.Push(ii));
+    }
+
+    EXPECT_EQ(100, d.GetSize());
+    EXPECT_EQ(128, d.GetAllocatedSize());
+
+    // The owner works on the newest elements, thieves take the oldest.
+    int v;
+    EXPECT_TRUE(d.Pop(v));
+    EXPECT_EQ(99, v);
+    EXPECT_TRUE(d.Steal(v));
+    EXPECT_EQ(0, v);
+
+    while (d.Pop(v)) {}
+    EXPECT_EQ(1, v);
+    EXPECT_EQ(0, d.GetSize());
+    EXPECT_FALSE(d.Steal(v));
+    EXPECT_FALSE(d.Pop(v));
+}
+
+TEST(WorkStealingDeque, ContentionBenchmark)
+{
+    const int numThieves = 3;
+    const int numJobs = 1 << 20;
+
+    WorkStealingDeque<int> d;
+    d.Init(64);
+
+    // Every job must be executed exactly once, either by the owner or by a thief.
+    std::unique_ptr<std::atomic<int>[]> executed(new std::atomic<int>[numJobs]);
+    for (int ii = 0; ii < numJobs; ++ii)
+    {
+        executed[ii] = 0;
+    }
+
+    std::atomic<int> remaining(numJobs);
+    std::atomic<int> stolen(0);
+    std::thread thieves[numThieves];
+    for (int tt = 0; tt < numThieves; ++tt)
+    {
+        thieves[tt] = std::thread([&]()
+        {
+            int job;
+            while (remaining.load(std::memory_order_relaxed) > 0)
+            {
+                if (d.Steal(job))
+                {
+                    ++executed[job];
+                    ++stolen;
+                    --remaining;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    Timer timer;
+    timer.Start();
+
+    // The owner pushes jobs in bursts and works through them from the bottom.
+    int job;
+    for (int next = 0; next < numJobs; )
+    {
+        for (int ii = 0; ii < 64 && next < numJobs; ++ii)
+        {
+            d.Push(next++);
+        }
+
+        for (int ii = 0; ii < 48 && d.Pop(job); ++ii)
+        {
+            ++executed[job];
+            --remaining;
+        }
+    }
+
+    while (remaining.load() > 0)
+    {
+        if (d.Pop(job))
+        {
+            ++executed[job];
+            --remaining;
+        }
+    }
+
+    float seconds = timer.Stop();
+    for (int tt = 0; tt < numThieves; ++tt)
+    {
+        thieves[tt].join();
+    }
+
+    int executedOnce = 0;
+    for (int ii = 0; ii < numJobs; ++ii)
+    {
+        executedOnce += (executed[ii] == 1);
+    }
+
+    EXPECT_EQ(numJobs, executedOnce);
+    printf("WorkStealingDeque: %d jobs with %d thieves in %.2f ms (%.1f M jobs/s, %d stolen)\n",
+           numJobs, numThieves, seconds * 1000.0f, numJobs / seconds / 1000000.0f, stolen.load());
+}
+
 TEST(TightlyPackedArray, SimpleAddRemove)
 {
 	TightlyPackedArray<int> a;
@@ -294,3 +1060,174 @@ TEST(TightlyPackedArray, RemoveMiddle)
 
 	a.Clear();
 }
+
+TEST(TightlyPackedArray, StaleHandles)
+{
+	TightlyPackedArray<int> a;
+	a.SetSize(4);
+
+	TightlyPackedArray<int>::Handle h1 = a.AquireHandle();
+	TightlyPackedArray<int>::Handle h2 = a.AquireHandle();
+	EXPECT_TRUE(a.IsValid(h1));
+	EXPECT_FALSE(a.IsValid(TightlyPackedArray<int>::INVALID_HANDLE));
+	EXPECT_FALSE(a.IsValid(0));
+
+	a.GetElement(h2) = 2;
+	a.ReleaseHandle(h1);
+	EXPECT_FALSE(a.IsValid(h1));
+
+	// The released slot is reused right away, but the old handle must not alias the new element.
+	TightlyPackedArray<int>::Handle h3 = a.AquireHandle();
+	EXPECT_NE(h1, h3);
+	EXPECT_FALSE(a.IsValid(h1));
+	EXPECT_TRUE(a.IsValid(h3));
+	EXPECT_EQ(2, a.GetElement(h2));
+
+	a.Clear();
+}
+
+TEST(TightlyPackedArray, ReleaseOutOfOrder)
+{
+	TightlyPackedArray<int> a;
+	a.SetSize(8);
+
+	TightlyPackedArray<int>::Handle handles[8];
+	for (int ii = 0; ii < 8; ++ii)
+	{
+		handles[ii] = a.AquireHandle();
+		a.GetElement(handles[ii]) = ii;
+	}
+
+	// Release the high slots first while only a few elements remain.
+	for (int ii = 7; ii >= 2; --ii)
+	{
+		a.ReleaseHandle(handles[ii]);
+	}
+
+	EXPECT_EQ(2, a.GetNumValidHandles());
+	handles[2] = a.AquireHandle();
+	a.GetElement(handles[2]) = 20;
+	a.ReleaseHandle(handles[0]);
+
+	EXPECT_EQ(1, a.GetElement(handles[1]));
+	EXPECT_EQ(20, a.GetElement(handles[2]));
+	EXPECT_FALSE(a.IsValid(handles[0]));
+	EXPECT_FALSE(a.IsValid(handles[7]));
+
+	a.Clear();
+}
+
+TEST(TightlyPackedArray, GrowsInPages)
+{
+	TightlyPackedArray<int> a(MemoryCategory::kEntities);
+	a.SetSize(10);
+	uint32 initialCapacity = a.GetCapacity();
+	EXPECT_GE(initialCapacity, 10);
+
+	TightlyPackedArray<int>::Handle first = a.AquireHandle();
+	a.GetElement(first) = -1;
+	int *firstAddress = &a.GetElement(first);
+
+	// Acquire far more handles than were reserved.
+	const int numHandles = 2000;
+	TightlyPackedArray<int>::Handle handles[numHandles];
+	for (int ii = 0; ii < numHandles; ++ii)
+	{
+		handles[ii] = a.AquireHandle();
+		a.GetElement(handles[ii]) = ii;
+	}
+
+	EXPECT_GT(a.GetCapacity(), initialCapacity);
+	EXPECT_EQ(numHandles + 1, a.GetNumValidHandles());
+
+	// Growing never moved an element.
+	EXPECT_EQ(firstAddress, &a.GetElement(first));
+	EXPECT_EQ(-1, a.GetElement(first));
+
+	// Dense iteration spans all pages.
+	long long sum = 0;
+	for (uint32 ii = 0; ii < a.GetNumValidHandles(); ++ii)
+	{
+		sum += a[ii];
+	}
+
+	EXPECT_EQ((long long)numHandles * (numHandles - 1) / 2 - 1, sum);
+
+	// Releasing packs across page boundaries.
+	for (int ii = 0; ii < numHandles; ii += 2)
+	{
+		a.ReleaseHandle(handles[ii]);
+	}
+
+	for (int ii = 1; ii < numHandles; ii += 2)
+	{
+		EXPECT_EQ(ii, a.GetElement(handles[ii]));
+	}
+
+	TightlyPackedArray<int> copy(a);
+	EXPECT_EQ(a.GetNumValidHandles(), copy.GetNumValidHandles());
+	EXPECT_EQ(1999, copy.GetElement(handles[1999]));
+	EXPECT_NE(&a.GetElement(handles[1999]), &copy.GetElement(handles[1999]));
+
+	a.Clear();
+	EXPECT_EQ(0, a.GetCapacity());
+}
+
+TEST(TightlyPackedArray, BatchedAcquireAndRelease)
+{
+	TightlyPackedArray<int> a;
+	a.SetSize(16);
+
+	const uint32 numHandles = 1000;
+	TightlyPackedArray<int>::Handle handles[numHandles];
+	EXPECT_TRUE(a.AcquireHandles(handles, numHandles).IsValid());
+	EXPECT_EQ(numHandles, a.GetNumValidHandles());
+
+	for (uint32 ii = 0; ii < numHandles; ++ii)
+	{
+		a.GetElement(handles[ii]) = (int)ii;
+	}
+
+	// Release every third handle plus a run at the end, in no particular order.
+	TightlyPackedArray<int>::Handle released[numHandles];
+	uint32 numReleased = 0;
+	for (uint32 ii = numHandles; ii > 0; --ii)
+	{
+		if ((ii - 1) % 3 == 0 || ii > numHandles - 50)
+		{
+			released[numReleased++] = handles[ii - 1];
+		}
+	}
+
+	a.ReleaseHandles(released, numReleased);
+	EXPECT_EQ(numHandles - numReleased, a.GetNumValidHandles());
+
+	// The survivors still resolve to their values and are packed at the front.
+	long long expectedSum = 0;
+	for (uint32 ii = 0; ii < numHandles; ++ii)
+	{
+		bool wasReleased = ((ii % 3) == 0 || ii >= numHandles - 50);
+		EXPECT_EQ(!wasReleased, a.IsValid(handles[ii]));
+		if (!wasReleased)
+		{
+			EXPECT_EQ((int)ii, a.GetElement(handles[ii]));
+			expectedSum += ii;
+		}
+	}
+
+	long long sum = 0;
+	for (uint32 ii = 0; ii < a.GetNumValidHandles(); ++ii)
+	{
+		sum += a[ii];
+	}
+
+	EXPECT_EQ(expectedSum, sum);
+
+	// The released slots are handed out again.
+	uint32 capacity = a.GetCapacity();
+	EXPECT_TRUE(a.AcquireHandles(released, numReleased).IsValid());
+	EXPECT_EQ(numHandles, a.GetNumValidHandles());
+	EXPECT_EQ(capacity, a.GetCapacity());
+
+	a.Clear();
+}
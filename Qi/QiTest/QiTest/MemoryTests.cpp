@@ -0,0 +1,1561 @@
+//
+//  MemoryTests.cpp
+//  QiTest
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "../../Source/Core/Memory/MemorySystem.h"
+#include "../../Source/Core/Memory/AllocationProfiler.h"
+#include "../../Source/Core/Memory/AllocationTracker.h"
+#include "../../Source/Core/Memory/HeapAllocator.h"
+#include "../../Source/Core/Memory/LinearAllocator.h"
+#include "../../Source/Core/Memory/PoolAllocator.h"
+#include "../../Source/Core/Memory/RelocatableAllocator.h"
+#include "../../Source/Core/Memory/RemoteFreeList.h"
+#include "../../Source/Core/Memory/StackAllocator.h"
+#include "../../Source/Core/Memory/TLSFAllocator.h"
+#include "../../Source/Core/Memory/ThreadCache.h"
+#include "../../Source/Core/Memory/VirtualRegionAllocator.h"
+#include "../../Source/Core/Containers/Array.h"
+#include "../../Source/Core/Math/Vec4.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+using namespace Qi;
+
+TEST(LinearAllocator, AllocateAndReset)
+{
+	LinearAllocator allocator;
+	LinearAllocator::Cinfo cinfo;
+	cinfo.capacity = 256;
+	EXPECT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	void *a = allocator.Allocate(10);
+	void *b = allocator.Allocate(10);
+	EXPECT_NE(nullptr, a);
+	EXPECT_NE(nullptr, b);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 16);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % 16);
+	EXPECT_EQ(16, static_cast<char *>(b) - static_cast<char *>(a));
+
+	allocator.Reset();
+	EXPECT_EQ(0, allocator.GetUsedBytes());
+	EXPECT_EQ(a, allocator.Allocate(10));
+
+	allocator.Deinit();
+}
+
+TEST(LinearAllocator, OutOfMemory)
+{
+	LinearAllocator allocator;
+	LinearAllocator::Cinfo cinfo;
+	cinfo.capacity = 64;
+	allocator.Init(&cinfo);
+
+	EXPECT_NE(nullptr, allocator.Allocate(64));
+	EXPECT_EQ(nullptr, allocator.Allocate(1));
+
+	allocator.Deinit();
+}
+
+TEST(LinearAllocator, ExternalBuffer)
+{
+	alignas(16) char buffer[128];
+
+	LinearAllocator allocator;
+	LinearAllocator::Cinfo cinfo;
+	cinfo.capacity = sizeof(buffer);
+	cinfo.buffer   = buffer;
+	allocator.Init(&cinfo);
+
+	EXPECT_EQ(static_cast<void *>(buffer), allocator.Allocate(4));
+
+	allocator.Deinit();
+}
+
+TEST(StackAllocator, BothSidesAndMarkers)
+{
+	StackAllocator allocator;
+	StackAllocator::Cinfo cinfo;
+	cinfo.capacity = 1024;
+	EXPECT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	char *bottom = static_cast<char *>(allocator.AllocateFromSide(StackAllocator::Side::kBottom, 100));
+	char *top = static_cast<char *>(allocator.AllocateFromSide(StackAllocator::Side::kTop, 100));
+	ASSERT_NE(nullptr, bottom);
+	ASSERT_NE(nullptr, top);
+	EXPECT_LT(bottom + 100, top);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(top) % 16);
+
+	// Releasing to a marker only affects allocations made after it on the same side.
+	StackAllocator::Marker topMarker = allocator.GetMarker(StackAllocator::Side::kTop);
+	void *transient = allocator.AllocateFromSide(StackAllocator::Side::kTop, 200, 64);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(transient) % 64);
+	allocator.FreeToMarker(topMarker);
+	EXPECT_EQ(transient, allocator.AllocateFromSide(StackAllocator::Side::kTop, 200, 64));
+	allocator.FreeToMarker(topMarker);
+
+	StackAllocator::Marker bottomMarker = allocator.GetMarker(StackAllocator::Side::kBottom);
+	void *level = allocator.AllocateFromSide(StackAllocator::Side::kBottom, 64);
+	allocator.FreeToMarker(bottomMarker);
+	EXPECT_EQ(level, allocator.AllocateFromSide(StackAllocator::Side::kBottom, 64));
+
+	// The two sides can't overlap.
+	EXPECT_EQ(nullptr, allocator.AllocateFromSide(StackAllocator::Side::kTop, allocator.GetFreeBytes() + 1));
+	EXPECT_EQ(nullptr, allocator.AllocateFromSide(StackAllocator::Side::kBottom, allocator.GetFreeBytes() + 1));
+
+	allocator.Reset();
+	EXPECT_EQ(1024u, allocator.GetFreeBytes());
+
+	allocator.Deinit();
+}
+
+TEST(StackAllocator, ScopedAllocations)
+{
+	StackAllocator allocator;
+	StackAllocator::Cinfo cinfo;
+	cinfo.capacity = 4096;
+	allocator.Init(&cinfo);
+	allocator.SetAllocationSide(StackAllocator::Side::kTop);
+
+	StackAllocator::Marker marker = allocator.GetMarker(StackAllocator::Side::kTop);
+	{
+		AllocatorScope scope(&allocator);
+		EXPECT_EQ(&allocator, MemorySystem::GetInstance().GetScopedAllocator());
+
+		int *values = Qi_AllocateMemoryArray(int, 100);
+		EXPECT_TRUE(allocator.Owns(values));
+		Qi_FreeMemoryArray(values);
+
+		Vec4 *vector = Qi_AllocateMemory(Vec4);
+		EXPECT_TRUE(allocator.Owns(vector));
+
+		// Running out of the scoped allocator returns null without constructing anything.
+		struct LargeObject
+		{
+			LargeObject() { memset(bytes, 0xff, sizeof(bytes)); }
+			char bytes[8192];
+		};
+
+		EXPECT_EQ(nullptr, Qi_AllocateMemory(LargeObject));
+	}
+
+	EXPECT_EQ(nullptr, MemorySystem::GetInstance().GetScopedAllocator());
+	EXPECT_LT(allocator.GetFreeBytes(), 4096u);
+	allocator.FreeToMarker(marker);
+	EXPECT_EQ(4096u, allocator.GetFreeBytes());
+
+	// Outside of the scope allocations go back to the installed allocator.
+	int *value = Qi_AllocateMemory(int);
+	EXPECT_FALSE(allocator.Owns(value));
+	Qi_FreeMemory(value);
+
+	allocator.Deinit();
+}
+
+TEST(MemoryCategory, DedicatedAllocator)
+{
+	MemorySystem &memorySystem = MemorySystem::GetInstance();
+
+	// Categories without a dedicated allocator share the general one.
+	EXPECT_EQ(memorySystem.GetAllocator(), memorySystem.GetAllocator(MemoryCategory::kGame));
+
+	// The memory system takes ownership of the allocator and destroys it in Deinit().
+	TLSFAllocator *allocator = new TLSFAllocator();
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 64 * 1024;
+	allocator->Init(&cinfo);
+	memorySystem.InstallAllocator(MemoryCategory::kGame, allocator);
+	EXPECT_EQ(allocator, memorySystem.GetAllocator(MemoryCategory::kGame));
+	EXPECT_NE(memorySystem.GetAllocator(), memorySystem.GetAllocator(MemoryCategory::kGame));
+
+	int *values = Qi_AllocateMemoryArrayFrom(int, 100, MemoryCategory::kGame);
+	Vec4 *vector = Qi_AllocateMemoryFrom(Vec4, MemoryCategory::kGame);
+
+	AllocatorStats stats;
+	memorySystem.GetAllocatorStats(stats, MemoryCategory::kGame);
+	EXPECT_LE(100 * sizeof(int) + sizeof(Vec4), stats.bytesInUse);
+
+	Qi_FreeMemoryArrayFrom(values, MemoryCategory::kGame);
+	Qi_FreeMemoryFrom(vector, MemoryCategory::kGame);
+
+	memorySystem.GetAllocatorStats(stats, MemoryCategory::kGame);
+	EXPECT_EQ(0, stats.bytesInUse);
+}
+
+TEST(MemoryUsage, CountersAndBudgets)
+{
+	MemorySystem &memorySystem = MemorySystem::GetInstance();
+
+	MemoryUsage before;
+	memorySystem.GetMemoryUsage(before, MemoryCategory::kRendering);
+
+	int *values = Qi_AllocateMemoryArrayFrom(int, 1000, MemoryCategory::kRendering);
+	Vec4 *vector = Qi_AllocateMemoryFrom(Vec4, MemoryCategory::kRendering);
+
+	MemoryUsage usage;
+	memorySystem.GetMemoryUsage(usage, MemoryCategory::kRendering);
+	EXPECT_EQ(before.numAllocations + 2, usage.numAllocations);
+	EXPECT_EQ(before.totalAllocations + 2, usage.totalAllocations);
+	EXPECT_LE(before.bytesInUse + 1000 * sizeof(int) + sizeof(Vec4), usage.bytesInUse);
+	EXPECT_LE(usage.bytesInUse, usage.peakBytesInUse);
+
+	// Going over the budget is reported (once) by the per-frame check.
+	memorySystem.SetMemoryBudget(MemoryCategory::kRendering, 1024);
+	memorySystem.CheckMemoryBudgets();
+	memorySystem.CheckMemoryBudgets();
+	memorySystem.GetMemoryUsage(usage, MemoryCategory::kRendering);
+	EXPECT_EQ(1024, usage.budget);
+
+	Qi_FreeMemoryArrayFrom(values, MemoryCategory::kRendering);
+	Qi_FreeMemoryFrom(vector, MemoryCategory::kRendering);
+	memorySystem.SetMemoryBudget(MemoryCategory::kRendering, 0);
+
+	memorySystem.GetMemoryUsage(usage, MemoryCategory::kRendering);
+	EXPECT_EQ(before.numAllocations, usage.numAllocations);
+	EXPECT_EQ(before.bytesInUse, usage.bytesInUse);
+}
+
+TEST(ScratchMemory, ResetReclaimsMemory)
+{
+	int *values = Qi_AllocateScratchMemoryArray(int, 100);
+	EXPECT_NE(nullptr, values);
+	EXPECT_LE(100 * sizeof(int), MemorySystem::GetInstance().GetScratchAllocator()->GetUsedBytes());
+
+	MemorySystem::GetInstance().ResetScratchAllocators();
+	EXPECT_EQ(0, MemorySystem::GetInstance().GetScratchAllocator()->GetUsedBytes());
+}
+
+void ThreadedGetScratchAllocator(LinearAllocator **allocator)
+{
+	*allocator = MemorySystem::GetInstance().GetScratchAllocator();
+}
+
+TEST(ScratchMemory, PerThreadArenas)
+{
+	LinearAllocator *other = nullptr;
+	std::thread t1(ThreadedGetScratchAllocator, &other);
+	t1.join();
+
+	EXPECT_NE(nullptr, other);
+	EXPECT_NE(other, MemorySystem::GetInstance().GetScratchAllocator());
+}
+
+TEST(ScratchMemory, ArenasReusedAfterThreadExit)
+{
+	MemorySystem &memorySystem = MemorySystem::GetInstance();
+	LinearAllocator *mainArena = memorySystem.GetScratchAllocator();
+
+	MemoryUsage before;
+	memorySystem.GetMemoryUsage(before, MemoryCategory::kGeneral);
+
+	// A thread which exits hands its arena to the next thread asking for one.
+	LinearAllocator *first = nullptr;
+	std::thread t1(ThreadedGetScratchAllocator, &first);
+	t1.join();
+
+	LinearAllocator *second = nullptr;
+	std::thread t2(ThreadedGetScratchAllocator, &second);
+	t2.join();
+
+	EXPECT_NE(nullptr, first);
+	EXPECT_EQ(first, second);
+	EXPECT_NE(mainArena, first);
+
+	// The arena buffers are accounted for, and no new one was needed for the second thread.
+	MemoryUsage after;
+	memorySystem.GetMemoryUsage(after, MemoryCategory::kGeneral);
+	EXPECT_LE(before.numAllocations, after.numAllocations);
+	EXPECT_LE(after.numAllocations, before.numAllocations + 1);
+	EXPECT_LE((uint64)MemorySystem::DEFAULT_SCRATCH_ARENA_SIZE * 2, after.bytesInUse);
+}
+
+TEST(PoolAllocator, ReuseFreedBlocks)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	EXPECT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	void *a = allocator.Allocate(24);
+	void *b = allocator.Allocate(24);
+	EXPECT_NE(a, b);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 16);
+
+	// A freed block is handed out again to the next request of the same size class.
+	allocator.Deallocate(a);
+	EXPECT_EQ(a, allocator.Allocate(32));
+
+	allocator.Deallocate(a);
+	allocator.Deallocate(b);
+	allocator.Deinit();
+}
+
+TEST(PoolAllocator, LargeAllocations)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	char *large = static_cast<char *>(allocator.Allocate(PoolAllocator::GetMaxPooledSize() + 1));
+	EXPECT_NE(nullptr, large);
+	large[PoolAllocator::GetMaxPooledSize()] = 1;
+
+	// Blocks which fall back to the system allocator still report their size.
+	EXPECT_LE(PoolAllocator::GetMaxPooledSize() + 1, allocator.GetAllocationSize(large));
+	large = static_cast<char *>(allocator.Reallocate(large, PoolAllocator::GetMaxPooledSize() + 1, PoolAllocator::GetMaxPooledSize() * 4, Allocator::DEFAULT_ALIGNMENT));
+	EXPECT_NE(nullptr, large);
+	EXPECT_LE(PoolAllocator::GetMaxPooledSize() * 4, allocator.GetAllocationSize(large));
+	allocator.Deallocate(large);
+
+	allocator.Deinit();
+}
+
+TEST(PoolAllocator, RegionExhausted)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 64 * 1024;
+	cinfo.pageSize   = 64 * 1024;
+	allocator.Init(&cinfo);
+
+	// The only page goes to the 16 byte class, other classes fall back to the system allocator.
+	void *small = allocator.Allocate(16);
+	void *other = allocator.Allocate(64);
+	EXPECT_NE(nullptr, small);
+	EXPECT_NE(nullptr, other);
+
+	allocator.Deallocate(small);
+	allocator.Deallocate(other);
+	allocator.Deinit();
+}
+
+void ThreadedPoolAllocations(PoolAllocator *allocator, uint32 size)
+{
+	void *blocks[256];
+	for (int iteration = 0; iteration < 16; ++iteration)
+	{
+		for (int ii = 0; ii < 256; ++ii)
+		{
+			blocks[ii] = allocator->Allocate(size);
+			*static_cast<uint32 *>(blocks[ii]) = ii;
+		}
+
+		for (int ii = 0; ii < 256; ++ii)
+		{
+			EXPECT_EQ((uint32)ii, *static_cast<uint32 *>(blocks[ii]));
+			allocator->Deallocate(blocks[ii]);
+		}
+	}
+}
+
+TEST(PoolAllocator, ThreadedAllocations)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 4 * 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	std::thread t1(ThreadedPoolAllocations, &allocator, 16);
+	std::thread t2(ThreadedPoolAllocations, &allocator, 16);
+	std::thread t3(ThreadedPoolAllocations, &allocator, 100);
+	t1.join();
+	t2.join();
+	t3.join();
+
+	allocator.Deinit();
+}
+
+TEST(TLSFAllocator, AllocateAndFree)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	EXPECT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	void *a = allocator.Allocate(100);
+	void *b = allocator.Allocate(5000);
+	EXPECT_NE(nullptr, a);
+	EXPECT_NE(nullptr, b);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % 16);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % 16);
+
+	allocator.Deallocate(a);
+	allocator.Deallocate(b);
+
+	// Everything has been merged back into one block.
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+	EXPECT_EQ(stats.freeBytes, stats.largestFreeBlock);
+	EXPECT_EQ(0.0f, stats.GetFragmentation());
+
+	allocator.Deinit();
+}
+
+TEST(TLSFAllocator, OutOfMemory)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 64 * 1024;
+	allocator.Init(&cinfo);
+
+	EXPECT_EQ(nullptr, allocator.Allocate(128 * 1024));
+
+	void *block = allocator.Allocate(32 * 1024);
+	EXPECT_NE(nullptr, block);
+	EXPECT_EQ(nullptr, allocator.Allocate(32 * 1024));
+
+	allocator.Deallocate(block);
+	allocator.Deinit();
+}
+
+TEST(TLSFAllocator, Statistics)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	void *blocks[8];
+	for (int ii = 0; ii < 8; ++ii)
+	{
+		blocks[ii] = allocator.Allocate(1024);
+	}
+
+	// Free every other block to fragment the free memory.
+	for (int ii = 0; ii < 8; ii += 2)
+	{
+		allocator.Deallocate(blocks[ii]);
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(4 * 1024, stats.bytesInUse);
+	EXPECT_EQ(8 * 1024, stats.peakBytesInUse);
+	EXPECT_GT(stats.GetFragmentation(), 0.0f);
+
+	for (int ii = 1; ii < 8; ii += 2)
+	{
+		allocator.Deallocate(blocks[ii]);
+	}
+
+	allocator.Deinit();
+}
+
+TEST(TLSFAllocator, RandomAllocations)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 4 * 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	const int numBlocks = 512;
+	unsigned char *blocks[numBlocks] = {};
+	uint32 sizes[numBlocks] = {};
+
+	uint32 seed = 12345;
+	for (int iteration = 0; iteration < 20000; ++iteration)
+	{
+		seed = seed * 1664525 + 1013904223;
+		int index = (seed >> 8) % numBlocks;
+
+		if (blocks[index] != nullptr)
+		{
+			// Make sure nothing else has written over this block.
+			for (uint32 ii = 0; ii < sizes[index]; ++ii)
+			{
+				ASSERT_EQ((unsigned char)index, blocks[index][ii]);
+			}
+
+			allocator.Deallocate(blocks[index]);
+			blocks[index] = nullptr;
+		}
+		else
+		{
+			sizes[index]  = 1 + (seed >> 16) % 4096;
+			blocks[index] = static_cast<unsigned char *>(allocator.Allocate(sizes[index]));
+			ASSERT_NE(nullptr, blocks[index]);
+			memset(blocks[index], index, sizes[index]);
+		}
+	}
+
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		allocator.Deallocate(blocks[ii]);
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+	EXPECT_EQ(stats.freeBytes, stats.largestFreeBlock);
+
+	allocator.Deinit();
+}
+
+static void CheckAlignedAllocations(Allocator &allocator)
+{
+	const uint32 sizes[] = { 1, 24, 64, 100, 1000, 5000 };
+	for (uint32 alignment = 1; alignment <= Allocator::MAX_ALIGNMENT; alignment *= 2)
+	{
+		for (uint32 size : sizes)
+		{
+			char *block = static_cast<char *>(allocator.AllocateAligned(size, alignment));
+			ASSERT_NE(nullptr, block);
+			EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % alignment);
+			EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % Allocator::DEFAULT_ALIGNMENT);
+			memset(block, 0xAB, size);
+			allocator.Deallocate(block);
+		}
+	}
+}
+
+TEST(AlignedAllocation, AllAllocators)
+{
+	LinearAllocator linear;
+	LinearAllocator::Cinfo linearInfo;
+	linearInfo.capacity = 1024 * 1024;
+	linear.Init(&linearInfo);
+	CheckAlignedAllocations(linear);
+	linear.Deinit();
+
+	PoolAllocator pool;
+	PoolAllocator::Cinfo poolInfo;
+	poolInfo.regionSize = 1024 * 1024;
+	pool.Init(&poolInfo);
+	CheckAlignedAllocations(pool);
+	pool.Deinit();
+
+	TLSFAllocator tlsf;
+	TLSFAllocator::Cinfo tlsfInfo;
+	tlsfInfo.regionSize = 1024 * 1024;
+	tlsf.Init(&tlsfInfo);
+	CheckAlignedAllocations(tlsf);
+	tlsf.Deinit();
+
+	HeapAllocator heap;
+	heap.Init(nullptr);
+	CheckAlignedAllocations(heap);
+
+	// Heap blocks remember their size, even when over-aligned.
+	void *block = heap.AllocateAligned(1000, Allocator::MAX_ALIGNMENT);
+	EXPECT_LE(1000u, heap.GetAllocationSize(block));
+	block = heap.Reallocate(block, 1000, 5000, Allocator::MAX_ALIGNMENT);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % Allocator::MAX_ALIGNMENT);
+	EXPECT_LE(5000u, heap.GetAllocationSize(block));
+	heap.Deallocate(block);
+	heap.Deinit();
+}
+
+TEST(AlignedAllocation, TLSFGapsAreReused)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	// Split off free space in front of aligned blocks, then make sure it is merged back.
+	void *blocks[64];
+	for (int ii = 0; ii < 64; ++ii)
+	{
+		blocks[ii] = allocator.AllocateAligned(16 + ii, 64);
+		ASSERT_NE(nullptr, blocks[ii]);
+		EXPECT_EQ(0, reinterpret_cast<uintptr_t>(blocks[ii]) % 64);
+	}
+
+	for (int ii = 0; ii < 64; ++ii)
+	{
+		allocator.Deallocate(blocks[ii]);
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+	EXPECT_EQ(stats.freeBytes, stats.largestFreeBlock);
+
+	allocator.Deinit();
+}
+
+struct alignas(64) CacheLinePadded
+{
+	int value;
+};
+
+TEST(AlignedAllocation, MemorySystemUsesTypeAlignment)
+{
+	CacheLinePadded *single = Qi_AllocateMemory(CacheLinePadded);
+	CacheLinePadded *array = Qi_AllocateMemoryArray(CacheLinePadded, 10);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(single) % 64);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(array) % 64);
+	Qi_FreeMemory(single);
+	Qi_FreeMemoryArray(array);
+
+	Vec4 *vectors = Qi_AllocateMemoryArray(Vec4, 3);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(vectors) % QI_SSE_ALIGNMENT);
+	Qi_FreeMemoryArray(vectors);
+
+	CacheLinePadded *scratch = Qi_AllocateScratchMemoryArray(CacheLinePadded, 4);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(scratch) % 64);
+	MemorySystem::GetInstance().ResetScratchAllocators();
+}
+
+TEST(Reallocate, TLSFGrowsInPlace)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	char *block = static_cast<char *>(allocator.Allocate(1024));
+	std::memset(block, 7, 1024);
+
+	// Nothing follows the block yet, it can grow into the rest of the region.
+	EXPECT_EQ(block, allocator.Reallocate(block, 1024, 64 * 1024));
+	EXPECT_LE(64u * 1024u, allocator.GetAllocationSize(block));
+	EXPECT_EQ(7, block[1023]);
+
+	// Once another block sits behind it the block has to move.
+	void *blocker = allocator.Allocate(16);
+	EXPECT_FALSE(allocator.TryExpandInPlace(block, 128 * 1024));
+	char *moved = static_cast<char *>(allocator.Reallocate(block, 64 * 1024, 128 * 1024));
+	EXPECT_NE(block, moved);
+	EXPECT_EQ(7, moved[0]);
+	EXPECT_EQ(7, moved[1023]);
+
+	// Shrinking always succeeds in place.
+	EXPECT_TRUE(allocator.TryExpandInPlace(moved, 16));
+
+	allocator.Deallocate(moved);
+	allocator.Deallocate(blocker);
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+	EXPECT_EQ(0.0f, stats.GetFragmentation());
+
+	allocator.Deinit();
+}
+
+TEST(Reallocate, LinearGrowsLastAllocation)
+{
+	LinearAllocator allocator;
+	LinearAllocator::Cinfo cinfo;
+	cinfo.capacity = 1024;
+	allocator.Init(&cinfo);
+
+	void *a = allocator.Allocate(64);
+	EXPECT_TRUE(allocator.TryExpandInPlace(a, 512));
+	EXPECT_EQ(512, allocator.GetUsedBytes());
+	EXPECT_FALSE(allocator.TryExpandInPlace(a, 2048));
+
+	// Only the most recent allocation can grow.
+	void *b = allocator.Allocate(64);
+	EXPECT_FALSE(allocator.TryExpandInPlace(a, 600));
+	EXPECT_EQ(b, allocator.Reallocate(b, 64, 128));
+
+	allocator.Deinit();
+}
+
+TEST(Reallocate, MemorySystemArrays)
+{
+	int *values = Qi_AllocateMemoryArray(int, 10);
+	for (int ii = 0; ii < 10; ++ii)
+	{
+		values[ii] = ii;
+	}
+
+	values = Qi_ReallocateMemoryArrayFrom(values, 10, 100000, MemoryCategory::kGeneral);
+	EXPECT_NE(nullptr, values);
+	for (int ii = 0; ii < 10; ++ii)
+	{
+		EXPECT_EQ(ii, values[ii]);
+	}
+
+	values[99999] = 1;
+	Qi_FreeMemoryArray(values);
+}
+
+TEST(VirtualRegionAllocator, GrowWithoutMoving)
+{
+	VirtualRegionAllocator allocator;
+	VirtualRegionAllocator::Cinfo cinfo;
+	cinfo.maxAllocationSize = 16 * 1024 * 1024;
+	cinfo.maxAllocations    = 4;
+	EXPECT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	char *a = static_cast<char *>(allocator.Allocate(100));
+	char *b = static_cast<char *>(allocator.Allocate(100));
+	EXPECT_NE(nullptr, a);
+	EXPECT_NE(nullptr, b);
+	EXPECT_TRUE(allocator.Owns(a));
+	EXPECT_GE(allocator.GetAllocationSize(a), 100u);
+	a[99] = 1;
+
+	// Growing only commits more pages behind the allocation.
+	EXPECT_EQ(a, allocator.Reallocate(a, 100, 8 * 1024 * 1024));
+	EXPECT_EQ(1, a[99]);
+	a[8 * 1024 * 1024 - 1] = 2;
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_LE(8u * 1024u * 1024u, stats.bytesInUse);
+
+	// Shrinking gives the pages back.
+	EXPECT_TRUE(allocator.TryExpandInPlace(a, 100));
+	allocator.GetStats(stats);
+	EXPECT_GT(1024u * 1024u, stats.bytesInUse);
+	EXPECT_EQ(1, a[99]);
+
+	// Allocations cannot grow past their reservation.
+	EXPECT_FALSE(allocator.TryExpandInPlace(a, 32 * 1024 * 1024));
+	EXPECT_EQ(nullptr, allocator.Allocate(32 * 1024 * 1024));
+
+	allocator.Deallocate(a);
+	allocator.Deallocate(b);
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(VirtualRegionAllocator, StableArrayPointers)
+{
+	VirtualRegionAllocator *allocator = new VirtualRegionAllocator();
+	VirtualRegionAllocator::Cinfo cinfo;
+	cinfo.maxAllocationSize = 64 * 1024 * 1024;
+	cinfo.maxAllocations    = 16;
+	allocator->Init(&cinfo);
+	MemorySystem::GetInstance().InstallAllocator(MemoryCategory::kAssets, allocator);
+
+	Array<int> values(MemoryCategory::kAssets);
+	values.PushBack(0);
+	int *first = &values[0];
+
+	for (int ii = 1; ii < 1000000; ++ii)
+	{
+		values.PushBack(ii);
+	}
+
+	EXPECT_EQ(first, &values[0]);
+	EXPECT_EQ(999999, values[999999]);
+}
+
+TEST(LargeAllocations, SizesPastFourGigabytes)
+{
+	// Only address space is reserved up front and only two pages are ever touched.
+	const size_t largeSize = (size_t)5 * 1024 * 1024 * 1024;
+
+	VirtualRegionAllocator allocator;
+	VirtualRegionAllocator::Cinfo cinfo;
+	cinfo.maxAllocationSize = (size_t)8 * 1024 * 1024 * 1024;
+	cinfo.maxAllocations    = 1;
+	ASSERT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	char *buffer = static_cast<char *>(allocator.Allocate(largeSize));
+	ASSERT_NE(nullptr, buffer);
+	EXPECT_LE(largeSize, allocator.GetAllocationSize(buffer));
+	buffer[0] = 1;
+	buffer[largeSize - 1] = 2;
+
+	allocator.Deallocate(buffer);
+	allocator.Deinit();
+}
+
+TEST(LargeAllocations, PoolRegionPastFourGigabytes)
+{
+	// Every size class gets its own page, the last page starts 4 GiB into the region.
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.pageSize   = 1024 * 1024 * 1024;
+	cinfo.regionSize = (size_t)5 * cinfo.pageSize;
+	ASSERT_TRUE(allocator.Init(&cinfo).IsValid());
+
+	const uint32 sizes[] = { 16, 32, 64, 128, 256 };
+	char *blocks[5];
+	for (int ii = 0; ii < 5; ++ii)
+	{
+		blocks[ii] = static_cast<char *>(allocator.Allocate(sizes[ii]));
+		ASSERT_NE(nullptr, blocks[ii]);
+		EXPECT_EQ(sizes[ii], allocator.GetAllocationSize(blocks[ii]));
+		blocks[ii][0] = (char)ii;
+	}
+
+	EXPECT_EQ(blocks[0] + (size_t)4 * cinfo.pageSize, blocks[4]);
+	for (int ii = 0; ii < 5; ++ii)
+	{
+		EXPECT_EQ((char)ii, blocks[ii][0]);
+		allocator.Deallocate(blocks[ii]);
+	}
+
+	// The pooled blocks were found in their pages and returned to their classes.
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+	EXPECT_EQ(blocks[4], allocator.Allocate(256));
+	allocator.Deallocate(blocks[4]);
+
+	allocator.Deinit();
+}
+
+TEST(LargeAllocations, ArraySizeOverflow)
+{
+	// The byte size of these arrays does not fit into a size_t, they must fail instead of wrapping around.
+	const size_t hugeCount = std::numeric_limits<size_t>::max() / sizeof(uint64) + 2;
+	EXPECT_EQ(nullptr, Qi_AllocateMemoryArray(uint64, hugeCount));
+
+	uint64 *values = Qi_AllocateMemoryArray(uint64, 4);
+	ASSERT_NE(nullptr, values);
+	values[3] = 3;
+	EXPECT_EQ(nullptr, Qi_ReallocateMemoryArrayFrom(values, 4, hugeCount, MemoryCategory::kGeneral));
+	EXPECT_EQ(3, values[3]);
+	Qi_FreeMemoryArray(values);
+
+	LinearAllocator allocator;
+	LinearAllocator::Cinfo cinfo;
+	cinfo.capacity = 256;
+	allocator.Init(&cinfo);
+	EXPECT_NE(nullptr, allocator.Allocate(16));
+	EXPECT_EQ(nullptr, allocator.Allocate(std::numeric_limits<size_t>::max()));
+	allocator.Deinit();
+}
+
+TEST(LargePages, AllocatorsFallBackGracefully)
+{
+	// Whether large pages are available depends on the system, the allocators have to work either way.
+	TLSFAllocator tlsf;
+	TLSFAllocator::Cinfo tlsfInfo;
+	tlsfInfo.regionSize    = 4 * 1024 * 1024;
+	tlsfInfo.useLargePages = true;
+	EXPECT_TRUE(tlsf.Init(&tlsfInfo).IsValid());
+
+	char *block = static_cast<char *>(tlsf.Allocate(3 * 1024 * 1024));
+	EXPECT_NE(nullptr, block);
+	std::memset(block, 1, 3 * 1024 * 1024);
+
+	AllocatorStats stats;
+	tlsf.GetStats(stats);
+	EXPECT_GE(2u, stats.largePages);
+	tlsf.Deallocate(block);
+	tlsf.Deinit();
+
+	PoolAllocator pool;
+	PoolAllocator::Cinfo poolInfo;
+	poolInfo.regionSize    = 4 * 1024 * 1024;
+	poolInfo.useLargePages = true;
+	EXPECT_TRUE(pool.Init(&poolInfo).IsValid());
+	pool.Deallocate(pool.Allocate(64));
+	pool.Deinit();
+
+	VirtualRegionAllocator region;
+	VirtualRegionAllocator::Cinfo regionInfo;
+	regionInfo.maxAllocationSize = 16 * 1024 * 1024;
+	regionInfo.maxAllocations    = 2;
+	regionInfo.useLargePages     = true;
+	EXPECT_TRUE(region.Init(&regionInfo).IsValid());
+
+	// Slots are committed in large page steps.
+	void *slot = region.Allocate(100);
+	EXPECT_EQ(0, reinterpret_cast<uintptr_t>(slot) % LARGE_PAGE_SIZE);
+	EXPECT_EQ(LARGE_PAGE_SIZE, region.GetAllocationSize(slot));
+	region.Deallocate(slot);
+	region.Deinit();
+}
+
+TEST(ThreadCache, BatchRefillAndFlush)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	ThreadCache cache;
+	void *block = cache.Allocate(&allocator, 10);
+	ASSERT_NE(nullptr, block);
+
+	// The first allocation pulls a whole batch of blocks out of the allocator.
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_LT(16u, stats.bytesInUse);
+	uint64 batchBytes = stats.bytesInUse;
+
+	// Freed blocks are reused without going back to the allocator.
+	cache.Deallocate(&allocator, block, allocator.GetAllocationSize(block));
+	EXPECT_EQ(block, cache.Allocate(&allocator, 16));
+	allocator.GetStats(stats);
+	EXPECT_EQ(batchBytes, stats.bytesInUse);
+
+	cache.Deallocate(&allocator, block, allocator.GetAllocationSize(block));
+	cache.Flush(&allocator);
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(ThreadCache, AllocatorSizeClasses)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	// The pool rounds these requests up to a larger size class, the blocks are freed by their real size.
+	const uint32 sizes[] = { 80, 112, 160, 224 };
+	ThreadCache cache;
+	for (uint32 size : sizes)
+	{
+		void *block = cache.Allocate(&allocator, size);
+		ASSERT_NE(nullptr, block);
+		EXPECT_LT(size, allocator.GetAllocationSize(block));
+
+		AllocatorStats stats;
+		allocator.GetStats(stats);
+		uint64 bytesInUse = stats.bytesInUse;
+
+		// Freed blocks come back to the magazine the size is allocated from.
+		for (int ii = 0; ii < 1000; ++ii)
+		{
+			cache.Deallocate(&allocator, block, allocator.GetAllocationSize(block));
+			EXPECT_EQ(block, cache.Allocate(&allocator, size));
+		}
+
+		allocator.GetStats(stats);
+		EXPECT_EQ(bytesInUse, stats.bytesInUse);
+		cache.Deallocate(&allocator, block, allocator.GetAllocationSize(block));
+	}
+
+	cache.Flush(&allocator);
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(ThreadCache, OverflowFlushesToAllocator)
+{
+	TLSFAllocator allocator;
+	TLSFAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	// Free far more blocks than a cache holds, the excess must go back to the allocator.
+	const int numBlocks = 1000;
+	void *blocks[numBlocks];
+	EXPECT_EQ(numBlocks, allocator.AllocateBatch(64, blocks, numBlocks));
+
+	ThreadCache cache;
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		cache.Deallocate(&allocator, blocks[ii], allocator.GetAllocationSize(blocks[ii]));
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_GT(numBlocks * 64u, stats.bytesInUse);
+
+	cache.Flush(&allocator);
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+static void ThreadedCacheAllocations(Allocator *allocator)
+{
+	ThreadCache cache;
+	void *blocks[200];
+	for (int iteration = 0; iteration < 50; ++iteration)
+	{
+		for (int ii = 0; ii < 200; ++ii)
+		{
+			blocks[ii] = cache.Allocate(allocator, 1 + (ii % ThreadCache::MAX_CACHED_SIZE));
+			ASSERT_NE(nullptr, blocks[ii]);
+			memset(blocks[ii], ii, 1 + (ii % ThreadCache::MAX_CACHED_SIZE));
+		}
+
+		for (int ii = 0; ii < 200; ++ii)
+		{
+			cache.Deallocate(allocator, blocks[ii], allocator->GetAllocationSize(blocks[ii]));
+		}
+	}
+
+	cache.Flush(allocator);
+}
+
+TEST(ThreadCache, ThreadedAllocations)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 4 * 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	std::thread t1(ThreadedCacheAllocations, &allocator);
+	std::thread t2(ThreadedCacheAllocations, &allocator);
+	std::thread t3(ThreadedCacheAllocations, &allocator);
+	t1.join();
+	t2.join();
+	t3.join();
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(ThreadCache, RemoteFreesBypassAllocator)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	RemoteFreeList remoteFrees[ThreadCache::NUM_SIZE_CLASSES];
+	ThreadCache producer;
+	ThreadCache consumer;
+
+	// The producer allocates, the consumer frees. The consumer's overflow goes to the remote frees
+	// instead of the allocator, and the producer refills from them instead of the allocator.
+	const int numBlocks = 512;
+	void *blocks[numBlocks];
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		blocks[ii] = producer.Allocate(&allocator, 64, remoteFrees);
+		ASSERT_NE(nullptr, blocks[ii]);
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	uint64 bytesInUse = stats.bytesInUse;
+
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		consumer.Deallocate(&allocator, blocks[ii], allocator.GetAllocationSize(blocks[ii]), remoteFrees);
+	}
+
+	allocator.GetStats(stats);
+	EXPECT_EQ(bytesInUse, stats.bytesInUse);
+	EXPECT_LT(0u, remoteFrees[3].GetApproximateCount());
+
+	for (int ii = 0; ii < numBlocks / 2; ++ii)
+	{
+		blocks[ii] = producer.Allocate(&allocator, 64, remoteFrees);
+	}
+
+	allocator.GetStats(stats);
+	EXPECT_EQ(bytesInUse, stats.bytesInUse);
+
+	for (int ii = 0; ii < numBlocks / 2; ++ii)
+	{
+		producer.Deallocate(&allocator, blocks[ii], allocator.GetAllocationSize(blocks[ii]), remoteFrees);
+	}
+
+	producer.Flush(&allocator);
+	consumer.Flush(&allocator);
+	ThreadCache::FlushRemoteFrees(&allocator, remoteFrees);
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(ThreadCache, RemoteFreesTrimmed)
+{
+	PoolAllocator allocator;
+	PoolAllocator::Cinfo cinfo;
+	cinfo.regionSize = 1024 * 1024;
+	allocator.Init(&cinfo);
+
+	RemoteFreeList remoteFrees[ThreadCache::NUM_SIZE_CLASSES];
+	ThreadCache producer;
+	ThreadCache consumer;
+
+	const int numBlocks = 4 * ThreadCache::MAX_REMOTE_FREES;
+	std::vector<void *> blocks(numBlocks);
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		blocks[ii] = producer.Allocate(&allocator, 32, remoteFrees);
+		ASSERT_NE(nullptr, blocks[ii]);
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	uint64 bytesInUse = stats.bytesInUse;
+
+	// Nothing goes back to the allocator while freeing, no matter how much piles up.
+	for (int ii = 0; ii < numBlocks; ++ii)
+	{
+		consumer.Deallocate(&allocator, blocks[ii], allocator.GetAllocationSize(blocks[ii]), remoteFrees);
+	}
+
+	allocator.GetStats(stats);
+	EXPECT_EQ(bytesInUse, stats.bytesInUse);
+	EXPECT_LT(ThreadCache::MAX_REMOTE_FREES, remoteFrees[1].GetApproximateCount());
+
+	ThreadCache::TrimRemoteFrees(&allocator, remoteFrees);
+	EXPECT_EQ(0u, remoteFrees[1].GetApproximateCount());
+	allocator.GetStats(stats);
+	EXPECT_GT(bytesInUse, stats.bytesInUse);
+
+	producer.Flush(&allocator);
+	consumer.Flush(&allocator);
+	allocator.GetStats(stats);
+	EXPECT_EQ(0, stats.bytesInUse);
+
+	allocator.Deinit();
+}
+
+TEST(RemoteFreeList, ThreadedPushAndTake)
+{
+	const uint32 numThreads = 4;
+	const uint32 numBlocksPerThread = 10000;
+
+	struct Block
+	{
+		void *links[2];
+		uint32 value;
+	};
+
+	std::vector<Block> blocks(numThreads * numBlocksPerThread);
+	for (size_t ii = 0; ii < blocks.size(); ++ii)
+	{
+		blocks[ii].value = (uint32)ii;
+	}
+
+	RemoteFreeList list;
+	std::vector<std::thread> threads;
+	for (uint32 tt = 0; tt < numThreads; ++tt)
+	{
+		threads.push_back(std::thread([&list, &blocks, tt, numBlocksPerThread]()
+		{
+			void *batch[8];
+			for (uint32 ii = 0; ii < numBlocksPerThread; ii += 8)
+			{
+				for (uint32 jj = 0; jj < 8; ++jj)
+				{
+					batch[jj] = &blocks[tt * numBlocksPerThread + ii + jj];
+				}
+
+				if (ii % 16 == 0)
+				{
+					list.PushBatch(batch, 8);
+				}
+				else
+				{
+					for (uint32 jj = 0; jj < 8; ++jj)
+					{
+						list.Push(batch[jj]);
+					}
+				}
+			}
+		}));
+	}
+
+	// Take blocks while the producers are still pushing, every block must show up exactly once.
+	std::vector<int> seen(blocks.size(), 0);
+	size_t numTaken = 0;
+	while (numTaken < blocks.size())
+	{
+		for (void *batch = list.TakeAll(); batch != nullptr; batch = RemoteFreeList::GetNextBatch(batch))
+		{
+			for (void *block = batch; block != nullptr; block = RemoteFreeList::GetNext(block))
+			{
+				++seen[static_cast<Block *>(block)->value];
+				++numTaken;
+			}
+		}
+	}
+
+	for (size_t ii = 0; ii < threads.size(); ++ii)
+	{
+		threads[ii].join();
+	}
+
+	EXPECT_EQ(blocks.size(), numTaken);
+	EXPECT_EQ(0u, list.GetApproximateCount());
+	EXPECT_EQ(blocks.size(), (size_t)std::count(seen.begin(), seen.end(), 1));
+}
+
+TEST(AllocationTracker, InsertAndRemove)
+{
+	AllocationTracker tracker;
+	EXPECT_TRUE(tracker.Init(1024).IsValid());
+
+	int values[10];
+	for (int ii = 0; ii < 10; ++ii)
+	{
+		AllocationTracker::Record record;
+		record.filename   = __FILE__;
+		record.numBytes   = ii;
+		record.lineNumber = __LINE__;
+		record.isArray    = (ii % 2) == 0;
+		EXPECT_TRUE(tracker.Insert(&values[ii], record));
+	}
+
+	EXPECT_EQ(10, tracker.GetNumRecords());
+
+	AllocationTracker::Record record;
+	EXPECT_TRUE(tracker.Remove(&values[4], record));
+	EXPECT_EQ(4, record.numBytes);
+	EXPECT_TRUE(record.isArray);
+	EXPECT_STREQ(__FILE__, record.filename);
+	EXPECT_FALSE(tracker.Remove(&values[4], record));
+	EXPECT_EQ(9, tracker.GetNumRecords());
+
+	// Removed slots are reused.
+	EXPECT_TRUE(tracker.Insert(&values[4], record));
+	EXPECT_TRUE(tracker.Remove(&values[4], record));
+
+	uint32 count = 0;
+	tracker.ForEach([&count](const void *, const AllocationTracker::Record &) { ++count; });
+	EXPECT_EQ(9, count);
+
+	tracker.Deinit();
+}
+
+TEST(AllocationTracker, FullTableDropsRecords)
+{
+	AllocationTracker tracker;
+	tracker.Init(1);
+
+	// Far more entries than the table can hold, some will not fit.
+	const int numEntries = 1000;
+	char bytes[numEntries];
+	AllocationTracker::Record record = { __FILE__, 1, __LINE__, MemoryCategory::kGeneral, false };
+	uint32 inserted = 0;
+	for (int ii = 0; ii < numEntries; ++ii)
+	{
+		inserted += tracker.Insert(&bytes[ii], record) ? 1 : 0;
+	}
+
+	EXPECT_GT(numEntries, inserted);
+	EXPECT_EQ(inserted, tracker.GetNumRecords());
+	EXPECT_EQ(numEntries - inserted, tracker.GetNumDroppedRecords());
+
+	tracker.Deinit();
+}
+
+static void ThreadedTracking(AllocationTracker *tracker, char *bytes, int count)
+{
+	for (int iteration = 0; iteration < 20; ++iteration)
+	{
+		for (int ii = 0; ii < count; ++ii)
+		{
+			AllocationTracker::Record record = { __FILE__, (uint64)ii, __LINE__, MemoryCategory::kGeneral, false };
+			ASSERT_TRUE(tracker->Insert(&bytes[ii], record));
+		}
+
+		for (int ii = 0; ii < count; ++ii)
+		{
+			AllocationTracker::Record record;
+			ASSERT_TRUE(tracker->Remove(&bytes[ii], record));
+			ASSERT_EQ(ii, record.numBytes);
+		}
+	}
+}
+
+TEST(AllocationTracker, ThreadedTracking)
+{
+	AllocationTracker tracker;
+	tracker.Init(64 * 1024);
+
+	const int count = 2000;
+	static char bytes[3][count];
+	std::thread t1(ThreadedTracking, &tracker, bytes[0], count);
+	std::thread t2(ThreadedTracking, &tracker, bytes[1], count);
+	std::thread t3(ThreadedTracking, &tracker, bytes[2], count);
+	t1.join();
+	t2.join();
+	t3.join();
+
+	EXPECT_EQ(0, tracker.GetNumRecords());
+	EXPECT_EQ(0, tracker.GetNumDroppedRecords());
+
+	tracker.Deinit();
+}
+
+TEST(AllocationProfiler, EstimatesAllocatedBytes)
+{
+	AllocationProfiler profiler;
+	AllocationProfiler::Cinfo cinfo;
+	cinfo.samplingInterval = 4096;
+	EXPECT_TRUE(profiler.Init(cinfo).IsValid());
+
+	// Only the addresses matter to the profiler, the memory is never touched.
+	const uint64 numAllocations = 100000;
+	for (uint64 ii = 0; ii < numAllocations; ++ii)
+	{
+		profiler.RecordAllocation(reinterpret_cast<void *>((ii + 1) * 64), 64);
+	}
+
+	// Roughly one in 64 allocations is sampled, the scaled up estimate has to be close to the real total.
+	uint64 expectedBytes = numAllocations * 64;
+	EXPECT_EQ(0, profiler.GetNumDroppedSamples());
+	EXPECT_LT(expectedBytes * 85 / 100, profiler.GetAllocatedBytes());
+	EXPECT_GT(expectedBytes * 115 / 100, profiler.GetAllocatedBytes());
+	EXPECT_EQ(profiler.GetAllocatedBytes(), profiler.GetLiveBytes());
+	EXPECT_LE(1u, profiler.GetNumStacks());
+
+	// Freeing everything brings the live bytes back to zero, the allocated bytes stay.
+	for (uint64 ii = 0; ii < numAllocations; ++ii)
+	{
+		profiler.RecordDeallocation(reinterpret_cast<void *>((ii + 1) * 64));
+	}
+
+	EXPECT_EQ(0, profiler.GetLiveBytes());
+	EXPECT_LT(expectedBytes * 85 / 100, profiler.GetAllocatedBytes());
+
+	profiler.Deinit();
+}
+
+TEST(AllocationProfiler, Reports)
+{
+	AllocationProfiler profiler;
+	AllocationProfiler::Cinfo cinfo;
+	cinfo.samplingInterval = 1;
+	profiler.Init(cinfo);
+
+	int live, freed;
+	profiler.RecordAllocation(&live, 1000);
+	profiler.RecordAllocation(&freed, 3000);
+	profiler.RecordDeallocation(&freed);
+
+	// Every stack line of the pprof profile holds "live: bytes [allocated: bytes] @ addresses".
+	std::string report;
+	profiler.WriteReport(report, AllocationProfileFormat::kPprof);
+	EXPECT_EQ(0, report.find("heap profile:      1:     1000 [     2:     4000] @ heapprofile\n"));
+	EXPECT_NE(std::string::npos, report.find("] @ 0x"));
+
+	// Folded stacks end in the value of the stack, freed stacks are left out of the live bytes.
+	profiler.WriteReport(report, AllocationProfileFormat::kFoldedLiveBytes);
+	EXPECT_NE(std::string::npos, report.find(" 1000\n"));
+	EXPECT_EQ(std::string::npos, report.find(" 3000\n"));
+
+	profiler.WriteReport(report, AllocationProfileFormat::kFoldedAllocatedBytes);
+	EXPECT_NE(std::string::npos, report.find(" 1000\n"));
+	EXPECT_NE(std::string::npos, report.find(" 3000\n"));
+
+	profiler.RecordDeallocation(&live);
+	EXPECT_EQ(0, profiler.GetLiveBytes());
+
+	profiler.Deinit();
+}
+
+TEST(AllocationProfiler, MemorySystemSamplesAllocations)
+{
+	// The test program enables the profiler with a 512KB interval, an 8MB allocation is sampled practically always.
+	ASSERT_TRUE(MemorySystem::GetInstance().IsAllocationProfilerEnabled());
+	const AllocationProfiler &profiler = MemorySystem::GetInstance().GetAllocationProfiler();
+
+	uint64 liveBytes = profiler.GetLiveBytes();
+	char *buffer = Qi_AllocateMemoryArray(char, 8 * 1024 * 1024);
+	EXPECT_LE(liveBytes + 8 * 1024 * 1024, profiler.GetLiveBytes());
+
+	Qi_FreeMemoryArray(buffer);
+	EXPECT_EQ(liveBytes, profiler.GetLiveBytes());
+}
+
+namespace
+{
+	///
+	/// Fill a relocatable block with a pattern derived from its handle.
+	///
+	void FillRelocatableBlock(RelocatableAllocator &allocator, RelocatableAllocator::Handle handle, size_t numBytes)
+	{
+		memset(allocator.GetAddress(handle), (int)(handle & 0xff), numBytes);
+	}
+
+	///
+	/// Check that a relocatable block still holds the pattern written by FillRelocatableBlock().
+	///
+	bool CheckRelocatableBlock(RelocatableAllocator &allocator, RelocatableAllocator::Handle handle, size_t numBytes)
+	{
+		const unsigned char *bytes = static_cast<const unsigned char *>(allocator.GetAddress(handle));
+		for (size_t ii = 0; ii < numBytes; ++ii)
+		{
+			if (bytes[ii] != (handle & 0xff))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+TEST(RelocatableAllocator, AllocateAndReuseHoles)
+{
+	RelocatableAllocator::Cinfo cinfo;
+	cinfo.regionSize = 64 * 1024;
+	cinfo.maxHandles = 16;
+
+	RelocatableAllocator allocator;
+	ASSERT_TRUE(allocator.Init(cinfo).IsValid());
+
+	RelocatableAllocator::Handle a = allocator.Allocate(100);
+	RelocatableAllocator::Handle b = allocator.Allocate(100);
+	RelocatableAllocator::Handle c = allocator.Allocate(100);
+	ASSERT_NE(RelocatableAllocator::INVALID_HANDLE, c);
+	EXPECT_EQ(0, (uintptr_t)allocator.GetAddress(a) % Allocator::DEFAULT_ALIGNMENT);
+	EXPECT_LE(100, allocator.GetSize(a));
+	EXPECT_EQ(3, allocator.GetNumAllocations());
+
+	// A smaller block fits into the hole left by 'b'.
+	void *hole = allocator.GetAddress(b);
+	allocator.Free(b);
+	RelocatableAllocator::Handle d = allocator.Allocate(64);
+	EXPECT_EQ(hole, allocator.GetAddress(d));
+
+	// Running out of handles fails the allocation.
+	for (uint32 ii = 3; ii < cinfo.maxHandles; ++ii)
+	{
+		EXPECT_NE(RelocatableAllocator::INVALID_HANDLE, allocator.Allocate(16));
+	}
+
+	EXPECT_EQ(RelocatableAllocator::INVALID_HANDLE, allocator.Allocate(16));
+	EXPECT_EQ(RelocatableAllocator::INVALID_HANDLE, allocator.Allocate(cinfo.regionSize));
+
+	allocator.Deinit();
+}
+
+TEST(RelocatableAllocator, DefragmentPatchesHandles)
+{
+	const uint32 numBlocks = 64;
+	const size_t blockSize = 1000;
+
+	RelocatableAllocator::Cinfo cinfo;
+	cinfo.regionSize = numBlocks * 1024;
+	cinfo.maxHandles = numBlocks;
+
+	RelocatableAllocator allocator;
+	ASSERT_TRUE(allocator.Init(cinfo).IsValid());
+
+	RelocatableAllocator::Handle handles[numBlocks];
+	for (uint32 ii = 0; ii < numBlocks; ++ii)
+	{
+		handles[ii] = allocator.Allocate(blockSize);
+		ASSERT_NE(RelocatableAllocator::INVALID_HANDLE, handles[ii]);
+		FillRelocatableBlock(allocator, handles[ii], blockSize);
+	}
+
+	// Free every other block. Half of the region is free but no hole fits anything larger than a single block.
+	for (uint32 ii = 0; ii < numBlocks; ii += 2)
+	{
+		allocator.Free(handles[ii]);
+		handles[ii] = RelocatableAllocator::INVALID_HANDLE;
+	}
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_GT(stats.GetFragmentation(), 0.9f);
+	EXPECT_EQ(RelocatableAllocator::INVALID_HANDLE, allocator.Allocate(2 * blockSize));
+
+	EXPECT_TRUE(allocator.Defragment(1000 * 1000));
+
+	allocator.GetStats(stats);
+	EXPECT_LT(stats.GetFragmentation(), 0.01f);
+	for (uint32 ii = 1; ii < numBlocks; ii += 2)
+	{
+		EXPECT_TRUE(CheckRelocatableBlock(allocator, handles[ii], blockSize));
+	}
+
+	RelocatableAllocator::Handle large = allocator.Allocate(numBlocks / 2 * blockSize);
+	EXPECT_NE(RelocatableAllocator::INVALID_HANDLE, large);
+
+	allocator.Deinit();
+}
+
+TEST(RelocatableAllocator, IncrementalDefragment)
+{
+	const uint32 numBlocks = 256;
+	const size_t blockSize = 200;
+
+	RelocatableAllocator::Cinfo cinfo;
+	cinfo.regionSize = 2 * numBlocks * 256;
+	cinfo.maxHandles = 2 * numBlocks;
+
+	RelocatableAllocator allocator;
+	ASSERT_TRUE(allocator.Init(cinfo).IsValid());
+
+	std::vector<RelocatableAllocator::Handle> handles;
+	for (uint32 ii = 0; ii < numBlocks; ++ii)
+	{
+		handles.push_back(allocator.Allocate(blockSize));
+		ASSERT_NE(RelocatableAllocator::INVALID_HANDLE, handles.back());
+		FillRelocatableBlock(allocator, handles.back(), blockSize);
+	}
+
+	for (uint32 ii = 0; ii < numBlocks; ii += 2)
+	{
+		allocator.Free(handles[ii]);
+		handles[ii] = RelocatableAllocator::INVALID_HANDLE;
+	}
+
+	// A zero budget moves one block per call. Allocate and free while the pass is in progress,
+	// including blocks in the part of the region which was already compacted.
+	uint32 numSteps = 0;
+	while (!allocator.Defragment(0))
+	{
+		++numSteps;
+		if (numSteps == 16)
+		{
+			allocator.Free(handles[3]);
+			handles[3] = RelocatableAllocator::INVALID_HANDLE;
+		}
+		else if (numSteps == 32)
+		{
+			handles.push_back(allocator.Allocate(blockSize));
+			ASSERT_NE(RelocatableAllocator::INVALID_HANDLE, handles.back());
+			FillRelocatableBlock(allocator, handles.back(), blockSize);
+		}
+
+		ASSERT_LT(numSteps, 4 * numBlocks);
+	}
+
+	EXPECT_GT(numSteps, numBlocks / 4);
+
+	AllocatorStats stats;
+	allocator.GetStats(stats);
+	EXPECT_EQ(stats.capacity - stats.bytesInUse, stats.largestFreeBlock + 16);
+
+	for (size_t ii = 0; ii < handles.size(); ++ii)
+	{
+		if (handles[ii] != RelocatableAllocator::INVALID_HANDLE)
+		{
+			EXPECT_TRUE(CheckRelocatableBlock(allocator, handles[ii], blockSize));
+			allocator.Free(handles[ii]);
+		}
+	}
+
+	EXPECT_EQ(0, allocator.GetNumAllocations());
+	allocator.Deinit();
+}
+
+TEST(RelocatableAllocator, MemorySystemDefragments)
+{
+	// The test program enables a 1MB relocatable allocator.
+	RelocatableAllocator *allocator = MemorySystem::GetInstance().GetRelocatableAllocator();
+	ASSERT_NE(nullptr, allocator);
+
+	RelocatableAllocator::Handle first  = allocator->Allocate(4096);
+	RelocatableAllocator::Handle second = allocator->Allocate(4096);
+	FillRelocatableBlock(*allocator, second, 4096);
+	void *address = allocator->GetAddress(second);
+
+	allocator->Free(first);
+	MemorySystem::GetInstance().DefragmentRelocatableMemory(1000 * 1000);
+
+	EXPECT_LT(allocator->GetAddress(second), address);
+	EXPECT_TRUE(CheckRelocatableBlock(*allocator, second, 4096));
+	allocator->Free(second);
+}
@@ -20,7 +20,11 @@ int main(int argc, const char * argv[])
     // any tests that might use it.
 	Qi::HeapAllocator *allocator = new Qi::HeapAllocator();
 	allocator->Init(nullptr);
-	bool ready = Qi::MemorySystem::GetInstance().Init(allocator).IsValid();
+	Qi::MemorySystem::Cinfo memoryInfo;
+	memoryInfo.allocator = allocator;
+	memoryInfo.profilerSamplingInterval = 512 * 1024;
+	memoryInfo.relocatableRegionSize = 1024 * 1024;
+	bool ready = Qi::MemorySystem::GetInstance().Init(memoryInfo).IsValid();
     ready &= Qi::Logger::GetInstance().Init(Qi::Logger::LogFileType::kHTML, true).IsValid();
     QI_ASSERT(ready);
     
@@ -19,6 +19,7 @@ namespace Qi
 
 // Type definitions.
 typedef uint32_t uint32;
+typedef uint64_t uint64;
 
 ///
 /// Return codes exposed by the engine.
@@ -12,11 +12,15 @@
 /// Templated class which represents a congiuous allocation of elements.
 /// Designed similar to the stl vector in that a set number of elements
 /// are allocated up front. Once that number is passed the allocation is
-/// doubled and all previous elements are copied.
+/// doubled. Trivially copyable elements are grown in place if the allocator can manage it (and copied
+/// bitwise otherwise), all other elements are move-constructed into the new buffer. All memory is allocated from the
+/// array's MemoryCategory so that systems can keep their data in a dedicated region.
 ///
 
 #include "../Defines.h"
 #include "../BaseTypes.h"
+#include "../Memory/MemoryCategory.h"
+#include <type_traits>
 
 namespace Qi
 {
@@ -33,29 +37,95 @@ class Array
         Array(const Array &other);
         ~Array();
         Array & operator=(const Array &other);
+
+        ///
+        /// Move constructor/assignment. The other array's buffer is taken over without touching
+        /// any elements and the other array is left empty.
+        ///
+        Array(Array &&other);
+        Array & operator=(Array &&other);
+
+        ///
+        /// Create an array which allocates its memory from a specific category.
+        ///
+        /// @param category Category to allocate the array's memory from.
+        ///
+        explicit Array(MemoryCategory category);
     
         ///
         /// Push a new value into the end of the array. If the current size of the array is too small
-        /// then the size of the array will be doubled and all previous elements will be copied into
+        /// then the size of the array will be doubled and all previous elements will be moved into
         /// the new array. NOTE: T's copy-constructor must be implemented.
         ///
         /// @return Insertion was successful.
         ///
         inline Result PushBack(const T &value);
+
+        ///
+        /// Move a new value into the end of the array.
+        ///
+        /// @return Insertion was successful.
+        ///
+        inline Result PushBack(T &&value);
+
+        ///
+        /// Construct a new value in place at the end of the array.
+        ///
+        /// @param args Arguments forwarded to T's constructor.
+        /// @return Insertion was successful.
+        ///
+        template<class... Args>
+        inline Result EmplaceBack(Args &&... args);
+
+        ///
+        /// Remove the last element of the array. The array must not be empty.
+        ///
+        inline void PopBack();
+
+        ///
+        /// Remove an element, shifting all following elements down by one to keep their order.
+        ///
+        /// @param index Index of the element to remove.
+        ///
+        inline void Erase(size_t index);
+
+        ///
+        /// Remove an element by moving the last element into its place. Does not keep the order
+        /// of the elements but runs in constant time.
+        ///
+        /// @param index Index of the element to remove.
+        ///
+        inline void SwapErase(size_t index);
+
+        ///
+        /// Make sure the array can hold a number of elements without reallocating.
+        ///
+        /// @param num_elements Number of elements the array must be able to hold.
+        /// @return Reservation was successful.
+        ///
+        inline Result Reserve(size_t num_elements);
+
+        ///
+        /// Shrink the allocation of the array down to the number of elements it holds.
+        ///
+        /// @return Shrinking was successful (the array is left untouched otherwise).
+        ///
+        inline Result ShrinkToFit();
     
         ///
         /// Resize the Array. If there are already elements in this array they will be lost.
+        /// The new elements are default constructed.
         ///
         /// @param num_elements Target size for the array (in terms of element count).
         ///
-        inline Result Resize(uint32 num_elements);
+        inline Result Resize(size_t num_elements);
     
         ///
         /// Get the number of elements currently in the Array.
         ///
         /// @return Element count in the array.
         ///
-        inline uint32 GetSize() const;
+        inline size_t GetSize() const;
     
         ///
         /// Get the allocated size of the array. This value is >=
@@ -63,7 +133,21 @@ class Array
         ///
         /// @return Allocated size of the array (in terms of elements).
         ///
-        inline uint32 GetAllocateSize() const;
+        inline size_t GetAllocateSize() const;
+
+        ///
+        /// Set the category the array allocates its memory from. The array must not hold any memory.
+        ///
+        /// @param category Category to allocate from.
+        ///
+        inline void SetMemoryCategory(MemoryCategory category);
+
+        ///
+        /// Get the category the array allocates its memory from.
+        ///
+        /// @return Memory category.
+        ///
+        inline MemoryCategory GetMemoryCategory() const;
     
         ///
         /// Definition of possible sort orderings for Array.
@@ -88,22 +172,44 @@ class Array
         inline void Clear();
     
         /// Operator overloads ///////////////////////
-        inline T &operator[](int index) const;
+        inline T &operator[](size_t index) const;
     
     private:
     
         ///
-        /// Reallocate the array to a new size and copy over all elements in the previous array.
-        /// The previous allocation size is doubled to accomodate any new elements.
+        /// Make room for one more element, doubling the allocation if the array is full.
+        ///
+        /// @return Status of growing the array (can run out of memory or exceed the largest possible allocation).
+        ///
+        inline Result Grow();
+
+        ///
+        /// Reallocate the array to a new size which is at least the number of elements in it.
+        /// Trivially copyable elements are relocated by the allocator (in place if it can grow the
+        /// buffer), all other elements are move-constructed into a new buffer.
         ///
+        /// @param new_size Number of elements the new allocation holds (0 frees the allocation).
         /// @return Status of reallocating (can run out of memory).
         ///
-        Result Reallocate();
+        Result Reallocate(size_t new_size);
+        Result Reallocate(size_t new_size, std::true_type trivially_copyable);
+        Result Reallocate(size_t new_size, std::false_type trivially_copyable);
+
+        ///
+        /// Copy the elements of another array into this array's (empty) allocation.
+        ///
+        void CopyElements(const Array &other, std::true_type trivially_copyable);
+        void CopyElements(const Array &other, std::false_type trivially_copyable);
+
+        ///
+        /// Destroy all elements and free the allocation without resetting the members.
+        ///
+        void DestroyElements();
     
-        T      *m_elements;      ///< Underlying array. Allocated on the first call to pushBack.
-        uint32 m_back;           ///< Index into the array representing the next element to push into.
-        uint32 m_count;          ///< Number of elements currently placed into the array.
-        uint32 m_allocatedSize; ///< Allocated size of the array.
+        T      *m_elements;      ///< Underlying array. Allocated on the first call to pushBack. Only the first 'm_count' elements are constructed.
+        size_t m_count;          ///< Number of elements currently placed into the array.
+        size_t m_allocatedSize;  ///< Allocated size of the array.
+        MemoryCategory m_category; ///< Category all memory of the array is allocated from.
     
         static const uint32 m_DEFAULT_ARRAY_SIZE = 20; ///< Default value to use to size the array.
 };
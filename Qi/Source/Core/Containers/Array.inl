@@ -8,6 +8,11 @@
 
 #include "../Memory/MemorySystem.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
 
 namespace Qi
 {
@@ -15,29 +20,41 @@ namespace Qi
 template<class T>
 Array<T>::Array() :
     m_elements(nullptr),
+    m_count(0),
     m_allocatedSize(0),
-    m_back(0),
-    m_count(0)
+    m_category(MemoryCategory::kGeneral)
 {
 }
 
 template<class T>
-Array<T>::Array(const Array &other)
+Array<T>::Array(MemoryCategory category) :
+    m_elements(nullptr),
+    m_count(0),
+    m_allocatedSize(0),
+    m_category(category)
 {
-    m_count = other.m_count;
-    m_back = other.m_back;
-    m_allocatedSize = other.m_allocatedSize;
-    
-    if (m_allocatedSize)
-    {
-        m_elements = Qi_AllocateMemoryArray(T, m_allocatedSize);
-        std::memcpy(m_elements, other.m_elements, m_count * sizeof(T));
-    }
-    else
-    {
-        m_elements = nullptr;
-    }
-    
+}
+
+template<class T>
+Array<T>::Array(const Array &other) :
+    m_elements(nullptr),
+    m_count(0),
+    m_allocatedSize(0),
+    m_category(other.m_category)
+{
+    CopyElements(other, std::is_trivially_copyable<T>());
+}
+
+template<class T>
+Array<T>::Array(Array &&other) :
+    m_elements(other.m_elements),
+    m_count(other.m_count),
+    m_allocatedSize(other.m_allocatedSize),
+    m_category(other.m_category)
+{
+    other.m_elements = nullptr;
+    other.m_count = 0;
+    other.m_allocatedSize = 0;
 }
 
 template<class T>
@@ -51,54 +68,148 @@ Array<T> & Array<T>::operator=(const Array<T> &other)
 {
     if (this != &other)
     {
+        // The copy keeps allocating from this array's category.
+        Clear();
+        CopyElements(other, std::is_trivially_copyable<T>());
+    }
+    
+    return *this;
+}
+
+template<class T>
+Array<T> & Array<T>::operator=(Array<T> &&other)
+{
+    if (this != &other)
+    {
+        // The buffer stays in the category it was allocated from, so the category moves along with it.
+        Clear();
+        m_elements = other.m_elements;
         m_count = other.m_count;
-        m_back = other.m_back;
         m_allocatedSize = other.m_allocatedSize;
-        
-        m_elements = Qi_AllocateMemoryArray(T, m_allocatedSize);
-        std::memcpy(m_elements, other.m_elements, m_count * sizeof(T));
+        m_category = other.m_category;
+
+        other.m_elements = nullptr;
+        other.m_count = 0;
+        other.m_allocatedSize = 0;
     }
-    
+
     return *this;
 }
 
 template<class T>
 Result Array<T>::PushBack(const T &value)
+{
+    return EmplaceBack(value);
+}
+
+template<class T>
+Result Array<T>::PushBack(T &&value)
+{
+    return EmplaceBack(std::move(value));
+}
+
+template<class T>
+template<class... Args>
+Result Array<T>::EmplaceBack(Args &&... args)
 {
     if (m_count >= m_allocatedSize)
     {
-        Result result = Reallocate();
+        // The arguments may refer to elements of this array, build the value before the elements move.
+        T value(std::forward<Args>(args)...);
+
+        Result result = Grow();
         if (!result.IsValid())
         {
             return result;
         }
+
+        new ((void *)&m_elements[m_count]) T(std::move(value));
     }
-    
-    void *buffer = (void *)&m_elements[m_back];
-    new (buffer) T(value);
+    else
+    {
+        new ((void *)&m_elements[m_count]) T(std::forward<Args>(args)...);
+    }
+
     ++m_count;
-    ++m_back;
-    
     return Result(ReturnCode::kSuccess);
 }
 
 template<class T>
-Result Array<T>::Resize(uint32 num_elements)
+void Array<T>::PopBack()
+{
+    QI_ASSERT(m_count > 0);
+
+    --m_count;
+    m_elements[m_count].~T();
+}
+
+template<class T>
+void Array<T>::Erase(size_t index)
+{
+    QI_ASSERT(index < m_count);
+
+    std::move(&m_elements[index + 1], &m_elements[m_count], &m_elements[index]);
+    PopBack();
+}
+
+template<class T>
+void Array<T>::SwapErase(size_t index)
+{
+    QI_ASSERT(index < m_count);
+
+    if (index != m_count - 1)
+    {
+        m_elements[index] = std::move(m_elements[m_count - 1]);
+    }
+
+    PopBack();
+}
+
+template<class T>
+Result Array<T>::Reserve(size_t num_elements)
+{
+    if (num_elements > m_allocatedSize)
+    {
+        return Reallocate(num_elements);
+    }
+
+    return Result(ReturnCode::kSuccess);
+}
+
+template<class T>
+Result Array<T>::ShrinkToFit()
 {
-    if (m_count > 0)
+    if (m_count < m_allocatedSize)
     {
-        Clear();
+        return Reallocate(m_count);
+    }
+
+    return Result(ReturnCode::kSuccess);
+}
+
+template<class T>
+Result Array<T>::Resize(size_t num_elements)
+{
+    Clear();
+    if (num_elements == 0)
+    {
+        return Result(ReturnCode::kSuccess);
     }
     
     Result result;
     
-    m_elements = Qi_AllocateMemoryArray(T, num_elements);
+    m_elements = Qi_AllocateUninitializedArrayFrom(T, num_elements, m_category);
     if (!m_elements)
     {
         result.code = ReturnCode::kOutOfMemory;
     }
     else
     {
+        for (size_t ii = 0; ii < num_elements; ++ii)
+        {
+            new ((void *)&m_elements[ii]) T;
+        }
+
         m_count = num_elements;
         m_allocatedSize = num_elements;
         result.code = ReturnCode::kSuccess;
@@ -108,28 +219,41 @@ Result Array<T>::Resize(uint32 num_elements)
 }
 
 template<class T>
-uint32 Array<T>::GetSize() const
+size_t Array<T>::GetSize() const
 {
     return m_count;
 }
 
 template<class T>
-uint32 Array<T>::GetAllocateSize() const
+size_t Array<T>::GetAllocateSize() const
 {
     return m_allocatedSize;
 }
 
+template<class T>
+void Array<T>::SetMemoryCategory(MemoryCategory category)
+{
+    QI_ASSERT(m_allocatedSize == 0);
+    m_category = category;
+}
+
+template<class T>
+MemoryCategory Array<T>::GetMemoryCategory() const
+{
+    return m_category;
+}
+
 template<class T>
 void Array<T>::Sort(SortOrder order)
 {
     switch (order)
     {
         case SortOrder::kAscending:
-            std::sort(&m_elements[0], &m_elements[m_back], std::less<T>());
+            std::sort(m_elements, m_elements + m_count, std::less<T>());
             break;
             
         case SortOrder::kDescending:
-            std::sort(&m_elements[0], &m_elements[m_back], std::greater<T>());
+            std::sort(m_elements, m_elements + m_count, std::greater<T>());
             break;
         
         default:
@@ -143,42 +267,136 @@ void Array<T>::Clear()
 {
     if (m_allocatedSize > 0)
     {
-        Qi_FreeMemoryArray(m_elements);
+        DestroyElements();
         m_elements = nullptr;
 
 		m_count = 0;
-		m_back = 0;
 		m_allocatedSize = 0;
     }
 }
 
 template<class T>
-T &Array<T>::operator[](int index) const
+T &Array<T>::operator[](size_t index) const
 {
-	QI_ASSERT((uint32)index < m_count);
+	QI_ASSERT(index < m_count);
     return m_elements[index];
 }
 
 template<class T>
-Result Array<T>::Reallocate()
+Result Array<T>::Grow()
+{
+    if (m_count < m_allocatedSize)
+    {
+        return Result(ReturnCode::kSuccess);
+    }
+
+    // Double the size of the array.
+    if (m_allocatedSize > std::numeric_limits<size_t>::max() / 2)
+    {
+        return Result(ReturnCode::kOutOfMemory);
+    }
+
+    return Reallocate((m_allocatedSize != 0) ? m_allocatedSize * 2 : m_DEFAULT_ARRAY_SIZE);
+}
+
+template<class T>
+Result Array<T>::Reallocate(size_t new_size)
+{
+    QI_ASSERT(new_size >= m_count);
+
+    if (new_size == 0)
+    {
+        Clear();
+        return Result(ReturnCode::kSuccess);
+    }
+
+    return Reallocate(new_size, std::is_trivially_copyable<T>());
+}
+
+template<class T>
+Result Array<T>::Reallocate(size_t new_size, std::true_type)
 {
-    // Create a new array which is double the size of the previous one.
-    uint32 new_size = (m_allocatedSize != 0) ? m_allocatedSize * 2 : m_DEFAULT_ARRAY_SIZE;
-    T *tmp_array = Qi_AllocateMemoryArray(T, new_size);
+    // The allocator grows the array in place when it can, otherwise the elements are copied
+    // into a new buffer and the old one is freed.
+    T *tmp_array = Qi_ReallocateUninitializedArrayFrom(m_elements, m_count, new_size, m_category);
     if (!tmp_array)
     {
         // The allocation failed, we're probably out of memory.
         return Result(ReturnCode::kOutOfMemory);
     }
     
-    // Copy the old data from the previous array into the new one and free
-    // the old one.
-    memcpy((void *)tmp_array, (void *)m_elements, m_allocatedSize * sizeof(T));
-    Qi_FreeMemoryArray(m_elements);
     m_elements = tmp_array;
     m_allocatedSize = new_size;
     
     return Result(ReturnCode::kSuccess);
 }
 
+template<class T>
+Result Array<T>::Reallocate(size_t new_size, std::false_type)
+{
+    // Elements may point into themselves (or be pointed at), they have to be moved by their own move constructor.
+    T *tmp_array = Qi_AllocateUninitializedArrayFrom(T, new_size, m_category);
+    if (!tmp_array)
+    {
+        return Result(ReturnCode::kOutOfMemory);
+    }
+
+    for (size_t ii = 0; ii < m_count; ++ii)
+    {
+        new ((void *)&tmp_array[ii]) T(std::move(m_elements[ii]));
+        m_elements[ii].~T();
+    }
+
+    Qi_FreeMemoryArrayFrom(m_elements, m_category);
+    m_elements = tmp_array;
+    m_allocatedSize = new_size;
+
+    return Result(ReturnCode::kSuccess);
+}
+
+template<class T>
+void Array<T>::CopyElements(const Array &other, std::true_type)
+{
+    QI_ASSERT(m_allocatedSize == 0);
+
+    if (other.m_count > 0)
+    {
+        m_elements = Qi_AllocateUninitializedArrayFrom(T, other.m_count, m_category);
+        if (m_elements)
+        {
+            std::memcpy(m_elements, other.m_elements, other.m_count * sizeof(T));
+            m_count = other.m_count;
+            m_allocatedSize = other.m_count;
+        }
+    }
+}
+
+template<class T>
+void Array<T>::CopyElements(const Array &other, std::false_type)
+{
+    QI_ASSERT(m_allocatedSize == 0);
+
+    if (other.m_count > 0)
+    {
+        m_elements = Qi_AllocateUninitializedArrayFrom(T, other.m_count, m_category);
+        if (m_elements)
+        {
+            std::uninitialized_copy(other.m_elements, other.m_elements + other.m_count, m_elements);
+            m_count = other.m_count;
+            m_allocatedSize = other.m_count;
+        }
+    }
+}
+
+template<class T>
+void Array<T>::DestroyElements()
+{
+    for (size_t ii = 0; ii < m_count; ++ii)
+    {
+        m_elements[ii].~T();
+    }
+
+    Qi_FreeMemoryArrayFrom(m_elements, m_category);
+}
+
 } // namespace Qi
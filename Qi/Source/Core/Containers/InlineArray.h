@@ -0,0 +1,224 @@
+//
+//  InlineArray.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Array which keeps up to N elements inside of the object itself and only allocates from the
+/// MemorySystem once it grows past that. Meant for the many small lists that rarely hold more than
+/// a handful of elements, where Array would spend an allocation of its default size on each of them.
+/// The interface matches Array. Since inline elements live in the object, moving an InlineArray
+/// moves its elements one by one unless they have spilled to the heap.
+///
+
+#include "../Defines.h"
+#include "../BaseTypes.h"
+#include "../Memory/MemoryCategory.h"
+#include <type_traits>
+
+namespace Qi
+{
+
+template<class T, uint32 N>
+class InlineArray
+{
+	static_assert(N > 0, "InlineArray needs room for at least one inline element, use Array otherwise");
+
+	public:
+
+		///
+		/// Default constructor/copy constructor/destructor.
+		///
+		InlineArray();
+		InlineArray(const InlineArray &other);
+		~InlineArray();
+		InlineArray &operator=(const InlineArray &other);
+
+		///
+		/// Move constructor/assignment. A spilled buffer is taken over, inline elements are moved
+		/// individually. The other array is left empty.
+		///
+		InlineArray(InlineArray &&other);
+		InlineArray &operator=(InlineArray &&other);
+
+		///
+		/// Create an array which allocates its memory from a specific category once it spills.
+		///
+		/// @param category Category to allocate the array's memory from.
+		///
+		explicit InlineArray(MemoryCategory category);
+
+		///
+		/// Push a new value into the end of the array, spilling to (or growing) the heap allocation if
+		/// the array is full.
+		///
+		/// @return Insertion was successful.
+		///
+		inline Result PushBack(const T &value);
+		inline Result PushBack(T &&value);
+
+		///
+		/// Construct a new value in place at the end of the array.
+		///
+		/// @param args Arguments forwarded to T's constructor.
+		/// @return Insertion was successful.
+		///
+		template<class... Args>
+		inline Result EmplaceBack(Args &&... args);
+
+		///
+		/// Remove the last element of the array. The array must not be empty.
+		///
+		inline void PopBack();
+
+		///
+		/// Remove an element, shifting all following elements down by one to keep their order.
+		///
+		/// @param index Index of the element to remove.
+		///
+		inline void Erase(size_t index);
+
+		///
+		/// Remove an element by moving the last element into its place.
+		///
+		/// @param index Index of the element to remove.
+		///
+		inline void SwapErase(size_t index);
+
+		///
+		/// Make sure the array can hold a number of elements without reallocating.
+		///
+		/// @param numElements Number of elements the array must be able to hold.
+		/// @return Reservation was successful.
+		///
+		inline Result Reserve(size_t numElements);
+
+		///
+		/// Shrink the heap allocation down to the number of elements, moving them back into the
+		/// object if they fit.
+		///
+		/// @return Shrinking was successful (the array is left untouched otherwise).
+		///
+		inline Result ShrinkToFit();
+
+		///
+		/// Resize the array. If there are already elements in this array they will be lost.
+		/// The new elements are default constructed.
+		///
+		/// @param numElements Target size for the array (in terms of element count).
+		///
+		inline Result Resize(size_t numElements);
+
+		///
+		/// Get the number of elements currently in the array.
+		///
+		/// @return Element count in the array.
+		///
+		inline size_t GetSize() const;
+
+		///
+		/// Get the number of elements the array can hold without reallocating (at least N).
+		///
+		/// @return Allocated size of the array (in terms of elements).
+		///
+		inline size_t GetAllocateSize() const;
+
+		///
+		/// Check if the elements are stored inside of the object.
+		///
+		/// @return True if the array has not spilled to the heap.
+		///
+		inline bool IsInline() const;
+
+		///
+		/// Set the category the array allocates its memory from. The array must not have spilled.
+		///
+		/// @param category Category to allocate from.
+		///
+		inline void SetMemoryCategory(MemoryCategory category);
+
+		///
+		/// Get the category the array allocates its memory from.
+		///
+		/// @return Memory category.
+		///
+		inline MemoryCategory GetMemoryCategory() const;
+
+		///
+		/// Definition of possible sort orderings for InlineArray.
+		///
+		enum class SortOrder
+		{
+			kAscending,  ///< Sort the data in ascending order (smallest to largest).
+			kDescending  ///< Sort the data in descending order (largest to smallest).
+		};
+
+		///
+		/// Sort the array in either ascending or descending order.
+		///
+		/// @param order Sort order.
+		///
+		inline void Sort(SortOrder order);
+
+		///
+		/// Clear all elements from the array and free its heap allocation, if any.
+		///
+		inline void Clear();
+
+		/// Operator overloads ///////////////////////
+		inline T &operator[](size_t index) const;
+
+	private:
+
+		///
+		/// Make room for one more element, doubling the allocation if the array is full.
+		///
+		inline Result Grow();
+
+		///
+		/// Move the elements into an allocation of a new size, which is the inline storage if the
+		/// size is at most N. Trivially copyable elements which already live on the heap are relocated
+		/// by the allocator, in place if it can grow the buffer.
+		///
+		/// @param newSize Number of elements the new storage holds (at least the current count).
+		/// @return Status of reallocating (can run out of memory).
+		///
+		Result Reallocate(size_t newSize);
+		T *ReallocateHeap(size_t newSize, std::true_type triviallyCopyable);
+		T *ReallocateHeap(size_t newSize, std::false_type triviallyCopyable);
+
+		///
+		/// Take over the elements of another array, leaving it empty. This array must be empty and inline.
+		///
+		void TakeElements(InlineArray &other);
+
+		///
+		/// Copy the elements of another array into this (empty) array.
+		///
+		void CopyElements(const InlineArray &other);
+
+		///
+		/// Move-construct 'count' elements from 'source' to 'destination', destroying the sources.
+		///
+		static inline void MoveElements(T *destination, T *source, size_t count);
+
+		///
+		/// Get the storage inside of the object.
+		///
+		inline T *GetInlineElements() const;
+
+		T      *m_elements;        ///< Either the inline storage or a heap allocation. Only the first 'm_count' elements are constructed.
+		size_t m_count;            ///< Number of elements currently placed into the array.
+		size_t m_allocatedSize;    ///< Number of elements 'm_elements' can hold.
+		MemoryCategory m_category; ///< Category the heap allocation comes from.
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_inlineStorage[N]; ///< Storage of the first N elements.
+};
+
+} // namespace Qi
+
+#include "InlineArray.inl"
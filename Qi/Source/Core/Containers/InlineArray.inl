@@ -0,0 +1,406 @@
+//
+//  InlineArray.inl
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "../Memory/MemorySystem.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Qi
+{
+
+template<class T, uint32 N>
+InlineArray<T, N>::InlineArray() :
+	m_elements(GetInlineElements()),
+	m_count(0),
+	m_allocatedSize(N),
+	m_category(MemoryCategory::kGeneral)
+{
+}
+
+template<class T, uint32 N>
+InlineArray<T, N>::InlineArray(MemoryCategory category) :
+	m_elements(GetInlineElements()),
+	m_count(0),
+	m_allocatedSize(N),
+	m_category(category)
+{
+}
+
+template<class T, uint32 N>
+InlineArray<T, N>::InlineArray(const InlineArray &other) :
+	m_elements(GetInlineElements()),
+	m_count(0),
+	m_allocatedSize(N),
+	m_category(other.m_category)
+{
+	CopyElements(other);
+}
+
+template<class T, uint32 N>
+InlineArray<T, N>::InlineArray(InlineArray &&other) :
+	m_elements(GetInlineElements()),
+	m_count(0),
+	m_allocatedSize(N),
+	m_category(other.m_category)
+{
+	TakeElements(other);
+}
+
+template<class T, uint32 N>
+InlineArray<T, N>::~InlineArray()
+{
+	Clear();
+}
+
+template<class T, uint32 N>
+InlineArray<T, N> &InlineArray<T, N>::operator=(const InlineArray &other)
+{
+	if (this != &other)
+	{
+		// The copy keeps allocating from this array's category.
+		Clear();
+		CopyElements(other);
+	}
+
+	return *this;
+}
+
+template<class T, uint32 N>
+InlineArray<T, N> &InlineArray<T, N>::operator=(InlineArray &&other)
+{
+	if (this != &other)
+	{
+		// A spilled buffer stays in the category it was allocated from, so the category moves along with it.
+		Clear();
+		m_category = other.m_category;
+		TakeElements(other);
+	}
+
+	return *this;
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::PushBack(const T &value)
+{
+	return EmplaceBack(value);
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::PushBack(T &&value)
+{
+	return EmplaceBack(std::move(value));
+}
+
+template<class T, uint32 N>
+template<class... Args>
+Result InlineArray<T, N>::EmplaceBack(Args &&... args)
+{
+	if (m_count >= m_allocatedSize)
+	{
+		// The arguments may refer to elements of this array, build the value before the elements move.
+		T value(std::forward<Args>(args)...);
+
+		Result result = Grow();
+		if (!result.IsValid())
+		{
+			return result;
+		}
+
+		new ((void *)&m_elements[m_count]) T(std::move(value));
+	}
+	else
+	{
+		new ((void *)&m_elements[m_count]) T(std::forward<Args>(args)...);
+	}
+
+	++m_count;
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::PopBack()
+{
+	QI_ASSERT(m_count > 0);
+
+	--m_count;
+	m_elements[m_count].~T();
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::Erase(size_t index)
+{
+	QI_ASSERT(index < m_count);
+
+	std::move(&m_elements[index + 1], &m_elements[m_count], &m_elements[index]);
+	PopBack();
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::SwapErase(size_t index)
+{
+	QI_ASSERT(index < m_count);
+
+	if (index != m_count - 1)
+	{
+		m_elements[index] = std::move(m_elements[m_count - 1]);
+	}
+
+	PopBack();
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::Reserve(size_t numElements)
+{
+	if (numElements > m_allocatedSize)
+	{
+		return Reallocate(numElements);
+	}
+
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::ShrinkToFit()
+{
+	if (!IsInline() && m_count < m_allocatedSize)
+	{
+		return Reallocate(m_count);
+	}
+
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::Resize(size_t numElements)
+{
+	Clear();
+
+	Result result = Reserve(numElements);
+	if (result.IsValid())
+	{
+		for (size_t ii = 0; ii < numElements; ++ii)
+		{
+			new ((void *)&m_elements[ii]) T;
+		}
+
+		m_count = numElements;
+	}
+
+	return result;
+}
+
+template<class T, uint32 N>
+size_t InlineArray<T, N>::GetSize() const
+{
+	return m_count;
+}
+
+template<class T, uint32 N>
+size_t InlineArray<T, N>::GetAllocateSize() const
+{
+	return m_allocatedSize;
+}
+
+template<class T, uint32 N>
+bool InlineArray<T, N>::IsInline() const
+{
+	return m_elements == GetInlineElements();
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::SetMemoryCategory(MemoryCategory category)
+{
+	QI_ASSERT(IsInline());
+	m_category = category;
+}
+
+template<class T, uint32 N>
+MemoryCategory InlineArray<T, N>::GetMemoryCategory() const
+{
+	return m_category;
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::Sort(SortOrder order)
+{
+	switch (order)
+	{
+		case SortOrder::kAscending:
+			std::sort(m_elements, m_elements + m_count, std::less<T>());
+			break;
+
+		case SortOrder::kDescending:
+			std::sort(m_elements, m_elements + m_count, std::greater<T>());
+			break;
+
+		default:
+			QI_ASSERT(0 && "Unsupported sort ordering");
+			break;
+	}
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::Clear()
+{
+	for (size_t ii = 0; ii < m_count; ++ii)
+	{
+		m_elements[ii].~T();
+	}
+
+	if (!IsInline())
+	{
+		Qi_FreeMemoryArrayFrom(m_elements, m_category);
+		m_elements = GetInlineElements();
+		m_allocatedSize = N;
+	}
+
+	m_count = 0;
+}
+
+template<class T, uint32 N>
+T &InlineArray<T, N>::operator[](size_t index) const
+{
+	QI_ASSERT(index < m_count);
+	return m_elements[index];
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::Grow()
+{
+	if (m_count < m_allocatedSize)
+	{
+		return Result(ReturnCode::kSuccess);
+	}
+
+	if (m_allocatedSize > std::numeric_limits<size_t>::max() / 2)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	return Reallocate(m_allocatedSize * 2);
+}
+
+template<class T, uint32 N>
+Result InlineArray<T, N>::Reallocate(size_t newSize)
+{
+	QI_ASSERT(newSize >= m_count);
+
+	if (newSize <= N)
+	{
+		// Everything fits back into the object.
+		if (!IsInline())
+		{
+			T *heapElements = m_elements;
+			MoveElements(GetInlineElements(), heapElements, m_count);
+			Qi_FreeMemoryArrayFrom(heapElements, m_category);
+
+			m_elements = GetInlineElements();
+			m_allocatedSize = N;
+		}
+
+		return Result(ReturnCode::kSuccess);
+	}
+
+	T *newElements = nullptr;
+	if (IsInline())
+	{
+		// Spill to the heap.
+		newElements = Qi_AllocateUninitializedArrayFrom(T, newSize, m_category);
+		if (newElements != nullptr)
+		{
+			MoveElements(newElements, m_elements, m_count);
+		}
+	}
+	else
+	{
+		newElements = ReallocateHeap(newSize, std::is_trivially_copyable<T>());
+	}
+
+	if (newElements == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_elements = newElements;
+	m_allocatedSize = newSize;
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T, uint32 N>
+T *InlineArray<T, N>::ReallocateHeap(size_t newSize, std::true_type)
+{
+	return Qi_ReallocateUninitializedArrayFrom(m_elements, m_count, newSize, m_category);
+}
+
+template<class T, uint32 N>
+T *InlineArray<T, N>::ReallocateHeap(size_t newSize, std::false_type)
+{
+	T *newElements = Qi_AllocateUninitializedArrayFrom(T, newSize, m_category);
+	if (newElements != nullptr)
+	{
+		MoveElements(newElements, m_elements, m_count);
+		Qi_FreeMemoryArrayFrom(m_elements, m_category);
+	}
+
+	return newElements;
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::TakeElements(InlineArray &other)
+{
+	QI_ASSERT(IsInline() && m_count == 0);
+
+	if (other.IsInline())
+	{
+		MoveElements(m_elements, other.m_elements, other.m_count);
+	}
+	else
+	{
+		m_elements = other.m_elements;
+		m_allocatedSize = other.m_allocatedSize;
+
+		other.m_elements = other.GetInlineElements();
+		other.m_allocatedSize = N;
+	}
+
+	m_count = other.m_count;
+	other.m_count = 0;
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::CopyElements(const InlineArray &other)
+{
+	QI_ASSERT(m_count == 0);
+
+	if (Reserve(other.m_count).IsValid())
+	{
+		std::uninitialized_copy(other.m_elements, other.m_elements + other.m_count, m_elements);
+		m_count = other.m_count;
+	}
+}
+
+template<class T, uint32 N>
+void InlineArray<T, N>::MoveElements(T *destination, T *source, size_t count)
+{
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		new ((void *)&destination[ii]) T(std::move(source[ii]));
+		source[ii].~T();
+	}
+}
+
+template<class T, uint32 N>
+T *InlineArray<T, N>::GetInlineElements() const
+{
+	return reinterpret_cast<T *>(const_cast<typename std::aligned_storage<sizeof(T), alignof(T)>::type *>(m_inlineStorage));
+}
+
+} // namespace Qi
@@ -10,16 +10,18 @@
 
 ///
 /// Implement a lockless queue. This operates very similar to a normal queue except that
-/// it is threadsafe without relying on locks, allowing for much more efficient
-/// use. NOTE: The queue uses no dynamic memory. This simplifies the implementation, speeds
-/// up it's use, and avoids the ABA problem. However, the queue is a fixed size and cannot
-/// be resized after being instantiated.
-/// This code is an adaptaion of http://www.codeproject.com/Articles/153898/Yet-another-implementation-of-a-lock-free-circular
+/// it is threadsafe for any number of producers and consumers without relying on locks.
+/// NOTE: The queue makes a single allocation in Init() and cannot be resized afterwards.
+/// This is a bounded ring in the style of Dmitry Vyukov's MPMC queue: every slot carries a
+/// sequence number telling producers and consumers whether it is free or holds a committed
+/// element. A thread claims a slot with a single compare-and-swap and never waits on another
+/// thread to finish its write, and an element is only read once its producer has published it.
 ///
 
 #include "../Defines.h"
-#include "Array.h"
+#include "../BaseTypes.h"
 #include <atomic>
+#include <type_traits>
 
 namespace Qi
 {
@@ -30,7 +32,7 @@ class LocklessQueue
     public:
     
         ///
-        /// Default constructor/copy constructor/destructor.
+        /// Default constructor/destructor.
         ///
         LocklessQueue();
         ~LocklessQueue();
@@ -38,7 +40,8 @@ class LocklessQueue
         ///
         /// Initialize the queue to a certain size. The queue
         /// will make only this one allocation and will never
-        /// grow in size.
+        /// grow in size. The size is rounded up to a power of two
+        /// (and at least 2) so that positions map to slots with a mask.
         ///
         /// @param size Size to make the queue (in terms of T elements).
         ///
@@ -55,7 +58,8 @@ class LocklessQueue
         inline uint32 GetAllocatedSize() const;
     
         ///
-        /// Get the current element count in the queue.
+        /// Get the current element count in the queue. While other threads push or
+        /// pop this is only a snapshot.
         ///
         /// @return Number of elements in the queue.
         ///
@@ -69,19 +73,19 @@ class LocklessQueue
         /// @return Success. If false, the queue is full.
         ///
         bool Push(const T& element);
+        bool Push(T&& element);
     
         ///
         /// Pop an element off of the front of the queue.
         ///
-        /// @param element A copy of the top element on the queue.
+        /// @param element Receives the top element on the queue (moved out of the queue).
         /// @return Success. If false, the queue is empty.
         ///
         bool Pop(T& element);
     
         ///
-        /// Clear the queue. Since the queue uses a static array
-        /// this operation just resets the internal counters for
-        /// where the queue is currently being read/written from.
+        /// Clear the queue. Any elements still in the queue are destroyed
+        /// and the slots are reset to their initial sequence numbers.
         /// NOTE: This is not a threadsafe operation!!!
         ///
         inline void Clear();
@@ -94,27 +98,41 @@ class LocklessQueue
         LocklessQueue & operator=(const LocklessQueue &other) = delete;
     
         ///
-        /// Calculate the index in the circular array that corresponds to a particular
-        /// 'index' value.
+        /// Element storage along with the sequence number which says what the slot is ready for.
+        /// A slot at position 'p' is free for the producer of 'p' when its sequence equals 'p' and
+        /// holds the element for the consumer of 'p' when it equals 'p + 1'.
         ///
-        inline uint32 CountToIndex(uint32 index);
+        struct Slot
+        {
+            std::atomic<uint32> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type element;
+        };
     
         ///
-        /// Internal queue object. Note that this queue is circular and will wrap
-        /// around as objects are added/popped off.
+        /// Position counter on its own cache line so that producers and consumers do not
+        /// invalidate each other's index.
         ///
-        Array<T> m_queue;
-        std::atomic<uint32> m_writeIndex;   ///< The index in 'm_queue' where the next element will be inserted.
-        std::atomic<uint32> m_readIndex;    ///< The index in 'm_queue' where the next element will be read.
+        struct QI_ALIGN(64) Position
+        {
+            std::atomic<uint32> value;
+        };
     
         ///
-        /// Maximum current read index for the queue. If it's not the same as 'm_writeIndex'
-        /// then that means there are writes pending in the queue. The places in the queue
-        /// have been reserved but the data is still not in the queue.
+        /// Claim the slot for the next push. Returns null if the queue is full.
         ///
-        std::atomic<uint32> m_maxReadIndex;
+        inline Slot *ClaimPushSlot(uint32 &position);
     
-        uint32 m_allocatedSize; ///< Size of the entire queue (not the number of elements in the queue).
+        ///
+        /// Reset every slot's sequence number and both positions.
+        ///
+        inline void ResetPositions();
+    
+        Position m_pushPosition;  ///< Position the next element will be pushed to.
+        Position m_popPosition;   ///< Position the next element will be popped from.
+    
+        Slot *m_slots;            ///< Ring of slots, 'm_mask + 1' of them.
+        uint32 m_mask;            ///< Allocated size - 1, maps a position to its slot.
+        uint32 m_allocatedSize;   ///< Size of the entire queue (not the number of elements in the queue).
 };
 
 } // namespace Qi
@@ -6,24 +6,39 @@
 //  Copyright (c) 2015 Cody White. All rights reserved.
 //
 
-#include <thread>
+#include "../Memory/MemorySystem.h"
+#include <new>
+#include <utility>
 
 namespace Qi
 {
 
 template<class T>
 LocklessQueue<T>::LocklessQueue() :
-    m_writeIndex(0),
-    m_readIndex(0),
-    m_maxReadIndex(0),
+    m_slots(nullptr),
+    m_mask(0),
     m_allocatedSize(0)
 {
+    m_pushPosition.value = 0;
+    m_popPosition.value = 0;
 }
 
 template<class T>
 LocklessQueue<T>::~LocklessQueue()
 {
-    Clear();
+    if (m_slots != nullptr)
+    {
+        Clear();
+        
+        for (uint32 ii = 0; ii < m_allocatedSize; ++ii)
+        {
+            m_slots[ii].~Slot();
+        }
+        
+        Qi_FreeMemoryArray(m_slots);
+        m_slots = nullptr;
+    }
+    
     m_allocatedSize = 0;
 }
 
@@ -31,9 +46,30 @@ template<class T>
 inline void LocklessQueue<T>::Init(uint32 size)
 {
     QI_ASSERT(m_allocatedSize == 0);
+    QI_ASSERT(size <= (1u << 31));
+    
+    // A ring of a single slot could not tell a freshly pushed element from a free slot.
+    uint32 allocatedSize = 2;
+    while (allocatedSize < size)
+    {
+        allocatedSize <<= 1;
+    }
+    
+    m_slots = Qi_AllocateUninitializedArrayFrom(Slot, allocatedSize, MemoryCategory::kGeneral);
+    QI_ASSERT(m_slots != nullptr);
+    if (m_slots == nullptr)
+    {
+        return;
+    }
+    
+    for (uint32 ii = 0; ii < allocatedSize; ++ii)
+    {
+        new ((void *)&m_slots[ii]) Slot;
+    }
     
-    m_queue.Resize(size);
-    m_allocatedSize = size;
+    m_allocatedSize = allocatedSize;
+    m_mask = allocatedSize - 1;
+    ResetPositions();
 }
 
 template<class T>
@@ -47,19 +83,18 @@ inline uint32 LocklessQueue<T>::GetSize() const
 {
     QI_ASSERT(m_allocatedSize > 0);
     
-    uint32 currentWriteIndex = m_writeIndex;
-    uint32 currentReadIndex  = m_readIndex;
+    uint32 popPosition  = m_popPosition.value.load(std::memory_order_relaxed);
+    uint32 pushPosition = m_pushPosition.value.load(std::memory_order_relaxed);
     
-    // Case where the queue start/end doesn't yet wrap around to the beginning.
-    if (currentWriteIndex >= currentReadIndex)
+    // The positions are read separately, so a concurrent pop can make the difference
+    // momentarily negative. Positions wrap around, the unsigned difference does not care.
+    int count = (int)(pushPosition - popPosition);
+    if (count < 0)
     {
-        return (currentWriteIndex - currentReadIndex);
-    }
-    // Queue has wrapped around to the beginning.
-    else
-    {
-        return (m_allocatedSize + currentWriteIndex - currentReadIndex);
+        return 0;
     }
+    
+    return ((uint32)count > m_allocatedSize) ? m_allocatedSize : (uint32)count;
 }
 
 template<class T>
@@ -67,30 +102,36 @@ bool LocklessQueue<T>::Push(const T& element)
 {
     QI_ASSERT(m_allocatedSize > 0);
     
-    uint32 currentWriteIndex;
-    
-    do
+    uint32 position;
+    Slot *slot = ClaimPushSlot(position);
+    if (slot == nullptr)
     {
-        if (GetSize() == m_allocatedSize)
-        {
-            // The queue is full.
-            return false;
-        }
-        
-        currentWriteIndex = m_writeIndex;
-        
-    } while (!std::atomic_compare_exchange_weak(&m_writeIndex, &currentWriteIndex, currentWriteIndex + 1));
+        // The queue is full.
+        return false;
+    }
     
-    // We know now that this index is reserved for us. Use it to save the data.
-    m_queue[CountToIndex(currentWriteIndex)] = element;
+    new ((void *)&slot->element) T(element);
     
-    // Update the maximum read index after saving the data.
-    while (!std::atomic_compare_exchange_weak(&m_maxReadIndex, &currentWriteIndex, currentWriteIndex + 1))
+    // Publish the element to the consumer of this position.
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+bool LocklessQueue<T>::Push(T&& element)
+{
+    QI_ASSERT(m_allocatedSize > 0);
+    
+    uint32 position;
+    Slot *slot = ClaimPushSlot(position);
+    if (slot == nullptr)
     {
-        // Yield here in case there are more software threads than hardware processors.
-        std::this_thread::yield();
+        // The queue is full.
+        return false;
     }
     
+    new ((void *)&slot->element) T(std::move(element));
+    slot->sequence.store(position + 1, std::memory_order_release);
     return true;
 }
 
@@ -99,39 +140,42 @@ bool LocklessQueue<T>::Pop(T& element)
 {
     QI_ASSERT(m_allocatedSize > 0);
     
-    uint32 currentReadIndex;
-    
-    do
+    Slot *slot;
+    uint32 position = m_popPosition.value.load(std::memory_order_relaxed);
+    while (true)
     {
-        currentReadIndex = m_readIndex;
+        slot = &m_slots[position & m_mask];
+        uint32 sequence = slot->sequence.load(std::memory_order_acquire);
+        int difference = (int)(sequence - (position + 1));
         
-        if (GetSize() == 0)
+        if (difference == 0)
+        {
+            // The element is committed, try to claim it. On failure 'position' is reloaded.
+            if (m_popPosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
         {
-            // The queue is empty.
+            // The slot has not been written yet, the queue is empty.
             return false;
         }
-        
-        // Retrieve the data from the queue
-        element = m_queue[CountToIndex(currentReadIndex)];
-        
-        // Try to perfrom now the compare-and-exchange operation on the read index. If we succeed
-        // element already contains what m_readIndex pointed to before we
-        // increased it.
-        if (std::atomic_compare_exchange_weak(&m_readIndex, &currentReadIndex, currentReadIndex + 1))
+        else
         {
-            // Got here. The value was retrieved from the queue.
-            return true;
+            // Another consumer already took this position.
+            position = m_popPosition.value.load(std::memory_order_relaxed);
         }
-        
-        // The read has failed. A different thread must have read the element stored at
-        // CountToIndex(currentReadIndex) before we could perform the compare-and-exchange
-        // operation.
-        
-    } while(1); // Keep looping and try to read again.
+    }
+    
+    // The slot is ours alone until its sequence is advanced again.
+    T *stored = reinterpret_cast<T *>(&slot->element);
+    element = std::move(*stored);
+    stored->~T();
     
-    // Something went wrong. It shouldn't be possible to reach here.
-    QI_ASSERT(0 && "LockelssQueue::Pop() shouldn't ever get here");
-    return false;
+    // Hand the slot to the producer one lap ahead.
+    slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+    return true;
 }
 
 template<class T>
@@ -139,16 +183,56 @@ inline void LocklessQueue<T>::Clear()
 {
     QI_ASSERT(m_allocatedSize > 0);
     
-    m_readIndex    = 0;
-    m_writeIndex   = 0;
-    m_maxReadIndex = 0;
+    uint32 pushPosition = m_pushPosition.value.load(std::memory_order_relaxed);
+    for (uint32 position = m_popPosition.value.load(std::memory_order_relaxed); position != pushPosition; ++position)
+    {
+        reinterpret_cast<T *>(&m_slots[position & m_mask].element)->~T();
+    }
+    
+    ResetPositions();
 }
 
 template<class T>
-inline uint32 LocklessQueue<T>::CountToIndex(uint32 index)
+inline typename LocklessQueue<T>::Slot *LocklessQueue<T>::ClaimPushSlot(uint32 &position)
 {
-    return (index % m_allocatedSize);
+    position = m_pushPosition.value.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot *slot = &m_slots[position & m_mask];
+        uint32 sequence = slot->sequence.load(std::memory_order_acquire);
+        int difference = (int)(sequence - position);
+        
+        if (difference == 0)
+        {
+            // The slot is free, try to claim it. On failure 'position' is reloaded.
+            if (m_pushPosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                return slot;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds the element from the previous lap, the queue is full.
+            return nullptr;
+        }
+        else
+        {
+            // Another producer already took this position.
+            position = m_pushPosition.value.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-} // namespace Qi
+template<class T>
+inline void LocklessQueue<T>::ResetPositions()
+{
+    for (uint32 ii = 0; ii < m_allocatedSize; ++ii)
+    {
+        m_slots[ii].sequence.store(ii, std::memory_order_relaxed);
+    }
+    
+    m_pushPosition.value.store(0, std::memory_order_relaxed);
+    m_popPosition.value.store(0, std::memory_order_release);
+}
 
+} // namespace Qi
@@ -0,0 +1,181 @@
+//
+//  MPSCQueue.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Unbounded queue for any number of producer threads and a single consumer thread, meant for event
+/// and command streams whose producers have no sensible fallback for a full queue. This is Dmitry
+/// Vyukov's linked MPSC queue: a push is one atomic exchange and never waits on other threads. Every
+/// element lives in a node which is taken from a pool owned by the queue and handed back to the pool
+/// once the element is popped, so the queue only allocates (in chunks, from the MemorySystem) while
+/// the number of elements in flight reaches a new high. Nodes are not returned to the MemorySystem
+/// before the queue is destroyed.
+///
+/// NOTE: A producer which is preempted between its exchange and linking its node hides the elements
+/// pushed after it until it resumes. Pop() then reports an empty queue, the elements are not lost.
+///
+
+#include "../Defines.h"
+#include "../BaseTypes.h"
+#include "../Memory/MemoryCategory.h"
+#include <atomic>
+#include <type_traits>
+
+namespace Qi
+{
+
+template<class T>
+class MPSCQueue
+{
+	public:
+
+		MPSCQueue();
+		~MPSCQueue();
+
+		///
+		/// Initialize the queue and its node pool.
+		///
+		/// @param numNodes Number of nodes to allocate up front (rounded up to whole chunks).
+		/// @param category Category the node chunks are allocated from.
+		/// @return Status of allocating the pool.
+		///
+		Result Init(uint32 numNodes = m_NODES_PER_CHUNK, MemoryCategory category = MemoryCategory::kGeneral);
+
+		///
+		/// Check if Init() was called successfully.
+		///
+		inline bool IsInitialized() const;
+
+		///
+		/// Push an element onto the end of the queue. Safe to call from any thread.
+		///
+		/// @param element Element to push.
+		/// @return Success. Only fails if the pool is exhausted and cannot allocate another chunk.
+		///
+		inline bool Push(const T &element);
+		inline bool Push(T &&element);
+
+		///
+		/// Construct an element in place at the end of the queue. Safe to call from any thread.
+		///
+		/// @param args Arguments forwarded to T's constructor.
+		/// @return Success. Only fails if the pool is exhausted and cannot allocate another chunk.
+		///
+		template<class... Args>
+		bool Emplace(Args &&... args);
+
+		///
+		/// Pop an element off of the front of the queue. Consumer thread only.
+		///
+		/// @param element Receives the element (moved out of the queue).
+		/// @return Success. If false, the queue is empty.
+		///
+		bool Pop(T &element);
+
+		///
+		/// Get the number of nodes allocated for the pool. This stops growing once the queue has seen
+		/// its peak number of elements.
+		///
+		/// @return Number of allocated nodes (one is always in use by the queue itself).
+		///
+		inline uint32 GetNumAllocatedNodes() const;
+
+	private:
+
+		// Do not implement.
+		MPSCQueue(const MPSCQueue &other) = delete;
+		MPSCQueue &operator=(const MPSCQueue &other) = delete;
+
+		///
+		/// Element storage with its link in the queue and its link in the pool.
+		///
+		struct Node
+		{
+			std::atomic<Node *> next;    ///< Next node of the queue.
+			std::atomic<uint32> nextFree; ///< Index of the next node in the pool.
+			uint32 index;                 ///< Index of this node.
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type element;
+		};
+
+		///
+		/// Take a node from the pool, adding a chunk if the pool is empty.
+		///
+		/// @return Node or null if no more chunks can be allocated.
+		///
+		Node *AcquireNode();
+
+		///
+		/// Give a node back to the pool.
+		///
+		inline void ReleaseNode(Node *node);
+
+		///
+		/// Push a chain of nodes linked by 'nextFree' into the pool.
+		///
+		void ReleaseNodes(Node *first, Node *last);
+
+		///
+		/// Allocate a new chunk of nodes, keeping the first node for the caller and adding the rest to the pool.
+		///
+		/// @return First node of the chunk or null if it couldn't be allocated.
+		///
+		Node *AddChunk();
+
+		///
+		/// Link a node with a constructed element into the queue.
+		///
+		inline void PushNode(Node *node);
+
+		///
+		/// Free all chunks.
+		///
+		void Deinit();
+
+		///
+		/// Get a node from its index.
+		///
+		inline Node *GetNode(uint32 index) const;
+
+		///
+		/// The pool head is a node index along with a tag which changes on every update so that
+		/// a stale head can never be swapped in (the ABA problem).
+		///
+		static inline uint64 MakePoolHead(uint32 index, uint64 previousHead);
+
+		///
+		/// Most recently pushed node, exchanged by every producer.
+		///
+		struct QI_ALIGN(64) ProducerState
+		{
+			std::atomic<Node *> head;
+		};
+
+		///
+		/// Head of the node pool, touched by producers taking nodes and the consumer returning them.
+		///
+		struct QI_ALIGN(64) PoolState
+		{
+			std::atomic<uint64> head;
+			std::atomic<uint32> numChunks;
+		};
+
+		ProducerState m_producers;
+		PoolState m_pool;
+		Node *m_tail;              ///< Node whose element was popped last, only touched by the consumer.
+		Node **m_chunks;           ///< Table of all node chunks.
+		MemoryCategory m_category; ///< Category the chunks come from.
+
+		static const uint32 m_NODES_PER_CHUNK = 256;  ///< Number of nodes allocated at once.
+		static const uint32 m_MAX_CHUNKS      = 4096; ///< Size of the chunk table.
+		static const uint32 m_NO_NODE         = 0xffffffff;
+};
+
+} // namespace Qi
+
+#include "MPSCQueue.inl"
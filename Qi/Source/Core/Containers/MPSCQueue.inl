@@ -0,0 +1,266 @@
+//
+//  MPSCQueue.inl
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "../Memory/MemorySystem.h"
+#include <new>
+#include <utility>
+
+namespace Qi
+{
+
+template<class T>
+MPSCQueue<T>::MPSCQueue() :
+	m_tail(nullptr),
+	m_chunks(nullptr),
+	m_category(MemoryCategory::kGeneral)
+{
+	m_producers.head = nullptr;
+	m_pool.head = MakePoolHead(m_NO_NODE, 0);
+	m_pool.numChunks = 0;
+}
+
+template<class T>
+MPSCQueue<T>::~MPSCQueue()
+{
+	Deinit();
+}
+
+template<class T>
+Result MPSCQueue<T>::Init(uint32 numNodes, MemoryCategory category)
+{
+	QI_ASSERT(m_chunks == nullptr);
+
+	m_category = category;
+	m_chunks = Qi_AllocateUninitializedArrayFrom(Node *, m_MAX_CHUNKS, m_category);
+	if (m_chunks == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	for (uint32 ii = 0; ii < m_MAX_CHUNKS; ++ii)
+	{
+		m_chunks[ii] = nullptr;
+	}
+
+	// One extra node serves as the queue's initial (empty) tail.
+	for (uint32 allocated = 0; allocated < numNodes + 1; allocated += m_NODES_PER_CHUNK)
+	{
+		Node *node = AddChunk();
+		if (node == nullptr)
+		{
+			Deinit();
+			return Result(ReturnCode::kOutOfMemory);
+		}
+
+		ReleaseNode(node);
+	}
+
+	Node *stub = AcquireNode();
+	stub->next.store(nullptr, std::memory_order_relaxed);
+	m_tail = stub;
+	m_producers.head.store(stub, std::memory_order_release);
+
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T>
+bool MPSCQueue<T>::IsInitialized() const
+{
+	// Producers call this, so it must not read the consumer's tail. The chunk table is only written by Init() and Deinit().
+	return (m_chunks != nullptr);
+}
+
+template<class T>
+bool MPSCQueue<T>::Push(const T &element)
+{
+	return Emplace(element);
+}
+
+template<class T>
+bool MPSCQueue<T>::Push(T &&element)
+{
+	return Emplace(std::move(element));
+}
+
+template<class T>
+template<class... Args>
+bool MPSCQueue<T>::Emplace(Args &&... args)
+{
+	QI_ASSERT(IsInitialized());
+
+	Node *node = AcquireNode();
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	new ((void *)&node->element) T(std::forward<Args>(args)...);
+	PushNode(node);
+	return true;
+}
+
+template<class T>
+bool MPSCQueue<T>::Pop(T &element)
+{
+	QI_ASSERT(IsInitialized());
+
+	Node *tail = m_tail;
+	Node *next = tail->next.load(std::memory_order_acquire);
+	if (next == nullptr)
+	{
+		return false;
+	}
+
+	// 'next' becomes the new tail, its element is the one being popped.
+	T *stored = reinterpret_cast<T *>(&next->element);
+	element = std::move(*stored);
+	stored->~T();
+
+	// The producer which linked 'next' was the last one to touch the old tail.
+	m_tail = next;
+	ReleaseNode(tail);
+	return true;
+}
+
+template<class T>
+uint32 MPSCQueue<T>::GetNumAllocatedNodes() const
+{
+	return m_pool.numChunks.load(std::memory_order_relaxed) * m_NODES_PER_CHUNK;
+}
+
+template<class T>
+typename MPSCQueue<T>::Node *MPSCQueue<T>::AcquireNode()
+{
+	uint64 head = m_pool.head.load(std::memory_order_acquire);
+	while (true)
+	{
+		uint32 index = (uint32)head;
+		if (index == m_NO_NODE)
+		{
+			return AddChunk();
+		}
+
+		// Nodes are never freed while the queue exists, so reading a node which another thread
+		// takes at the same time is harmless: the tag makes the exchange below fail.
+		Node *node = GetNode(index);
+		uint32 nextFree = node->nextFree.load(std::memory_order_relaxed);
+		if (m_pool.head.compare_exchange_weak(head, MakePoolHead(nextFree, head), std::memory_order_acquire, std::memory_order_acquire))
+		{
+			return node;
+		}
+	}
+}
+
+template<class T>
+void MPSCQueue<T>::ReleaseNode(Node *node)
+{
+	ReleaseNodes(node, node);
+}
+
+template<class T>
+void MPSCQueue<T>::ReleaseNodes(Node *first, Node *last)
+{
+	uint64 head = m_pool.head.load(std::memory_order_relaxed);
+	do
+	{
+		last->nextFree.store((uint32)head, std::memory_order_relaxed);
+	} while (!m_pool.head.compare_exchange_weak(head, MakePoolHead(first->index, head), std::memory_order_release, std::memory_order_relaxed));
+}
+
+template<class T>
+typename MPSCQueue<T>::Node *MPSCQueue<T>::AddChunk()
+{
+	// Reserve a slot in the chunk table.
+	uint32 chunk = m_pool.numChunks.load(std::memory_order_relaxed);
+	do
+	{
+		if (chunk >= m_MAX_CHUNKS)
+		{
+			return nullptr;
+		}
+	} while (!m_pool.numChunks.compare_exchange_weak(chunk, chunk + 1, std::memory_order_relaxed));
+
+	Node *nodes = Qi_AllocateUninitializedArrayFrom(Node, m_NODES_PER_CHUNK, m_category);
+	if (nodes == nullptr)
+	{
+		// The slot stays empty, Deinit() skips it.
+		return nullptr;
+	}
+
+	for (uint32 ii = 0; ii < m_NODES_PER_CHUNK; ++ii)
+	{
+		Node *node = new ((void *)&nodes[ii]) Node;
+		node->index = chunk * m_NODES_PER_CHUNK + ii;
+		node->nextFree.store(node->index + 1, std::memory_order_relaxed);
+	}
+
+	// The table entry is published to other threads by the release in ReleaseNodes().
+	m_chunks[chunk] = nodes;
+	ReleaseNodes(&nodes[1], &nodes[m_NODES_PER_CHUNK - 1]);
+	return &nodes[0];
+}
+
+template<class T>
+void MPSCQueue<T>::PushNode(Node *node)
+{
+	node->next.store(nullptr, std::memory_order_relaxed);
+
+	// Take the head position, then link the previous head to this node. The consumer can't see
+	// the node until that link is stored.
+	Node *previous = m_producers.head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+template<class T>
+void MPSCQueue<T>::Deinit()
+{
+	if (m_chunks == nullptr)
+	{
+		return;
+	}
+
+	if (m_tail != nullptr)
+	{
+		// Destroy the elements which were never popped.
+		for (Node *node = m_tail->next.load(std::memory_order_acquire); node != nullptr; node = node->next.load(std::memory_order_acquire))
+		{
+			reinterpret_cast<T *>(&node->element)->~T();
+		}
+	}
+
+	uint32 numChunks = m_pool.numChunks.load(std::memory_order_acquire);
+	for (uint32 ii = 0; ii < numChunks; ++ii)
+	{
+		if (m_chunks[ii] != nullptr)
+		{
+			Qi_FreeMemoryArrayFrom(m_chunks[ii], m_category);
+		}
+	}
+
+	Qi_FreeMemoryArrayFrom(m_chunks, m_category);
+	m_chunks = nullptr;
+	m_tail = nullptr;
+	m_producers.head = nullptr;
+	m_pool.head = MakePoolHead(m_NO_NODE, 0);
+	m_pool.numChunks = 0;
+}
+
+template<class T>
+typename MPSCQueue<T>::Node *MPSCQueue<T>::GetNode(uint32 index) const
+{
+	return &m_chunks[index / m_NODES_PER_CHUNK][index % m_NODES_PER_CHUNK];
+}
+
+template<class T>
+uint64 MPSCQueue<T>::MakePoolHead(uint32 index, uint64 previousHead)
+{
+	uint64 tag = (previousHead >> 32) + 1;
+	return (tag << 32) | index;
+}
+
+} // namespace Qi
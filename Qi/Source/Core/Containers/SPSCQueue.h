@@ -0,0 +1,143 @@
+//
+//  SPSCQueue.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Bounded ring buffer for exactly one producer thread and one consumer thread, e.g. the sim thread
+/// feeding the render thread. Unlike LocklessQueue there are no compare-and-swap loops: each index is
+/// written by a single thread and published with a release store. Each side also keeps a private copy
+/// of the other side's index and only reloads the shared one when the copy says the ring is full (or
+/// empty), so in the common case a push or pop touches no cache line owned by the other thread.
+/// Batches of elements can be pushed and popped with a single index update.
+///
+
+#include "../Defines.h"
+#include "../BaseTypes.h"
+#include <atomic>
+
+namespace Qi
+{
+
+template<class T>
+class SPSCQueue
+{
+	public:
+
+		SPSCQueue();
+		~SPSCQueue();
+
+		///
+		/// Allocate the ring. The queue never grows afterwards.
+		///
+		/// @param size Number of elements the queue can hold, rounded up to a power of two.
+		///
+		inline void Init(uint32 size);
+
+		///
+		/// Get the number of elements the queue can hold.
+		///
+		/// @return Allocated size of the queue in terms of T elements.
+		///
+		inline uint32 GetAllocatedSize() const;
+
+		///
+		/// Get the current element count. Exact only from the producer or the consumer thread while the
+		/// other one is idle.
+		///
+		/// @return Number of elements in the queue.
+		///
+		inline uint32 GetSize() const;
+
+		///
+		/// Push an element onto the end of the queue. Producer thread only.
+		///
+		/// @param element Element to push.
+		/// @return Success. If false, the queue is full.
+		///
+		inline bool Push(const T &element);
+		inline bool Push(T &&element);
+
+		///
+		/// Pop an element off of the front of the queue. Consumer thread only.
+		///
+		/// @param element Receives the element (moved out of the queue).
+		/// @return Success. If false, the queue is empty.
+		///
+		inline bool Pop(T &element);
+
+		///
+		/// Push as many elements of a span as fit, publishing them all at once. Producer thread only.
+		///
+		/// @param elements Elements to copy into the queue.
+		/// @param count Number of elements in 'elements'.
+		/// @return Number of elements pushed (the first ones of the span).
+		///
+		uint32 PushBatch(const T *elements, uint32 count);
+
+		///
+		/// Pop up to 'maxCount' elements into a span, releasing their slots all at once. Consumer thread only.
+		///
+		/// @param elements Receives the popped elements in order.
+		/// @param maxCount Number of elements 'elements' can hold.
+		/// @return Number of elements popped.
+		///
+		uint32 PopBatch(T *elements, uint32 maxCount);
+
+		///
+		/// Destroy all elements in the queue. NOTE: This is not a threadsafe operation!!!
+		///
+		void Clear();
+
+	private:
+
+		// Do not implement.
+		SPSCQueue(const SPSCQueue &other) = delete;
+		SPSCQueue &operator=(const SPSCQueue &other) = delete;
+
+		///
+		/// Get the number of free slots, reloading the consumer's index if the cached one says the
+		/// queue is too full for 'wanted' elements.
+		///
+		inline uint32 GetFreeSlots(uint32 pushIndex, uint32 wanted);
+
+		///
+		/// Get the number of elements ready to pop, reloading the producer's index if the cached one
+		/// says there are fewer than 'wanted'.
+		///
+		inline uint32 GetReadyElements(uint32 popIndex, uint32 wanted);
+
+		///
+		/// State written by the producer, on its own cache line.
+		///
+		struct QI_ALIGN(64) ProducerState
+		{
+			std::atomic<uint32> pushIndex; ///< Free running index of the next element to push.
+			uint32 cachedPopIndex;         ///< Last pop index the producer has seen.
+		};
+
+		///
+		/// State written by the consumer, on its own cache line.
+		///
+		struct QI_ALIGN(64) ConsumerState
+		{
+			std::atomic<uint32> popIndex;  ///< Free running index of the next element to pop.
+			uint32 cachedPushIndex;        ///< Last push index the consumer has seen.
+		};
+
+		ProducerState m_producer;
+		ConsumerState m_consumer;
+
+		T *m_elements;           ///< Ring storage. Only the elements between the pop and push index are constructed.
+		uint32 m_mask;           ///< Allocated size - 1, maps an index to its element.
+		uint32 m_allocatedSize;  ///< Number of elements the ring holds.
+};
+
+} // namespace Qi
+
+#include "SPSCQueue.inl"
@@ -0,0 +1,222 @@
+//
+//  SPSCQueue.inl
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "../Memory/MemorySystem.h"
+#include <new>
+#include <utility>
+
+namespace Qi
+{
+
+template<class T>
+SPSCQueue<T>::SPSCQueue() :
+	m_elements(nullptr),
+	m_mask(0),
+	m_allocatedSize(0)
+{
+	m_producer.pushIndex = 0;
+	m_producer.cachedPopIndex = 0;
+	m_consumer.popIndex = 0;
+	m_consumer.cachedPushIndex = 0;
+}
+
+template<class T>
+SPSCQueue<T>::~SPSCQueue()
+{
+	if (m_elements != nullptr)
+	{
+		Clear();
+		Qi_FreeMemoryArray(m_elements);
+		m_elements = nullptr;
+	}
+
+	m_allocatedSize = 0;
+}
+
+template<class T>
+void SPSCQueue<T>::Init(uint32 size)
+{
+	QI_ASSERT(m_allocatedSize == 0);
+	QI_ASSERT(size > 0 && size <= (1u << 31));
+
+	uint32 allocatedSize = 1;
+	while (allocatedSize < size)
+	{
+		allocatedSize <<= 1;
+	}
+
+	m_elements = Qi_AllocateUninitializedArrayFrom(T, allocatedSize, MemoryCategory::kGeneral);
+	QI_ASSERT(m_elements != nullptr);
+	if (m_elements != nullptr)
+	{
+		m_allocatedSize = allocatedSize;
+		m_mask = allocatedSize - 1;
+	}
+}
+
+template<class T>
+uint32 SPSCQueue<T>::GetAllocatedSize() const
+{
+	return m_allocatedSize;
+}
+
+template<class T>
+uint32 SPSCQueue<T>::GetSize() const
+{
+	uint32 popIndex  = m_consumer.popIndex.load(std::memory_order_acquire);
+	uint32 pushIndex = m_producer.pushIndex.load(std::memory_order_acquire);
+	return pushIndex - popIndex;
+}
+
+template<class T>
+bool SPSCQueue<T>::Push(const T &element)
+{
+	QI_ASSERT(m_allocatedSize > 0);
+
+	uint32 pushIndex = m_producer.pushIndex.load(std::memory_order_relaxed);
+	if (GetFreeSlots(pushIndex, 1) == 0)
+	{
+		return false;
+	}
+
+	new ((void *)&m_elements[pushIndex & m_mask]) T(element);
+	m_producer.pushIndex.store(pushIndex + 1, std::memory_order_release);
+	return true;
+}
+
+template<class T>
+bool SPSCQueue<T>::Push(T &&element)
+{
+	QI_ASSERT(m_allocatedSize > 0);
+
+	uint32 pushIndex = m_producer.pushIndex.load(std::memory_order_relaxed);
+	if (GetFreeSlots(pushIndex, 1) == 0)
+	{
+		return false;
+	}
+
+	new ((void *)&m_elements[pushIndex & m_mask]) T(std::move(element));
+	m_producer.pushIndex.store(pushIndex + 1, std::memory_order_release);
+	return true;
+}
+
+template<class T>
+bool SPSCQueue<T>::Pop(T &element)
+{
+	QI_ASSERT(m_allocatedSize > 0);
+
+	uint32 popIndex = m_consumer.popIndex.load(std::memory_order_relaxed);
+	if (GetReadyElements(popIndex, 1) == 0)
+	{
+		return false;
+	}
+
+	T &stored = m_elements[popIndex & m_mask];
+	element = std::move(stored);
+	stored.~T();
+
+	m_consumer.popIndex.store(popIndex + 1, std::memory_order_release);
+	return true;
+}
+
+template<class T>
+uint32 SPSCQueue<T>::PushBatch(const T *elements, uint32 count)
+{
+	QI_ASSERT(m_allocatedSize > 0);
+
+	uint32 pushIndex = m_producer.pushIndex.load(std::memory_order_relaxed);
+	uint32 freeSlots = GetFreeSlots(pushIndex, count);
+	if (count > freeSlots)
+	{
+		count = freeSlots;
+	}
+
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		new ((void *)&m_elements[(pushIndex + ii) & m_mask]) T(elements[ii]);
+	}
+
+	if (count > 0)
+	{
+		m_producer.pushIndex.store(pushIndex + count, std::memory_order_release);
+	}
+
+	return count;
+}
+
+template<class T>
+uint32 SPSCQueue<T>::PopBatch(T *elements, uint32 maxCount)
+{
+	QI_ASSERT(m_allocatedSize > 0);
+
+	uint32 popIndex = m_consumer.popIndex.load(std::memory_order_relaxed);
+	uint32 count = GetReadyElements(popIndex, maxCount);
+	if (count > maxCount)
+	{
+		count = maxCount;
+	}
+
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		T &stored = m_elements[(popIndex + ii) & m_mask];
+		elements[ii] = std::move(stored);
+		stored.~T();
+	}
+
+	if (count > 0)
+	{
+		m_consumer.popIndex.store(popIndex + count, std::memory_order_release);
+	}
+
+	return count;
+}
+
+template<class T>
+void SPSCQueue<T>::Clear()
+{
+	uint32 pushIndex = m_producer.pushIndex.load(std::memory_order_relaxed);
+	for (uint32 index = m_consumer.popIndex.load(std::memory_order_relaxed); index != pushIndex; ++index)
+	{
+		m_elements[index & m_mask].~T();
+	}
+
+	m_producer.pushIndex.store(0, std::memory_order_relaxed);
+	m_producer.cachedPopIndex = 0;
+	m_consumer.popIndex.store(0, std::memory_order_relaxed);
+	m_consumer.cachedPushIndex = 0;
+}
+
+template<class T>
+uint32 SPSCQueue<T>::GetFreeSlots(uint32 pushIndex, uint32 wanted)
+{
+	uint32 freeSlots = m_allocatedSize - (pushIndex - m_producer.cachedPopIndex);
+	if (freeSlots < wanted)
+	{
+		// Acquire pairs with the consumer's release so its reads of the slots are finished.
+		m_producer.cachedPopIndex = m_consumer.popIndex.load(std::memory_order_acquire);
+		freeSlots = m_allocatedSize - (pushIndex - m_producer.cachedPopIndex);
+	}
+
+	return freeSlots;
+}
+
+template<class T>
+uint32 SPSCQueue<T>::GetReadyElements(uint32 popIndex, uint32 wanted)
+{
+	uint32 readyElements = m_consumer.cachedPushIndex - popIndex;
+	if (readyElements < wanted)
+	{
+		// Acquire pairs with the producer's release so the elements are fully written.
+		m_consumer.cachedPushIndex = m_producer.pushIndex.load(std::memory_order_acquire);
+		readyElements = m_consumer.cachedPushIndex - popIndex;
+	}
+
+	return readyElements;
+}
+
+} // namespace Qi
@@ -10,8 +10,15 @@
 
 ///
 /// Create and store a tightly packed array which re-orders itself if any of its
-/// elements have been removed. All data should be accessed via handles which are 
-/// maintained by this object. This object is sized once and will never grow/shrink.
+/// elements have been removed. All data should be accessed via handles which are
+/// maintained by this object. Elements live in fixed-size pages which are allocated
+/// on demand, so the array grows without moving any element: handles and element addresses
+/// stay valid while it grows (releasing a handle still moves the last element into the hole).
+/// The live elements are always the first GetNumValidHandles() indices, spanning the pages.
+/// Handles carry the generation of the slot they were acquired from, and a slot's generation
+/// changes every time it is released. A handle which outlived its element is therefore detected
+/// by IsValid() (and asserted on by the accessors) instead of aliasing whichever element reuses
+/// the slot.
 ///
 
 #include "../Defines.h"
@@ -28,18 +35,40 @@ class TightlyPackedArray
 
 		TightlyPackedArray();
 		~TightlyPackedArray();
+
+		///
+		/// Create an array which allocates its memory from a specific category.
+		///
+		/// @param category Category to allocate all internal data from.
+		///
+		explicit TightlyPackedArray(MemoryCategory category);
+
 		TightlyPackedArray(const TightlyPackedArray &other);
 		TightlyPackedArray &operator=(const TightlyPackedArray &other);
+
+		///
+		/// Move constructor/assignment. The other array's internal buffers are taken over and it is left empty.
+		///
+		TightlyPackedArray(TightlyPackedArray &&other);
+		TightlyPackedArray &operator=(TightlyPackedArray &&other);
 		inline T &operator[](int index) const;
 
 		///
-		/// Set the size of the array. Should only be called once during initialization.
+		/// Allocate pages for at least 'size' elements up front. The array grows beyond this
+		/// size on demand, one page at a time.
 		///
-		/// @param size Size (in elements) to set the array.
+		/// @param size Size (in elements) to reserve.
 		/// @return Status.
 		///
 		inline Result SetSize(uint32 size);
 
+		///
+		/// Set the category the array allocates its memory from. Must be called before SetSize().
+		///
+		/// @param category Category to allocate all internal data from.
+		///
+		inline void SetMemoryCategory(MemoryCategory category);
+
 		///
 		/// Free the internal data. SetSize() may be called again after a call
 		/// to this function.
@@ -54,18 +83,42 @@ class TightlyPackedArray
 		inline uint32 GetNumValidHandles() const;
 
 		///
-		/// Handle to use when querying this container. A handle is always guaranteed to be unique
-		/// and never change until being released back to the container.
+		/// Get the number of elements the allocated pages hold.
+		///
+		/// @return Number of handles which can be acquired before another page is allocated.
+		///
+		inline uint32 GetCapacity() const;
+
+		///
+		/// Handle to use when querying this container. The low 32 bits are the index of a slot, the
+		/// high 32 bits the generation of that slot when the handle was acquired. A handle stays valid
+		/// until it is released back to the container and is never valid again afterwards (until the
+		/// slot's 32 bit generation wraps around).
+		///
+		typedef uint64 Handle;
+
+		///
+		/// Handle which is never valid.
 		///
-		typedef uint32 Handle;
+		static const Handle INVALID_HANDLE = ~0ull;
 
 		///
-		/// Get a new handle from the container. This handle is guaranteed to be unique.
+		/// Get a new handle from the container, allocating another page if all are in use.
 		///
-		/// @return Unique handle.
+		/// @return Unique handle or INVALID_HANDLE if a new page could not be allocated.
 		///
 		inline Handle AquireHandle();
 
+		///
+		/// Get several new handles at once. All pages the batch needs are allocated up front, so
+		/// either every handle is acquired or none is.
+		///
+		/// @param handles Receives the new handles.
+		/// @param count Number of handles to acquire.
+		/// @return Status (can run out of memory).
+		///
+		Result AcquireHandles(Handle *handles, uint32 count);
+
 		///
 		/// Give a handle back to the system. The object that links with this handle will no longer
 		/// be valid. Note that this function will perform data packing to ensure that the underlying
@@ -75,6 +128,24 @@ class TightlyPackedArray
 		///
 		inline void ReleaseHandle(const Handle &handle);
 
+		///
+		/// Give several handles back at once. Instead of one swap per handle, the released elements
+		/// are compacted in a single pass which moves every surviving element at most once.
+		///
+		/// @param handles Handles to release. Each must be valid and appear only once.
+		/// @param count Number of handles in 'handles'.
+		///
+		void ReleaseHandles(const Handle *handles, uint32 count);
+
+		///
+		/// Check if a handle still references an element, i.e. it was acquired from this container
+		/// and has not been released since.
+		///
+		/// @param handle Handle to check.
+		/// @return True if the handle can be used to access an element.
+		///
+		inline bool IsValid(const Handle &handle) const;
+
 		///
 		/// Get an element from the container using a handle. The handle must be valid.
 		///
@@ -91,23 +162,72 @@ class TightlyPackedArray
 		///
 		struct Record
 		{
-			Handle uniqueIndex; ///< Index that is unique to only this data element.
+			uint32 uniqueIndex; ///< Slot index that is unique to only this data element.
 			T data;             ///< Data itself
 		};
 
-		Array<Record> m_elements; ///< All entities contained within this container. This array is allocated once and handles
-		                          ///  to the internal objects are then used to interact with them. All objects are guaranteed
-		                          ///  to be tightly packed together.
-		Array<Handle> m_indexMap; ///< Map of element handles to indices within 'm_elements'. The index of an element may change
+		///
+		/// Allocate another page and add its slots to the free list.
+		///
+		/// @return Status (can run out of memory).
+		///
+		Result AddPage();
+
+		///
+		/// Hand out the slot on top of the free list. The free list must not be empty.
+		///
+		inline Handle TakeFreeSlot();
+
+		///
+		/// Invalidate a slot whose element has been moved out of the live range, and put it back on the free list.
+		///
+		inline void FreeSlot(uint32 index);
+
+		///
+		/// Allocate a page, constructing its records as copies of another page's or default constructing them.
+		///
+		Record *AllocatePage(const Record *source);
+
+		///
+		/// Destroy the records of all pages and free them.
+		///
+		void FreePages();
+
+		///
+		/// Get the record at a dense element index.
+		///
+		inline Record &GetRecord(uint32 elementIndex) const;
+
+		///
+		/// Build a handle from a slot index and its generation.
+		///
+		static inline Handle MakeHandle(uint32 index, uint32 generation);
+
+		///
+		/// Get the slot index of a handle.
+		///
+		static inline uint32 GetHandleIndex(const Handle &handle);
+
+		///
+		/// Get the generation of a handle.
+		///
+		static inline uint32 GetHandleGeneration(const Handle &handle);
+
+		Array<Record *> m_pages;  ///< Pages of 'm_PAGE_SIZE' records each. Pages are never moved or freed before Clear(),
+		                          ///  the live elements are tightly packed into the first 'm_numValidElements' records.
+		Array<uint32> m_indexMap; ///< Map of handle slot indices to indices of the records. The index of an element may change
 		                          ///  during removal of released handles to handle fragmentation.
-		Array<Handle> m_elementIndexFreeList; ///< List of free unique indices for new elements to use.
+		Array<uint32> m_generations;          ///< Current generation of every slot, bumped whenever the slot is released.
+		Array<uint32> m_elementIndexFreeList; ///< Stack of free unique indices for new elements to use.
 
-		uint32 m_numValidElements; ///< Number of live (valid) objects within the 'm_elements' array (objects with valid handles).
-		uint32 m_numFreeIndices;   ///< Number of free indices in the freelist.
+		uint32 m_numValidElements; ///< Number of live (valid) objects within the pages (objects with valid handles).
+		MemoryCategory m_category; ///< Category the pages are allocated from.
 
 		static const uint32 INVALID_INDEX = UINT_MAX;
+		static const uint32 m_PAGE_SHIFT = 8;                  ///< log2 of the number of records per page.
+		static const uint32 m_PAGE_SIZE  = 1u << m_PAGE_SHIFT; ///< Number of records per page.
 };
 
 } // namespace Qi
 
-#include "TightlyPackedArray.inl"
\ No newline at end of file
+#include "TightlyPackedArray.inl"
@@ -6,26 +6,57 @@
 //  Copyright (c) 2015 Cody White. All rights reserved.
 //
 
+#include <new>
+#include <utility>
+
 namespace Qi
 {
 
+template<class T>
+const typename TightlyPackedArray<T>::Handle TightlyPackedArray<T>::INVALID_HANDLE;
+
+template<class T>
+const uint32 TightlyPackedArray<T>::INVALID_INDEX;
+
 template<class T>
 TightlyPackedArray<T>::TightlyPackedArray() :
-	m_numFreeIndices(0),
-	m_numValidElements(0)
+	m_numValidElements(0),
+	m_category(MemoryCategory::kGeneral)
+{
+}
+
+template<class T>
+TightlyPackedArray<T>::TightlyPackedArray(MemoryCategory category) :
+	m_pages(category),
+	m_indexMap(category),
+	m_generations(category),
+	m_elementIndexFreeList(category),
+	m_numValidElements(0),
+	m_category(category)
 {
 }
 
 template<class T>
 TightlyPackedArray<T>::~TightlyPackedArray()
 {
-	m_elements.Clear();
+	Clear();
 }
 
 template<class T>
 TightlyPackedArray<T>::TightlyPackedArray(const TightlyPackedArray<T> &other) :
-	m_elements(other.m_elements)
+	m_pages(other.m_category),
+	m_indexMap(other.m_indexMap),
+	m_generations(other.m_generations),
+	m_elementIndexFreeList(other.m_elementIndexFreeList),
+	m_numValidElements(other.m_numValidElements),
+	m_category(other.m_category)
 {
+	for (size_t ii = 0; ii < other.m_pages.GetSize(); ++ii)
+	{
+		Record *page = AllocatePage(other.m_pages[ii]);
+		QI_ASSERT(page != nullptr);
+		m_pages.PushBack(page);
+	}
 }
 
 template<class T>
@@ -33,7 +64,53 @@ TightlyPackedArray<T> &TightlyPackedArray<T>::operator=(const TightlyPackedArray
 {
 	if (this != &other)
 	{
-		m_elements = other.m_elements;
+		// The copy keeps allocating from this array's category.
+		Clear();
+
+		m_indexMap             = other.m_indexMap;
+		m_generations          = other.m_generations;
+		m_elementIndexFreeList = other.m_elementIndexFreeList;
+		m_numValidElements     = other.m_numValidElements;
+
+		for (size_t ii = 0; ii < other.m_pages.GetSize(); ++ii)
+		{
+			Record *page = AllocatePage(other.m_pages[ii]);
+			QI_ASSERT(page != nullptr);
+			m_pages.PushBack(page);
+		}
+	}
+
+	return *this;
+}
+
+template<class T>
+TightlyPackedArray<T>::TightlyPackedArray(TightlyPackedArray<T> &&other) :
+	m_pages(std::move(other.m_pages)),
+	m_indexMap(std::move(other.m_indexMap)),
+	m_generations(std::move(other.m_generations)),
+	m_elementIndexFreeList(std::move(other.m_elementIndexFreeList)),
+	m_numValidElements(other.m_numValidElements),
+	m_category(other.m_category)
+{
+	other.m_numValidElements = 0;
+}
+
+template<class T>
+TightlyPackedArray<T> &TightlyPackedArray<T>::operator=(TightlyPackedArray<T> &&other)
+{
+	if (this != &other)
+	{
+		// The pages stay in the category they were allocated from, so the category moves along with them.
+		Clear();
+
+		m_pages                = std::move(other.m_pages);
+		m_indexMap             = std::move(other.m_indexMap);
+		m_generations          = std::move(other.m_generations);
+		m_elementIndexFreeList = std::move(other.m_elementIndexFreeList);
+		m_numValidElements     = other.m_numValidElements;
+		m_category             = other.m_category;
+
+		other.m_numValidElements = 0;
 	}
 
 	return *this;
@@ -42,45 +119,63 @@ TightlyPackedArray<T> &TightlyPackedArray<T>::operator=(const TightlyPackedArray
 template<class T>
 T &TightlyPackedArray<T>::operator[](int index) const
 {
-	QI_ASSERT(index < (int)m_numValidElements);
-	return m_elements[index].data;
+	QI_ASSERT(index >= 0 && index < (int)m_numValidElements);
+	return GetRecord((uint32)index).data;
 }
 
 template<class T>
 Result TightlyPackedArray<T>::SetSize(uint32 size)
 {
-	QI_ASSERT(m_elements.GetSize() == 0);
+	QI_ASSERT(m_pages.GetSize() == 0);
 
-	Result result = m_elements.Resize(size);
-	if (result.IsValid())
+	Result result(ReturnCode::kSuccess);
+	while (GetCapacity() < size && result.IsValid())
 	{
-		result = m_indexMap.Resize(size);
-		if (result.IsValid())
-		{
-			result = m_elementIndexFreeList.Resize(size);
+		result = AddPage();
+	}
 
-			// Set the ID map values to an invalid index.
-			for (uint32 ii = 0; ii < size; ++ii)
-			{
-				m_indexMap[ii] = INVALID_INDEX;
-				m_elementIndexFreeList[ii] = size - ii - 1; // Insert backwards for easier tracking later.
-			}
+	// Every page stacked its own slots, restack them all so that the lowest slots are handed out first.
+	m_elementIndexFreeList.Clear();
+	if (result.IsValid())
+	{
+		result = m_elementIndexFreeList.Reserve(GetCapacity());
+	}
 
-			m_numFreeIndices = size;
+	if (result.IsValid())
+	{
+		for (uint32 ii = GetCapacity(); ii > 0; --ii)
+		{
+			m_elementIndexFreeList.PushBack(ii - 1);
 		}
 	}
+	else
+	{
+		Clear();
+	}
 
 	return result;
 }
 
+template<class T>
+void TightlyPackedArray<T>::SetMemoryCategory(MemoryCategory category)
+{
+	QI_ASSERT(m_pages.GetAllocateSize() == 0);
+
+	m_pages.SetMemoryCategory(category);
+	m_indexMap.SetMemoryCategory(category);
+	m_generations.SetMemoryCategory(category);
+	m_elementIndexFreeList.SetMemoryCategory(category);
+	m_category = category;
+}
+
 template<class T>
 void TightlyPackedArray<T>::Clear()
 {
+	FreePages();
 	m_elementIndexFreeList.Clear();
 	m_indexMap.Clear();
-	m_elements.Clear();
+	m_generations.Clear();
 
-	m_numFreeIndices   = 0;
 	m_numValidElements = 0;
 }
 
@@ -90,59 +185,276 @@ uint32 TightlyPackedArray<T>::GetNumValidHandles() const
 	return m_numValidElements;
 }
 
+template<class T>
+uint32 TightlyPackedArray<T>::GetCapacity() const
+{
+	return (uint32)m_pages.GetSize() * m_PAGE_SIZE;
+}
+
 template<class T>
 typename TightlyPackedArray<T>::Handle TightlyPackedArray<T>::AquireHandle()
 {
-	QI_ASSERT(m_numFreeIndices > 0);
+	if (m_elementIndexFreeList.GetSize() == 0 && !AddPage().IsValid())
+	{
+		return INVALID_HANDLE;
+	}
 
-	Handle handle = m_elementIndexFreeList[m_numFreeIndices - 1];
-	--m_numFreeIndices;
+	return TakeFreeSlot();
+}
 
-	m_indexMap[handle] = m_numValidElements;
-	m_elements[m_numValidElements].uniqueIndex = handle;
+template<class T>
+Result TightlyPackedArray<T>::AcquireHandles(Handle *handles, uint32 count)
+{
+	while (m_elementIndexFreeList.GetSize() < count)
+	{
+		Result result = AddPage();
+		if (!result.IsValid())
+		{
+			return result;
+		}
+	}
 
-	++m_numValidElements;
-	return handle;
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		handles[ii] = TakeFreeSlot();
+	}
+
+	return Result(ReturnCode::kSuccess);
 }
 
 template<class T>
 void TightlyPackedArray<T>::ReleaseHandle(const typename TightlyPackedArray<T>::Handle &handle)
 {
-	QI_ASSERT(handle < m_numValidElements);
+	QI_ASSERT(IsValid(handle));
 
+	uint32 index       = GetHandleIndex(handle);
 	uint32 endElement  = m_numValidElements - 1;
-	uint32 mappedIndex = m_indexMap[handle];
-
-	QI_ASSERT(mappedIndex != INVALID_INDEX);
+	uint32 mappedIndex = m_indexMap[index];
 
 	// Swap the element to be removed with the last element in the list.
-	std::swap(m_elements[mappedIndex], m_elements[endElement]);
+	Record &removed = GetRecord(mappedIndex);
+	std::swap(removed, GetRecord(endElement));
 
-	// Update the id map so that the newly swapped element knows where it is later on.
-	m_indexMap[mappedIndex] = INVALID_INDEX;
-	m_indexMap[m_elements[mappedIndex].uniqueIndex] = mappedIndex;
+	// Update the id map so that the newly swapped element knows where it is later on. The released
+	// slot is invalidated afterwards in case it was the last element itself.
+	m_indexMap[removed.uniqueIndex] = mappedIndex;
 
 	--m_numValidElements;
-	m_elementIndexFreeList[m_numFreeIndices] = handle;
-	++m_numFreeIndices;
+	FreeSlot(index);
+}
+
+template<class T>
+void TightlyPackedArray<T>::ReleaseHandles(const Handle *handles, uint32 count)
+{
+	QI_ASSERT(count <= m_numValidElements);
+
+	// Mark the released elements first so that the compaction below can tell them apart.
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		QI_ASSERT(IsValid(handles[ii]));
+
+		Record &record = GetRecord(m_indexMap[GetHandleIndex(handles[ii])]);
+		QI_ASSERT(record.uniqueIndex != INVALID_INDEX && "Handle released twice in one batch");
+		record.uniqueIndex = INVALID_INDEX;
+	}
+
+	// Every released element which is not already in the tail that is about to be cut off gets
+	// filled with a surviving element from that tail. The tail is walked backwards only once.
+	uint32 newNumValidElements = m_numValidElements - count;
+	uint32 tail = m_numValidElements;
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		uint32 index       = GetHandleIndex(handles[ii]);
+		uint32 mappedIndex = m_indexMap[index];
+
+		if (mappedIndex < newNumValidElements)
+		{
+			do
+			{
+				--tail;
+			} while (GetRecord(tail).uniqueIndex == INVALID_INDEX);
+
+			Record &hole = GetRecord(mappedIndex);
+			std::swap(hole, GetRecord(tail));
+			m_indexMap[hole.uniqueIndex] = mappedIndex;
+		}
+
+		FreeSlot(index);
+	}
+
+	m_numValidElements = newNumValidElements;
+}
+
+template<class T>
+bool TightlyPackedArray<T>::IsValid(const Handle &handle) const
+{
+	uint32 index = GetHandleIndex(handle);
+	return (index < m_indexMap.GetSize()) &&
+	       (m_generations[index] == GetHandleGeneration(handle)) &&
+	       (m_indexMap[index] != INVALID_INDEX);
 }
 
 template<class T>
 T &TightlyPackedArray<T>::GetElement(const Handle &handle)
 {
-	Handle mappedIndex = m_indexMap[handle];
-	QI_ASSERT(mappedIndex != INVALID_INDEX);
+	QI_ASSERT(IsValid(handle));
+	uint32 mappedIndex = m_indexMap[GetHandleIndex(handle)];
 
-	return m_elements[mappedIndex].data;
+	return GetRecord(mappedIndex).data;
 }
 
 template<class T>
 const T &TightlyPackedArray<T>::GetElement(const Handle &handle) const
 {
-	Handle mappedIndex = m_indexMap[handle];
-	QI_ASSERT(mappedIndex != INVALID_INDEX);
+	QI_ASSERT(IsValid(handle));
+	uint32 mappedIndex = m_indexMap[GetHandleIndex(handle)];
+
+	return GetRecord(mappedIndex).data;
+}
+
+template<class T>
+Result TightlyPackedArray<T>::AddPage()
+{
+	uint32 firstIndex = GetCapacity();
+	if (firstIndex > INVALID_INDEX - m_PAGE_SIZE)
+	{
+		// Slot indices have to fit into the low half of a handle.
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	// Grow the tables first so that nothing can fail once the page is in place.
+	uint32 newCapacity = firstIndex + m_PAGE_SIZE;
+	Result result = m_pages.Reserve(m_pages.GetSize() + 1);
+	if (result.IsValid())
+	{
+		result = m_indexMap.Reserve(newCapacity);
+	}
+
+	if (result.IsValid())
+	{
+		result = m_generations.Reserve(newCapacity);
+	}
+
+	if (result.IsValid())
+	{
+		result = m_elementIndexFreeList.Reserve(newCapacity);
+	}
+
+	if (!result.IsValid())
+	{
+		return result;
+	}
+
+	Record *page = AllocatePage(nullptr);
+	if (page == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_pages.PushBack(page);
+	for (uint32 ii = 0; ii < m_PAGE_SIZE; ++ii)
+	{
+		// Generations start at 1 so that a zeroed handle is never valid.
+		m_indexMap.PushBack(INVALID_INDEX);
+		m_generations.PushBack(1);
+	}
+
+	// Insert backwards so the lowest slot of the page is handed out first.
+	for (uint32 ii = m_PAGE_SIZE; ii > 0; --ii)
+	{
+		m_elementIndexFreeList.PushBack(firstIndex + ii - 1);
+	}
+
+	return result;
+}
+
+template<class T>
+typename TightlyPackedArray<T>::Handle TightlyPackedArray<T>::TakeFreeSlot()
+{
+	uint32 index = m_elementIndexFreeList[m_elementIndexFreeList.GetSize() - 1];
+	m_elementIndexFreeList.PopBack();
+
+	m_indexMap[index] = m_numValidElements;
+	GetRecord(m_numValidElements).uniqueIndex = index;
+
+	++m_numValidElements;
+	return MakeHandle(index, m_generations[index]);
+}
+
+template<class T>
+void TightlyPackedArray<T>::FreeSlot(uint32 index)
+{
+	m_indexMap[index] = INVALID_INDEX;
+
+	// Outstanding copies of the handle are stale from now on. Generation 0 is skipped on wrap around.
+	uint32 generation = m_generations[index] + 1;
+	m_generations[index] = (generation != 0) ? generation : 1;
+
+	// The free list has room for every slot, pushing never allocates.
+	m_elementIndexFreeList.PushBack(index);
+}
+
+template<class T>
+typename TightlyPackedArray<T>::Record *TightlyPackedArray<T>::AllocatePage(const Record *source)
+{
+	Record *page = Qi_AllocateUninitializedArrayFrom(Record, m_PAGE_SIZE, m_category);
+	if (page != nullptr)
+	{
+		for (uint32 ii = 0; ii < m_PAGE_SIZE; ++ii)
+		{
+			if (source != nullptr)
+			{
+				new ((void *)&page[ii]) Record(source[ii]);
+			}
+			else
+			{
+				new ((void *)&page[ii]) Record();
+			}
+		}
+	}
 
-	return m_elements[mappedIndex].data;
+	return page;
+}
+
+template<class T>
+void TightlyPackedArray<T>::FreePages()
+{
+	for (size_t ii = 0; ii < m_pages.GetSize(); ++ii)
+	{
+		Record *page = m_pages[ii];
+		for (uint32 jj = 0; jj < m_PAGE_SIZE; ++jj)
+		{
+			page[jj].~Record();
+		}
+
+		Qi_FreeMemoryArrayFrom(page, m_category);
+	}
+
+	m_pages.Clear();
+}
+
+template<class T>
+typename TightlyPackedArray<T>::Record &TightlyPackedArray<T>::GetRecord(uint32 elementIndex) const
+{
+	return m_pages[elementIndex >> m_PAGE_SHIFT][elementIndex & (m_PAGE_SIZE - 1)];
+}
+
+template<class T>
+typename TightlyPackedArray<T>::Handle TightlyPackedArray<T>::MakeHandle(uint32 index, uint32 generation)
+{
+	return ((Handle)generation << 32) | index;
+}
+
+template<class T>
+uint32 TightlyPackedArray<T>::GetHandleIndex(const Handle &handle)
+{
+	return (uint32)handle;
+}
+
+template<class T>
+uint32 TightlyPackedArray<T>::GetHandleGeneration(const Handle &handle)
+{
+	return (uint32)(handle >> 32);
 }
 
 } // namespace Qi
@@ -0,0 +1,144 @@
+//
+//  WorkStealingDeque.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Chase-Lev work-stealing deque (with the memory orderings of Le et al., "Correct and Efficient
+/// Work-Stealing for Weak Memory Models"), meant as the per-worker job list of a job system. The
+/// owning worker pushes and pops at the bottom with plain loads and stores; only popping the very
+/// last element races with thieves and needs a compare-and-swap. Any other thread can steal from the
+/// top with a single compare-and-swap. The deque doubles its buffer through the MemorySystem when
+/// it fills up. Buffers which were replaced may still be read by a thief, so they are only freed
+/// along with the deque.
+/// Elements are read by thieves which may lose the race for them, so T must be trivially copyable
+/// (a job pointer or handle, typically).
+///
+
+#include "../Defines.h"
+#include "../BaseTypes.h"
+#include "../Memory/MemoryCategory.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace Qi
+{
+
+template<class T>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque elements are copied by threads racing for them");
+
+	public:
+
+		WorkStealingDeque();
+		~WorkStealingDeque();
+
+		///
+		/// Allocate the initial buffer.
+		///
+		/// @param size Number of elements the deque holds before growing, rounded up to a power of two.
+		/// @param category Category the buffers are allocated from.
+		/// @return Status of allocating the buffer.
+		///
+		Result Init(uint32 size = m_DEFAULT_SIZE, MemoryCategory category = MemoryCategory::kGeneral);
+
+		///
+		/// Push an element onto the bottom of the deque. Owner thread only.
+		///
+		/// @param element Element to push.
+		/// @return Success. Only fails if the deque had to grow and ran out of memory.
+		///
+		inline bool Push(const T &element);
+
+		///
+		/// Pop the most recently pushed element. Owner thread only.
+		///
+		/// @param element Receives the element.
+		/// @return Success. If false, the deque is empty (or a thief took the last element).
+		///
+		inline bool Pop(T &element);
+
+		///
+		/// Steal the oldest element. Safe to call from any thread.
+		///
+		/// @param element Receives the element.
+		/// @return Success. If false, the deque was empty or another thread took the element first.
+		///
+		inline bool Steal(T &element);
+
+		///
+		/// Get the number of elements in the deque. Only a snapshot while other threads steal.
+		///
+		/// @return Element count.
+		///
+		inline uint32 GetSize() const;
+
+		///
+		/// Get the number of elements the current buffer holds.
+		///
+		/// @return Allocated size in terms of elements.
+		///
+		inline uint32 GetAllocatedSize() const;
+
+	private:
+
+		// Do not implement.
+		WorkStealingDeque(const WorkStealingDeque &other) = delete;
+		WorkStealingDeque &operator=(const WorkStealingDeque &other) = delete;
+
+		///
+		/// Ring of elements, indexed by the free running top/bottom positions.
+		///
+		struct Buffer
+		{
+			std::atomic<T> *elements; ///< Atomic so that a thief may read a slot the owner is overwriting.
+			int64_t mask;             ///< Number of elements - 1.
+			Buffer *retired;          ///< Buffer this one replaced, freed with the deque.
+		};
+
+		///
+		/// Allocate a buffer.
+		///
+		Buffer *AllocateBuffer(int64_t size);
+
+		///
+		/// Replace the buffer with one of twice the size holding the same elements.
+		///
+		/// @return New buffer or null if out of memory.
+		///
+		Buffer *Grow(Buffer *buffer, int64_t top, int64_t bottom);
+
+		///
+		/// Position of the oldest element, advanced by thieves (and the owner taking the last element).
+		///
+		struct QI_ALIGN(64) TopState
+		{
+			std::atomic<int64_t> top;
+		};
+
+		///
+		/// Position past the newest element along with the buffer, only written by the owner.
+		///
+		struct QI_ALIGN(64) BottomState
+		{
+			std::atomic<int64_t> bottom;
+			std::atomic<Buffer *> buffer;
+		};
+
+		TopState m_top;
+		BottomState m_bottom;
+		MemoryCategory m_category; ///< Category the buffers come from.
+
+		static const uint32 m_DEFAULT_SIZE = 256; ///< Default number of elements.
+};
+
+} // namespace Qi
+
+#include "WorkStealingDeque.inl"
@@ -0,0 +1,196 @@
+//
+//  WorkStealingDeque.inl
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "../Memory/MemorySystem.h"
+#include <new>
+
+namespace Qi
+{
+
+template<class T>
+WorkStealingDeque<T>::WorkStealingDeque() :
+	m_category(MemoryCategory::kGeneral)
+{
+	m_top.top = 0;
+	m_bottom.bottom = 0;
+	m_bottom.buffer = nullptr;
+}
+
+template<class T>
+WorkStealingDeque<T>::~WorkStealingDeque()
+{
+	Buffer *buffer = m_bottom.buffer.load(std::memory_order_relaxed);
+	while (buffer != nullptr)
+	{
+		Buffer *retired = buffer->retired;
+		Qi_FreeMemoryArrayFrom(buffer->elements, m_category);
+		Qi_FreeMemoryFrom(buffer, m_category);
+		buffer = retired;
+	}
+}
+
+template<class T>
+Result WorkStealingDeque<T>::Init(uint32 size, MemoryCategory category)
+{
+	QI_ASSERT(m_bottom.buffer.load(std::memory_order_relaxed) == nullptr);
+	QI_ASSERT(size > 0 && size <= (1u << 31));
+
+	int64_t allocatedSize = 1;
+	while (allocatedSize < size)
+	{
+		allocatedSize <<= 1;
+	}
+
+	m_category = category;
+	Buffer *buffer = AllocateBuffer(allocatedSize);
+	if (buffer == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_bottom.buffer.store(buffer, std::memory_order_release);
+	return Result(ReturnCode::kSuccess);
+}
+
+template<class T>
+bool WorkStealingDeque<T>::Push(const T &element)
+{
+	int64_t bottom = m_bottom.bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.top.load(std::memory_order_acquire);
+	Buffer *buffer = m_bottom.buffer.load(std::memory_order_relaxed);
+	QI_ASSERT(buffer != nullptr);
+
+	if (bottom - top > buffer->mask)
+	{
+		buffer = Grow(buffer, top, bottom);
+		if (buffer == nullptr)
+		{
+			return false;
+		}
+	}
+
+	buffer->elements[bottom & buffer->mask].store(element, std::memory_order_relaxed);
+
+	// The element has to be visible before a thief can see the new bottom.
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+template<class T>
+bool WorkStealingDeque<T>::Pop(T &element)
+{
+	int64_t bottom = m_bottom.bottom.load(std::memory_order_relaxed) - 1;
+	Buffer *buffer = m_bottom.buffer.load(std::memory_order_relaxed);
+	m_bottom.bottom.store(bottom, std::memory_order_relaxed);
+
+	// Thieves must see the reserved bottom before the owner reads top.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty, undo the reservation.
+		m_bottom.bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	element = buffer->elements[bottom & buffer->mask].load(std::memory_order_relaxed);
+	if (top < bottom)
+	{
+		// More than one element left, no thief can reach this one.
+		return true;
+	}
+
+	// Last element, race the thieves for it.
+	bool won = m_top.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	m_bottom.bottom.store(bottom + 1, std::memory_order_relaxed);
+	return won;
+}
+
+template<class T>
+bool WorkStealingDeque<T>::Steal(T &element)
+{
+	int64_t top = m_top.top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	// Read before claiming, the claim fails if the owner or another thief got there first.
+	Buffer *buffer = m_bottom.buffer.load(std::memory_order_acquire);
+	element = buffer->elements[top & buffer->mask].load(std::memory_order_relaxed);
+	return m_top.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+template<class T>
+uint32 WorkStealingDeque<T>::GetSize() const
+{
+	int64_t bottom = m_bottom.bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.top.load(std::memory_order_relaxed);
+	return (bottom > top) ? (uint32)(bottom - top) : 0;
+}
+
+template<class T>
+uint32 WorkStealingDeque<T>::GetAllocatedSize() const
+{
+	Buffer *buffer = m_bottom.buffer.load(std::memory_order_relaxed);
+	return (buffer != nullptr) ? (uint32)(buffer->mask + 1) : 0;
+}
+
+template<class T>
+typename WorkStealingDeque<T>::Buffer *WorkStealingDeque<T>::AllocateBuffer(int64_t size)
+{
+	Buffer *buffer = Qi_AllocateMemoryFrom(Buffer, m_category);
+	if (buffer == nullptr)
+	{
+		return nullptr;
+	}
+
+	buffer->elements = Qi_AllocateUninitializedArrayFrom(std::atomic<T>, (size_t)size, m_category);
+	if (buffer->elements == nullptr)
+	{
+		Qi_FreeMemoryFrom(buffer, m_category);
+		return nullptr;
+	}
+
+	for (int64_t ii = 0; ii < size; ++ii)
+	{
+		new ((void *)&buffer->elements[ii]) std::atomic<T>();
+	}
+
+	buffer->mask = size - 1;
+	buffer->retired = nullptr;
+	return buffer;
+}
+
+template<class T>
+typename WorkStealingDeque<T>::Buffer *WorkStealingDeque<T>::Grow(Buffer *buffer, int64_t top, int64_t bottom)
+{
+	Buffer *grown = AllocateBuffer((buffer->mask + 1) * 2);
+	if (grown == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Positions are free running, elements keep their positions in the larger ring.
+	for (int64_t ii = top; ii < bottom; ++ii)
+	{
+		grown->elements[ii & grown->mask].store(buffer->elements[ii & buffer->mask].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	// Thieves may still be reading the old buffer, keep it around until the deque is destroyed.
+	grown->retired = buffer;
+	m_bottom.buffer.store(grown, std::memory_order_release);
+	return grown;
+}
+
+} // namespace Qi
@@ -22,6 +22,12 @@
     #define QI_ASSERT(x)
 #endif
 
+// Allocation tracking (leak detection) is always on in debug builds. Define QI_TRACK_ALLOCATIONS
+// in the project settings to enable it in other builds as well (e.g. QA performance builds).
+#if defined(QI_DEBUG) && !defined(QI_TRACK_ALLOCATIONS)
+    #define QI_TRACK_ALLOCATIONS
+#endif
+
 #if defined(_MSC_VER)
     #define QI_WINDOWS
 #endif
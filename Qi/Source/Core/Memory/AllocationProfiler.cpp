@@ -0,0 +1,545 @@
+//
+//  AllocationProfiler.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "AllocationProfiler.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <new>
+
+#if defined(QI_WINDOWS)
+	#include <windows.h>
+#else
+	#include <cxxabi.h>
+	#include <dlfcn.h>
+	#include <execinfo.h>
+	#include <stdlib.h>
+#endif
+
+namespace Qi
+{
+
+namespace
+{
+	///
+	/// Sampling state of each thread. The generation is compared against the profiler's
+	/// generation to detect a countdown left over from a previous initialization.
+	///
+	struct ThreadSampler
+	{
+		uint64 bytesUntilSample;
+		uint64 randomState;
+		uint32 generation;
+	};
+
+	thread_local ThreadSampler t_sampler = { 0, 0, 0 };
+
+	///
+	/// Draw the number of bytes until the next sample from an exponential distribution with the given mean.
+	///
+	inline uint64 GetNextSampleDistance(ThreadSampler &sampler, uint32 samplingInterval)
+	{
+		// xorshift64*, seeded per thread from the address of its sampler.
+		if (sampler.randomState == 0)
+		{
+			sampler.randomState = (reinterpret_cast<uintptr_t>(&sampler) * 0x9E3779B97F4A7C15ull) | 1;
+		}
+
+		sampler.randomState ^= sampler.randomState >> 12;
+		sampler.randomState ^= sampler.randomState << 25;
+		sampler.randomState ^= sampler.randomState >> 27;
+		double uniform = (double)((sampler.randomState * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+
+		uint64 distance = (uint64)(-std::log(1.0 - uniform) * samplingInterval);
+		return (distance > 0) ? distance : 1;
+	}
+
+	///
+	/// Append the name of the function containing a return address, or the address itself if it has no symbol.
+	///
+	void AppendFrameName(std::string &report, void *frame)
+	{
+	#if !defined(QI_WINDOWS)
+		Dl_info info;
+		if (dladdr(frame, &info) != 0 && info.dli_sname != nullptr)
+		{
+			int status = 0;
+			char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+			const char *name = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+
+			// Semicolons separate frames in the folded format.
+			for (const char *character = name; *character != '\0'; ++character)
+			{
+				report += (*character != ';') ? *character : ':';
+			}
+
+			free(demangled);
+			return;
+		}
+	#endif
+
+		char address[32];
+		snprintf(address, sizeof(address), "0x%llx", (unsigned long long)reinterpret_cast<uintptr_t>(frame));
+		report += address;
+	}
+
+	///
+	/// Fibonacci hash of an address, the low bits of an address are mostly alignment.
+	///
+	inline uint64 HashAddress(const void *address)
+	{
+		return static_cast<uint64>(reinterpret_cast<uintptr_t>(address)) * 0x9E3779B97F4A7C15ull;
+	}
+}
+
+std::atomic<uint32> AllocationProfiler::m_nextGeneration(1);
+
+AllocationProfiler::AllocationProfiler() :
+	m_stacks(nullptr),
+	m_numStacks(0),
+	m_maxStacks(0),
+	m_stackTable(nullptr),
+	m_stackTableMask(0),
+	m_liveSamples(nullptr),
+	m_liveSampleMask(0),
+	m_numLiveSamples(0),
+	m_maxLiveSamples(0),
+	m_sampleFilter(nullptr),
+	m_samplingInterval(0),
+	m_generation(0),
+	m_numDroppedSamples(0),
+	m_initialized(false)
+{
+}
+
+AllocationProfiler::~AllocationProfiler()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result AllocationProfiler::Init(const Cinfo &info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info.samplingInterval > 0 && info.maxStacks > 0 && info.maxLiveSamples > 0);
+
+	// Keep both hash tables at most half full so that probe sequences stay short.
+	uint32 stackTableSize = 1;
+	while (stackTableSize < info.maxStacks * 2)
+	{
+		stackTableSize <<= 1;
+	}
+
+	uint32 liveSampleTableSize = 1;
+	while (liveSampleTableSize < info.maxLiveSamples * 2)
+	{
+		liveSampleTableSize <<= 1;
+	}
+
+	// The tables are allocated straight from the operating system, profiling must not go through the memory system.
+	m_stacks       = new (std::nothrow) Stack[info.maxStacks];
+	m_stackTable   = new (std::nothrow) uint32[stackTableSize];
+	m_liveSamples  = new (std::nothrow) LiveSample[liveSampleTableSize];
+	m_sampleFilter = new (std::nothrow) std::atomic<uint32>[1 << m_FILTER_SIZE_LOG2];
+	if (m_stacks == nullptr || m_stackTable == nullptr || m_liveSamples == nullptr || m_sampleFilter == nullptr)
+	{
+		delete [] m_stacks;
+		delete [] m_stackTable;
+		delete [] m_liveSamples;
+		delete [] m_sampleFilter;
+
+		m_stacks       = nullptr;
+		m_stackTable   = nullptr;
+		m_liveSamples  = nullptr;
+		m_sampleFilter = nullptr;
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	for (uint32 ii = 0; ii < stackTableSize; ++ii)
+	{
+		m_stackTable[ii] = m_INVALID_STACK;
+	}
+
+	for (uint32 ii = 0; ii < liveSampleTableSize; ++ii)
+	{
+		m_liveSamples[ii].address = nullptr;
+	}
+
+	for (uint32 ii = 0; ii < (1u << m_FILTER_SIZE_LOG2); ++ii)
+	{
+		m_sampleFilter[ii].store(0, std::memory_order_relaxed);
+	}
+
+	m_numStacks         = 0;
+	m_maxStacks         = info.maxStacks;
+	m_stackTableMask    = stackTableSize - 1;
+	m_liveSampleMask    = liveSampleTableSize - 1;
+	m_numLiveSamples    = 0;
+	m_maxLiveSamples    = info.maxLiveSamples;
+	m_samplingInterval  = info.samplingInterval;
+	m_generation        = m_nextGeneration.fetch_add(1, std::memory_order_relaxed);
+	m_numDroppedSamples = 0;
+	m_initialized       = true;
+
+	return Result(ReturnCode::kSuccess);
+}
+
+void AllocationProfiler::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	delete [] m_stacks;
+	delete [] m_stackTable;
+	delete [] m_liveSamples;
+	delete [] m_sampleFilter;
+
+	m_stacks       = nullptr;
+	m_stackTable   = nullptr;
+	m_liveSamples  = nullptr;
+	m_sampleFilter = nullptr;
+	m_numStacks    = 0;
+	m_initialized  = false;
+}
+
+bool AllocationProfiler::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void AllocationProfiler::RecordAllocation(const void *address, uint64 numBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	ThreadSampler &sampler = t_sampler;
+	if (sampler.generation != m_generation)
+	{
+		sampler.bytesUntilSample = GetNextSampleDistance(sampler, m_samplingInterval);
+		sampler.generation       = m_generation;
+	}
+
+	if (numBytes < sampler.bytesUntilSample)
+	{
+		sampler.bytesUntilSample -= numBytes;
+		return;
+	}
+
+	sampler.bytesUntilSample = GetNextSampleDistance(sampler, m_samplingInterval);
+	if (address != nullptr)
+	{
+		SampleAllocation(address, numBytes);
+	}
+}
+
+void AllocationProfiler::RecordDeallocation(const void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	// The allocation must have been sampled (and its counter incremented) before it could be handed to
+	// the thread freeing it, so a zero counter means it was never sampled.
+	if (address == nullptr || GetFilterCounter(address).load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	uint32 slot = GetLiveSampleSlot(address);
+	while (m_liveSamples[slot].address != address)
+	{
+		if (m_liveSamples[slot].address == nullptr)
+		{
+			return; // Another sampled allocation shares the filter counter.
+		}
+
+		slot = (slot + 1) & m_liveSampleMask;
+	}
+
+	LiveSample &sample = m_liveSamples[slot];
+	Stack &stack = m_stacks[sample.stackIndex];
+	stack.liveBytes -= sample.bytes;
+	stack.liveCount -= sample.count;
+
+	GetFilterCounter(address).fetch_sub(1, std::memory_order_relaxed);
+	--m_numLiveSamples;
+
+	// Shift later entries of the probe sequence back so that lookups never need tombstones.
+	uint32 hole = slot;
+	uint32 next = (slot + 1) & m_liveSampleMask;
+	while (m_liveSamples[next].address != nullptr)
+	{
+		uint32 home = GetLiveSampleSlot(m_liveSamples[next].address);
+		if (((next - home) & m_liveSampleMask) >= ((next - hole) & m_liveSampleMask))
+		{
+			m_liveSamples[hole] = m_liveSamples[next];
+			hole = next;
+		}
+
+		next = (next + 1) & m_liveSampleMask;
+	}
+
+	m_liveSamples[hole].address = nullptr;
+}
+
+void AllocationProfiler::SampleAllocation(const void *address, uint64 numBytes)
+{
+	// Capture one extra frame for this function, which is dropped from the stack.
+	void *frames[m_MAX_FRAMES + 1];
+#if defined(QI_WINDOWS)
+	uint32 numFrames = CaptureStackBackTrace(0, m_MAX_FRAMES + 1, frames, nullptr);
+#else
+	uint32 numFrames = (uint32)backtrace(frames, m_MAX_FRAMES + 1);
+#endif
+	numFrames = (numFrames > 0) ? numFrames - 1 : 0;
+
+	// An allocation of 'numBytes' is sampled with probability 1 - e^(-numBytes / interval); dividing by that
+	// probability turns the sample into an unbiased estimate.
+	double probability = 1.0 - std::exp(-(double)numBytes / (double)m_samplingInterval);
+	uint64 estimatedBytes = (probability > 0.0) ? (uint64)((double)numBytes / probability) : m_samplingInterval;
+	uint64 estimatedCount = (numBytes > 0) ? (estimatedBytes + numBytes / 2) / numBytes : 1;
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	uint32 stackIndex = FindOrAddStack(frames + 1, numFrames);
+	if (stackIndex == m_INVALID_STACK)
+	{
+		++m_numDroppedSamples;
+		return;
+	}
+
+	Stack &stack = m_stacks[stackIndex];
+	stack.allocatedBytes += estimatedBytes;
+	stack.allocatedCount += estimatedCount;
+
+	if (m_numLiveSamples >= m_maxLiveSamples)
+	{
+		// The allocation still counts towards the total, it just can not be tracked until it is freed.
+		++m_numDroppedSamples;
+		return;
+	}
+
+	stack.liveBytes += estimatedBytes;
+	stack.liveCount += estimatedCount;
+
+	uint32 slot = GetLiveSampleSlot(address);
+	while (m_liveSamples[slot].address != nullptr)
+	{
+		QI_ASSERT(m_liveSamples[slot].address != address && "Allocation sampled twice");
+		slot = (slot + 1) & m_liveSampleMask;
+	}
+
+	LiveSample &sample = m_liveSamples[slot];
+	sample.address    = address;
+	sample.stackIndex = stackIndex;
+	sample.bytes      = estimatedBytes;
+	sample.count      = estimatedCount;
+
+	GetFilterCounter(address).fetch_add(1, std::memory_order_relaxed);
+	++m_numLiveSamples;
+}
+
+uint32 AllocationProfiler::FindOrAddStack(void **frames, uint32 numFrames)
+{
+	uint64 hash = 0xcbf29ce484222325ull;
+	for (uint32 ii = 0; ii < numFrames; ++ii)
+	{
+		hash = (hash ^ reinterpret_cast<uintptr_t>(frames[ii])) * 0x100000001b3ull;
+	}
+
+	uint32 slot = (uint32)(hash >> 32) & m_stackTableMask;
+	while (m_stackTable[slot] != m_INVALID_STACK)
+	{
+		const Stack &stack = m_stacks[m_stackTable[slot]];
+		if (stack.hash == hash && stack.numFrames == numFrames)
+		{
+			bool isEqual = true;
+			for (uint32 ii = 0; ii < numFrames && isEqual; ++ii)
+			{
+				isEqual = (stack.frames[ii] == frames[ii]);
+			}
+
+			if (isEqual)
+			{
+				return m_stackTable[slot];
+			}
+		}
+
+		slot = (slot + 1) & m_stackTableMask;
+	}
+
+	if (m_numStacks == m_maxStacks)
+	{
+		return m_INVALID_STACK;
+	}
+
+	Stack &stack = m_stacks[m_numStacks];
+	stack.hash      = hash;
+	stack.numFrames = numFrames;
+	for (uint32 ii = 0; ii < numFrames; ++ii)
+	{
+		stack.frames[ii] = frames[ii];
+	}
+
+	stack.liveBytes      = 0;
+	stack.liveCount      = 0;
+	stack.allocatedBytes = 0;
+	stack.allocatedCount = 0;
+
+	m_stackTable[slot] = m_numStacks;
+	return m_numStacks++;
+}
+
+std::atomic<uint32> &AllocationProfiler::GetFilterCounter(const void *address) const
+{
+	return m_sampleFilter[HashAddress(address) >> (64 - m_FILTER_SIZE_LOG2)];
+}
+
+uint32 AllocationProfiler::GetLiveSampleSlot(const void *address) const
+{
+	// Use different bits of the hash than the filter so that addresses sharing a counter spread out.
+	return (uint32)(HashAddress(address) >> 16) & m_liveSampleMask;
+}
+
+void AllocationProfiler::WriteReport(std::string &report, AllocationProfileFormat format) const
+{
+	QI_ASSERT(m_initialized);
+
+	report.clear();
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (format == AllocationProfileFormat::kPprof)
+	{
+		uint64 liveBytes = 0, liveCount = 0, allocatedBytes = 0, allocatedCount = 0;
+		for (uint32 ii = 0; ii < m_numStacks; ++ii)
+		{
+			liveBytes      += m_stacks[ii].liveBytes;
+			liveCount      += m_stacks[ii].liveCount;
+			allocatedBytes += m_stacks[ii].allocatedBytes;
+			allocatedCount += m_stacks[ii].allocatedCount;
+		}
+
+		// The counts are already scaled, so use the unsampled 'heapprofile' variant of the format.
+		char line[128];
+		snprintf(line, sizeof(line), "heap profile: %6llu: %8llu [%6llu: %8llu] @ heapprofile\n",
+		         (unsigned long long)liveCount, (unsigned long long)liveBytes,
+		         (unsigned long long)allocatedCount, (unsigned long long)allocatedBytes);
+		report += line;
+
+		for (uint32 ii = 0; ii < m_numStacks; ++ii)
+		{
+			const Stack &stack = m_stacks[ii];
+			snprintf(line, sizeof(line), "%6llu: %8llu [%6llu: %8llu] @",
+			         (unsigned long long)stack.liveCount, (unsigned long long)stack.liveBytes,
+			         (unsigned long long)stack.allocatedCount, (unsigned long long)stack.allocatedBytes);
+			report += line;
+
+			for (uint32 jj = 0; jj < stack.numFrames; ++jj)
+			{
+				snprintf(line, sizeof(line), " 0x%llx", (unsigned long long)reinterpret_cast<uintptr_t>(stack.frames[jj]));
+				report += line;
+			}
+
+			report += '\n';
+		}
+
+	#if !defined(QI_WINDOWS)
+		// pprof needs the load addresses of the executable and its libraries to symbolize the stacks.
+		std::ifstream maps("/proc/self/maps");
+		if (maps.is_open())
+		{
+			report += "\nMAPPED_LIBRARIES:\n";
+			report.append(std::istreambuf_iterator<char>(maps), std::istreambuf_iterator<char>());
+		}
+	#endif
+	}
+	else
+	{
+		for (uint32 ii = 0; ii < m_numStacks; ++ii)
+		{
+			const Stack &stack = m_stacks[ii];
+			uint64 value = (format == AllocationProfileFormat::kFoldedLiveBytes) ? stack.liveBytes : stack.allocatedBytes;
+			if (value > 0)
+			{
+				WriteFoldedStack(report, stack, value);
+			}
+		}
+	}
+}
+
+Result AllocationProfiler::WriteReport(const char *filename, AllocationProfileFormat format) const
+{
+	QI_ASSERT(filename != nullptr);
+
+	std::string report;
+	WriteReport(report, format);
+
+	std::ofstream stream(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+	if (!stream.is_open())
+	{
+		return Result();
+	}
+
+	stream.write(report.data(), report.size());
+	return stream.good() ? Result(ReturnCode::kSuccess) : Result();
+}
+
+void AllocationProfiler::WriteFoldedStack(std::string &report, const Stack &stack, uint64 value) const
+{
+	for (uint32 ii = stack.numFrames; ii > 0; --ii)
+	{
+		AppendFrameName(report, stack.frames[ii - 1]);
+		report += (ii > 1) ? ';' : ' ';
+	}
+
+	if (stack.numFrames == 0)
+	{
+		report += "<unknown> ";
+	}
+
+	report += std::to_string((unsigned long long)value);
+	report += '\n';
+}
+
+uint64 AllocationProfiler::GetLiveBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	uint64 liveBytes = 0;
+	for (uint32 ii = 0; ii < m_numStacks; ++ii)
+	{
+		liveBytes += m_stacks[ii].liveBytes;
+	}
+
+	return liveBytes;
+}
+
+uint64 AllocationProfiler::GetAllocatedBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	uint64 allocatedBytes = 0;
+	for (uint32 ii = 0; ii < m_numStacks; ++ii)
+	{
+		allocatedBytes += m_stacks[ii].allocatedBytes;
+	}
+
+	return allocatedBytes;
+}
+
+uint32 AllocationProfiler::GetNumStacks() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_numStacks;
+}
+
+uint32 AllocationProfiler::GetNumDroppedSamples() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_numDroppedSamples;
+}
+
+} // namespace Qi
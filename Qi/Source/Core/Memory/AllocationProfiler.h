@@ -0,0 +1,232 @@
+//
+//  AllocationProfiler.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Sampling heap profiler used by the memory system to find out which code paths the memory of a
+/// title comes from. Rather than recording every allocation, each thread counts down the bytes it
+/// allocates and records the allocation which crosses zero together with its call stack. The distance
+/// between samples is drawn from an exponential distribution around the sampling interval, so every
+/// byte allocated has the same chance of being sampled and samples can be scaled back up to unbiased
+/// estimates of the real numbers. The live and total bytes of each distinct call stack are aggregated
+/// and can be written out in formats understood by flame graph tools and pprof. Unsampled allocations
+/// only cost a thread-local subtraction, and frees of unsampled memory a lookup in a small filter, so
+/// the profiler can stay on in QA builds.
+///
+
+#include "../BaseTypes.h"
+#include "../Defines.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+
+namespace Qi
+{
+
+///
+/// Formats an allocation profile can be written in.
+///
+enum class AllocationProfileFormat
+{
+	kFoldedLiveBytes,      ///< One "outer;...;inner bytes" line per call stack with its live bytes (flamegraph.pl, speedscope, etc).
+	kFoldedAllocatedBytes, ///< Same as kFoldedLiveBytes with the bytes allocated since the profiler was initialized.
+	kPprof                 ///< Legacy heap profile text with live and allocated counts, read by pprof together with the executable.
+};
+
+class AllocationProfiler
+{
+	public:
+
+		AllocationProfiler();
+		~AllocationProfiler();
+
+		///
+		/// Initialization information for the allocation profiler.
+		///
+		struct Cinfo
+		{
+			Cinfo() :
+				samplingInterval(512 * 1024),
+				maxStacks(4096),
+				maxLiveSamples(64 * 1024)
+			{
+			}
+
+			uint32 samplingInterval; ///< Average number of bytes allocated between two samples.
+			uint32 maxStacks;        ///< Maximum number of distinct call stacks which can be recorded.
+			uint32 maxLiveSamples;   ///< Maximum number of sampled allocations which can be live at the same time.
+		};
+
+		///
+		/// Initialize the profiler.
+		///
+		/// @param info Initialization information.
+		/// @return Initialization success.
+		///
+		Result Init(const Cinfo &info);
+
+		///
+		/// Deinitialize the profiler, forgetting about all samples.
+		///
+		void Deinit();
+
+		///
+		/// Check if the profiler is initialized.
+		///
+		/// @return True if initialized.
+		///
+		bool IsInitialized() const;
+
+		///
+		/// Count an allocation towards the calling thread's sampling interval, sampling it if the
+		/// interval has been used up.
+		///
+		/// @param address Address of the allocation.
+		/// @param numBytes Size of the allocation.
+		///
+		void RecordAllocation(const void *address, uint64 numBytes);
+
+		///
+		/// Remove an allocation from the live bytes of its call stack if it was sampled.
+		///
+		/// @param address Address of the allocation.
+		///
+		void RecordDeallocation(const void *address);
+
+		///
+		/// Write the current profile to a string.
+		///
+		/// @param report Receives the profile.
+		/// @param format Format to write the profile in.
+		///
+		void WriteReport(std::string &report, AllocationProfileFormat format) const;
+
+		///
+		/// Write the current profile to a file.
+		///
+		/// @param filename File to write (overwritten if it exists).
+		/// @param format Format to write the profile in.
+		/// @return Success if the file was written.
+		///
+		Result WriteReport(const char *filename, AllocationProfileFormat format) const;
+
+		///
+		/// Get the estimated number of bytes currently allocated, summed over all call stacks.
+		///
+		/// @return Estimated live bytes.
+		///
+		uint64 GetLiveBytes() const;
+
+		///
+		/// Get the estimated number of bytes allocated since the profiler was initialized, summed over all call stacks.
+		///
+		/// @return Estimated allocated bytes.
+		///
+		uint64 GetAllocatedBytes() const;
+
+		///
+		/// Get the number of distinct call stacks recorded.
+		///
+		/// @return Number of call stacks.
+		///
+		uint32 GetNumStacks() const;
+
+		///
+		/// Get the number of samples which could not be recorded because the stack or live sample table was full.
+		///
+		/// @return Number of dropped samples.
+		///
+		uint32 GetNumDroppedSamples() const;
+
+	private:
+
+		// Do not implement.
+		AllocationProfiler(const AllocationProfiler &other) = delete;
+		AllocationProfiler &operator=(const AllocationProfiler &other) = delete;
+
+		static const uint32 m_MAX_FRAMES       = 32;         ///< Deepest call stack recorded, deeper frames are cut off.
+		static const uint32 m_FILTER_SIZE_LOG2 = 15;         ///< Log2 of the number of counters in 'm_sampleFilter'.
+		static const uint32 m_INVALID_STACK    = 0xffffffff; ///< Returned by FindOrAddStack() if the stack table is full.
+
+		///
+		/// Aggregated samples of one distinct call stack.
+		///
+		struct Stack
+		{
+			uint64 hash;                ///< Hash of 'frames'.
+			void *frames[m_MAX_FRAMES]; ///< Return addresses, innermost first.
+			uint32 numFrames;           ///< Number of valid entries in 'frames'.
+			uint64 liveBytes;           ///< Estimated bytes allocated from this stack which are still live.
+			uint64 liveCount;           ///< Estimated number of live allocations.
+			uint64 allocatedBytes;      ///< Estimated bytes allocated from this stack in total.
+			uint64 allocatedCount;      ///< Estimated number of allocations in total.
+		};
+
+		///
+		/// A sampled allocation which has not been freed yet.
+		///
+		struct LiveSample
+		{
+			const void *address; ///< Address of the allocation (null for an unused slot).
+			uint32 stackIndex;   ///< Stack the allocation was sampled from.
+			uint64 bytes;        ///< Estimated bytes the sample stands for.
+			uint64 count;        ///< Estimated number of allocations the sample stands for.
+		};
+
+		///
+		/// Record a sampled allocation.
+		///
+		void SampleAllocation(const void *address, uint64 numBytes);
+
+		///
+		/// Find the stack with the given frames, adding it if it has not been seen before. 'm_lock' must be held.
+		///
+		/// @return Index into 'm_stacks' or m_INVALID_STACK if the table is full.
+		///
+		uint32 FindOrAddStack(void **frames, uint32 numFrames);
+
+		///
+		/// Get the counter in 'm_sampleFilter' an address maps to.
+		///
+		inline std::atomic<uint32> &GetFilterCounter(const void *address) const;
+
+		///
+		/// Get the slot in 'm_liveSamples' an address hashes to.
+		///
+		inline uint32 GetLiveSampleSlot(const void *address) const;
+
+		///
+		/// Write a single call stack in folded format (outermost frame first).
+		///
+		void WriteFoldedStack(std::string &report, const Stack &stack, uint64 value) const;
+
+		static std::atomic<uint32> m_nextGeneration; ///< Handed out to every Init() so threads can tell when their countdown is stale.
+
+		Stack  *m_stacks;               ///< Every distinct call stack recorded.
+		uint32 m_numStacks;             ///< Number of valid entries in 'm_stacks'.
+		uint32 m_maxStacks;             ///< Capacity of 'm_stacks'.
+		uint32 *m_stackTable;           ///< Open-addressing hash table of indices into 'm_stacks'.
+		uint32 m_stackTableMask;        ///< Number of slots in 'm_stackTable' minus one.
+
+		LiveSample *m_liveSamples;      ///< Open-addressing hash table of the sampled allocations which are still live.
+		uint32 m_liveSampleMask;        ///< Number of slots in 'm_liveSamples' minus one.
+		uint32 m_numLiveSamples;        ///< Number of used slots in 'm_liveSamples'.
+		uint32 m_maxLiveSamples;        ///< Most slots of 'm_liveSamples' which may be used (keeps probe sequences short).
+
+		std::atomic<uint32> *m_sampleFilter; ///< Number of live samples whose address maps to each counter. Lets frees of unsampled memory
+		                                     ///  skip the lock.
+
+		uint32 m_samplingInterval;      ///< Average number of bytes between samples.
+		uint32 m_generation;            ///< Generation of the current initialization.
+		uint32 m_numDroppedSamples;     ///< Samples which did not fit into one of the tables.
+		mutable std::mutex m_lock;      ///< Guards the stack and live sample tables. Only taken for samples and frees of sampled memory.
+		bool   m_initialized;           ///< If true, the profiler is initialized and ready to use.
+};
+
+} // namespace Qi
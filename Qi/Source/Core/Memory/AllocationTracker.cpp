@@ -0,0 +1,161 @@
+//
+//  AllocationTracker.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "AllocationTracker.h"
+#include <new>
+
+namespace Qi
+{
+
+AllocationTracker::AllocationTracker() :
+	m_slots(nullptr),
+	m_shardSizeLog2(0),
+	m_numDroppedRecords(0),
+	m_initialized(false)
+{
+}
+
+AllocationTracker::~AllocationTracker()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result AllocationTracker::Init(uint32 capacity)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(capacity > 0);
+
+	// Round each shard up to a power of two so that probing can wrap with a mask.
+	m_shardSizeLog2 = 0;
+	while ((m_NUM_SHARDS << m_shardSizeLog2) < capacity)
+	{
+		++m_shardSizeLog2;
+	}
+
+	uint32 numSlots = m_NUM_SHARDS << m_shardSizeLog2;
+
+	// The table is allocated straight from the operating system, tracking must not go through the memory system.
+	m_slots = new (std::nothrow) Slot[numSlots];
+	if (m_slots == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	for (uint32 ii = 0; ii < numSlots; ++ii)
+	{
+		m_slots[ii].key.store(m_EMPTY_KEY, std::memory_order_relaxed);
+	}
+
+	m_numDroppedRecords.store(0, std::memory_order_relaxed);
+	m_initialized = true;
+	return Result(ReturnCode::kSuccess);
+}
+
+void AllocationTracker::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	delete [] m_slots;
+	m_slots = nullptr;
+	m_shardSizeLog2 = 0;
+	m_initialized = false;
+}
+
+bool AllocationTracker::IsInitialized() const
+{
+	return m_initialized;
+}
+
+bool AllocationTracker::Insert(const void *address, const Record &record)
+{
+	QI_ASSERT(m_initialized);
+
+	uintptr_t key = reinterpret_cast<uintptr_t>(address);
+	QI_ASSERT(key != m_EMPTY_KEY && key != m_DELETED_KEY);
+
+	uint32 shard, slot;
+	Hash(key, shard, slot);
+
+	Slot *slots = m_slots + (shard << m_shardSizeLog2);
+	uint32 mask = (1 << m_shardSizeLog2) - 1;
+	for (uint32 probe = 0; probe <= mask; ++probe)
+	{
+		Slot &entry = slots[(slot + probe) & mask];
+
+		uintptr_t current = entry.key.load(std::memory_order_relaxed);
+		if (current == m_EMPTY_KEY || current == m_DELETED_KEY)
+		{
+			// Acquire so that the previous owner's reads of the record happen before we overwrite it.
+			if (entry.key.compare_exchange_strong(current, key, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				entry.record = record;
+				return true;
+			}
+		}
+	}
+
+	m_numDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+bool AllocationTracker::Remove(const void *address, Record &record)
+{
+	QI_ASSERT(m_initialized);
+
+	uintptr_t key = reinterpret_cast<uintptr_t>(address);
+
+	uint32 shard, slot;
+	Hash(key, shard, slot);
+
+	Slot *slots = m_slots + (shard << m_shardSizeLog2);
+	uint32 mask = (1 << m_shardSizeLog2) - 1;
+	for (uint32 probe = 0; probe <= mask; ++probe)
+	{
+		Slot &entry = slots[(slot + probe) & mask];
+
+		uintptr_t current = entry.key.load(std::memory_order_relaxed);
+		if (current == key)
+		{
+			// Only the thread freeing 'address' can remove it, so nobody else can touch this slot
+			// until it is released. Release so that the read of the record completes first.
+			record = entry.record;
+			entry.key.store(m_DELETED_KEY, std::memory_order_release);
+			return true;
+		}
+		else if (current == m_EMPTY_KEY)
+		{
+			// Nothing has ever been stored past this point in the probe sequence.
+			break;
+		}
+	}
+
+	return false;
+}
+
+uint32 AllocationTracker::GetNumRecords() const
+{
+	uint32 count = 0;
+	ForEach([&count](const void *, const Record &) { ++count; });
+	return count;
+}
+
+uint32 AllocationTracker::GetNumDroppedRecords() const
+{
+	return m_numDroppedRecords.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::Hash(uintptr_t key, uint32 &shard, uint32 &slot) const
+{
+	// Fibonacci hashing. The low bits of an address are mostly alignment, so use the
+	// top bits of the product: the highest ones pick the shard, the next ones the slot.
+	uint64 hash = static_cast<uint64>(key) * 0x9E3779B97F4A7C15ull;
+	shard = static_cast<uint32>(hash >> (64 - m_NUM_SHARDS_LOG2));
+	slot  = (m_shardSizeLog2 > 0) ? static_cast<uint32>((hash << m_NUM_SHARDS_LOG2) >> (64 - m_shardSizeLog2)) : 0;
+}
+
+} // namespace Qi
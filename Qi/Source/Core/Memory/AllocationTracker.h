@@ -0,0 +1,158 @@
+//
+//  AllocationTracker.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Thread-safe table of live allocations used by the memory system to detect leaks.
+/// Records are stored in a fixed number of open-addressing hash tables (shards) which are
+/// sized once during initialization, so tracking an allocation never allocates memory itself.
+/// Slots are claimed and released with atomic compare-and-swap operations on the address key,
+/// so no locks are taken. Filenames are stored as pointers to the __FILE__ string literal of the
+/// allocation site, which lives for the duration of the program.
+///
+
+#include "MemoryCategory.h"
+#include "../BaseTypes.h"
+#include "../Defines.h"
+#include <atomic>
+
+namespace Qi
+{
+
+class AllocationTracker
+{
+	public:
+
+		AllocationTracker();
+		~AllocationTracker();
+
+		///
+		/// Information stored for each tracked allocation.
+		///
+		struct Record
+		{
+			const char *filename;    ///< Filename that allocated this memory. Must have static storage (i.e. __FILE__).
+			uint64 numBytes;         ///< Number of bytes allocated.
+			int lineNumber;          ///< Line number this allocation came from.
+			MemoryCategory category; ///< Category the allocation was made from.
+			bool isArray;            ///< If true, the allocation is an array type.
+		};
+
+		///
+		/// Initialize the tracker.
+		///
+		/// @param capacity Maximum number of allocations which can be tracked at once.
+		/// @return Initialization success.
+		///
+		Result Init(uint32 capacity);
+
+		///
+		/// Deinitialize the tracker, forgetting about all records.
+		///
+		void Deinit();
+
+		///
+		/// Check if the tracker is initialized.
+		///
+		/// @return True if initialized.
+		///
+		bool IsInitialized() const;
+
+		///
+		/// Start tracking an allocation.
+		///
+		/// @param address Address of the allocation. Must not already be tracked.
+		/// @param record Information to store for the allocation.
+		/// @return True if the allocation is tracked, false if the shard it belongs to is full
+		///         (the allocation is counted as dropped, see GetNumDroppedRecords()).
+		///
+		bool Insert(const void *address, const Record &record);
+
+		///
+		/// Stop tracking an allocation.
+		///
+		/// @param address Address of the allocation.
+		/// @param record Filled in with the information stored for the allocation.
+		/// @return True if the allocation was being tracked.
+		///
+		bool Remove(const void *address, Record &record);
+
+		///
+		/// Get the number of allocations currently tracked. NOTE: This scans the entire
+		/// table and is not synchronized with concurrent inserts/removes.
+		///
+		/// @return Number of tracked allocations.
+		///
+		uint32 GetNumRecords() const;
+
+		///
+		/// Get the number of allocations which could not be tracked because the table was full.
+		///
+		/// @return Number of dropped records.
+		///
+		uint32 GetNumDroppedRecords() const;
+
+		///
+		/// Call a function for every tracked allocation. NOTE: This must not be called while
+		/// other threads are inserting/removing records.
+		///
+		/// @param func Function called as func(const void *address, const Record &record).
+		///
+		template<class Func>
+		void ForEach(Func func) const;
+
+	private:
+
+		// Do not implement.
+		AllocationTracker(const AllocationTracker &other) = delete;
+		AllocationTracker &operator=(const AllocationTracker &other) = delete;
+
+		///
+		/// Table entry. A slot is owned by whichever thread successfully swaps its key
+		/// from empty/deleted to an address.
+		///
+		struct Slot
+		{
+			std::atomic<uintptr_t> key; ///< Address of the tracked allocation, m_EMPTY_KEY or m_DELETED_KEY.
+			Record record;              ///< Information about the allocation (valid while 'key' is an address).
+		};
+
+		///
+		/// Get the slot index within a shard and the shard an address hashes to.
+		///
+		inline void Hash(uintptr_t key, uint32 &shard, uint32 &slot) const;
+
+		static const uintptr_t m_EMPTY_KEY   = 0; ///< Key of a slot which has never been used.
+		static const uintptr_t m_DELETED_KEY = 1; ///< Key of a slot whose allocation has been removed.
+		static const uint32 m_NUM_SHARDS_LOG2 = 6;
+		static const uint32 m_NUM_SHARDS      = 1 << m_NUM_SHARDS_LOG2; ///< Number of independent tables.
+
+		Slot   *m_slots;                       ///< Slots of all shards, stored shard by shard.
+		uint32 m_shardSizeLog2;                ///< Log2 of the number of slots per shard.
+		std::atomic<uint32> m_numDroppedRecords; ///< Number of inserts that failed because their shard was full.
+		bool   m_initialized;                  ///< If true, the tracker is initialized and ready to use.
+};
+
+template<class Func>
+void AllocationTracker::ForEach(Func func) const
+{
+	QI_ASSERT(m_initialized);
+
+	uint32 numSlots = m_NUM_SHARDS << m_shardSizeLog2;
+	for (uint32 ii = 0; ii < numSlots; ++ii)
+	{
+		uintptr_t key = m_slots[ii].key.load(std::memory_order_acquire);
+		if (key != m_EMPTY_KEY && key != m_DELETED_KEY)
+		{
+			func(reinterpret_cast<const void *>(key), m_slots[ii].record);
+		}
+	}
+}
+
+} // namespace Qi
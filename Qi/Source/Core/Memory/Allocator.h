@@ -10,14 +10,50 @@
 
 ///
 /// Base class to use for defining different kinds of memory allocators to the memory system.
-/// Only one memory allocator can be in use at any one time.
+/// Several allocators can be installed at the same time, one per MemoryCategory.
 ///
 
 #include "../BaseTypes.h"
+#include <cstring>
 
 namespace Qi
 {
 
+///
+/// Usage statistics reported by an allocator. Allocators which do not track
+/// a particular value leave it at 0.
+///
+struct AllocatorStats
+{
+	AllocatorStats() :
+		capacity(0),
+		bytesInUse(0),
+		peakBytesInUse(0),
+		freeBytes(0),
+		largestFreeBlock(0),
+		largePages(0)
+	{
+	}
+
+	///
+	/// Get how fragmented the free memory of the allocator is. A value of 0 means all free memory
+	/// is one contiguous block, values approaching 1 mean the free memory is split into many small blocks.
+	///
+	/// @return Fragmentation in the range [0, 1].
+	///
+	float GetFragmentation() const
+	{
+		return (freeBytes > 0) ? 1.0f - (float)((double)largestFreeBlock / (double)freeBytes) : 0.0f;
+	}
+
+	uint64 capacity;         ///< Total number of bytes managed by the allocator.
+	uint64 bytesInUse;       ///< Number of bytes currently allocated.
+	uint64 peakBytesInUse;   ///< Largest value 'bytesInUse' has reached.
+	uint64 freeBytes;        ///< Number of bytes available for allocation.
+	uint64 largestFreeBlock; ///< Size of the largest single allocation which can currently succeed.
+	uint64 largePages;       ///< Number of large (LARGE_PAGE_SIZE) pages the system actually backs the allocator's memory with.
+};
+
 class Allocator
 {
     public:
@@ -53,12 +89,23 @@ class Allocator
 		virtual bool IsInitialized() const = 0;
 
 		///
-		/// Allocate a user-defined amount of memory.
+		/// Allocate a user-defined amount of memory. The buffer is aligned to DEFAULT_ALIGNMENT.
 		///
 		/// @param numBytes Number of bytes to allocate.
 		/// @return Pointer to an allocated buffer.
 		///
-		virtual void *Allocate(uint32 numBytes) const = 0;
+		virtual void *Allocate(size_t numBytes) = 0;
+
+		///
+		/// Allocate a user-defined amount of memory with a specific alignment. Every allocator
+		/// must honor alignments up to at least MAX_ALIGNMENT. Alignments less than or equal to
+		/// DEFAULT_ALIGNMENT behave exactly like Allocate().
+		///
+		/// @param numBytes Number of bytes to allocate.
+		/// @param alignment Alignment (in bytes) of the returned buffer. Must be a power of two.
+		/// @return Pointer to an allocated buffer.
+		///
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) = 0;
 
 		///
 		/// Deallocates an allocated buffer.
@@ -66,7 +113,133 @@ class Allocator
 		/// @param address Address of the buffer to free. If
 		///        null, this function will not do anything.
 		///
-		virtual void Deallocate(void *address) const = 0;
+		virtual void Deallocate(void *address) = 0;
+
+		///
+		/// Try to resize a buffer without moving it. Shrinking always succeeds for allocators that
+		/// know the size of their buffers. Allocators which can grow a buffer into neighboring free
+		/// memory override this. By default a buffer can grow up to its usable size (see GetAllocationSize()).
+		///
+		/// @param address Buffer allocated by this allocator.
+		/// @param newNumBytes Number of bytes the buffer must be able to hold.
+		/// @return True if the buffer now holds at least 'newNumBytes' bytes. The buffer is unchanged otherwise.
+		///
+		virtual bool TryExpandInPlace(void *address, size_t newNumBytes)
+		{
+			size_t size = GetAllocationSize(address);
+			return (size != 0 && newNumBytes <= size);
+		}
+
+		///
+		/// Resize a buffer, moving it only if it cannot be resized in place. The contents of the buffer
+		/// (up to the smaller of the two sizes) are preserved. The default implementation tries
+		/// TryExpandInPlace() and falls back to allocate, copy and free, so the old and new buffer
+		/// only coexist when the buffer actually has to move.
+		///
+		/// @param address Buffer allocated by this allocator. If null, this behaves like AllocateAligned().
+		/// @param oldNumBytes Number of bytes currently used in the buffer.
+		/// @param newNumBytes Number of bytes the buffer must be able to hold.
+		/// @param alignment Alignment (in bytes) the buffer was allocated with. Must be a power of two.
+		/// @return The resized buffer or null if out of memory (in which case 'address' is still valid).
+		///
+		virtual void *Reallocate(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment = DEFAULT_ALIGNMENT)
+		{
+			if (address == nullptr)
+			{
+				return AllocateAligned(newNumBytes, alignment);
+			}
+
+			if (TryExpandInPlace(address, newNumBytes))
+			{
+				return address;
+			}
+
+			void *newAddress = AllocateAligned(newNumBytes, alignment);
+			if (newAddress != nullptr)
+			{
+				std::memcpy(newAddress, address, (oldNumBytes < newNumBytes) ? oldNumBytes : newNumBytes);
+				Deallocate(address);
+			}
+
+			return newAddress;
+		}
+
+		///
+		/// Allocate several buffers of the same size at once. Allocators which need to lock
+		/// should override this to only take their lock once for the entire batch.
+		///
+		/// @param numBytes Number of bytes to allocate for each buffer.
+		/// @param blocks Array of at least 'count' entries which receives the allocated buffers.
+		/// @param count Number of buffers to allocate.
+		/// @return Number of buffers actually allocated (less than 'count' if memory ran out).
+		///
+		virtual uint32 AllocateBatch(size_t numBytes, void **blocks, uint32 count)
+		{
+			for (uint32 ii = 0; ii < count; ++ii)
+			{
+				blocks[ii] = Allocate(numBytes);
+				if (blocks[ii] == nullptr)
+				{
+					return ii;
+				}
+			}
+
+			return count;
+		}
+
+		///
+		/// Deallocate several buffers at once. Allocators which need to lock should override
+		/// this to only take their lock once for the entire batch.
+		///
+		/// @param blocks Buffers to free.
+		/// @param count Number of entries in 'blocks'.
+		///
+		virtual void DeallocateBatch(void **blocks, uint32 count)
+		{
+			for (uint32 ii = 0; ii < count; ++ii)
+			{
+				Deallocate(blocks[ii]);
+			}
+		}
+
+		///
+		/// Get the usable size of a buffer allocated by this allocator. This is at least the number
+		/// of bytes that were requested. Allocators which cannot determine the size of a buffer
+		/// return 0, which also excludes them from the memory system's thread caches.
+		///
+		/// @param address Address of an allocated buffer.
+		/// @return Usable size of the buffer in bytes or 0 if unknown.
+		///
+		virtual size_t GetAllocationSize(const void * /*address*/) const
+		{
+			return 0;
+		}
+
+		///
+		/// Check if a buffer was allocated by this allocator. Allocators which serve memory out of
+		/// a fixed buffer implement this so that the memory system can route frees back to them.
+		///
+		/// @param address Address to check.
+		/// @return True if 'address' lies within memory managed by this allocator.
+		///
+		virtual bool Owns(const void * /*address*/) const
+		{
+			return false;
+		}
+
+		///
+		/// Get the current usage statistics of this allocator. Allocators which do not track
+		/// their usage do not need to override this.
+		///
+		/// @param stats Filled in with the current statistics.
+		///
+		virtual void GetStats(AllocatorStats &stats) const
+		{
+			stats = AllocatorStats();
+		}
+
+		static const uint32 DEFAULT_ALIGNMENT = 16; ///< Alignment of every buffer returned by Allocate() (matches the SSE alignment requirement).
+		static const uint32 MAX_ALIGNMENT     = 64; ///< Largest alignment every allocator is required to honor (one cache line).
 };
 
 } // namespace Qi
@@ -11,10 +11,11 @@
 ///
 /// Implement a heap allocator for the memory system. This allocator will simply
 /// call off to the operating system's default memory allocator. It is not recommended
-/// to use this allocator for anything outside of development/debugging.
+/// to use this allocator for anything outside of development/debugging (see PoolAllocator).
 ///
 
 #include "Allocator.h"
+#include "SystemMemory.h"
 #include "../Defines.h"
 
 namespace Qi
@@ -55,24 +56,47 @@ class HeapAllocator : public Allocator
 			return m_initialized;
 		}
 
-		void *Allocate(uint32 numBytes) const override
+		virtual void *Allocate(size_t numBytes) override
 		{
 			QI_ASSERT(m_initialized);
 
-			void *memory = ::operator new(numBytes);
+			void *memory = SystemAllocateSized(numBytes, DEFAULT_ALIGNMENT);
 			return memory;
 		}
 
-		virtual void Deallocate(void *address) const override
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override
+		{
+			QI_ASSERT(m_initialized);
+
+			void *memory = SystemAllocateSized(numBytes, (alignment > DEFAULT_ALIGNMENT) ? alignment : DEFAULT_ALIGNMENT);
+			return memory;
+		}
+
+		virtual void *Reallocate(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment) override
+		{
+			QI_ASSERT(m_initialized);
+
+			(void)oldNumBytes;
+			void *memory = SystemReallocateSized(address, newNumBytes, (alignment > DEFAULT_ALIGNMENT) ? alignment : DEFAULT_ALIGNMENT);
+			return memory;
+		}
+
+		virtual void Deallocate(void *address) override
 		{
 			QI_ASSERT(m_initialized);
 
 			if (address != nullptr)
 			{
-				::operator delete(address);
+				SystemFreeSized(address);
 				address = nullptr;
 			}
 		}
+
+		virtual size_t GetAllocationSize(const void *address) const override
+		{
+			// Every buffer remembers its size in a small header so that the memory system can account for it.
+			return (address != nullptr) ? GetSystemAllocationSize(address) : 0;
+		}
 		////////////////////////////////////////////////////////////////////////////////
 
 	private:
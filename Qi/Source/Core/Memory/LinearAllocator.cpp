@@ -0,0 +1,189 @@
+//
+//  LinearAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "LinearAllocator.h"
+#include <new>
+
+namespace Qi
+{
+
+LinearAllocator::LinearAllocator() :
+	m_buffer(nullptr),
+	m_capacity(0),
+	m_offset(0),
+	m_peakOffset(0),
+	m_lastAllocation(nullptr),
+	m_ownsBuffer(false),
+	m_initialized(false)
+{
+}
+
+LinearAllocator::~LinearAllocator()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result LinearAllocator::Init(const Allocator::Cinfo *info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info != nullptr);
+
+	const Cinfo *cinfo = static_cast<const Cinfo *>(info);
+	QI_ASSERT(cinfo->capacity > 0);
+
+	if (cinfo->buffer != nullptr)
+	{
+		m_buffer     = static_cast<char *>(cinfo->buffer);
+		m_ownsBuffer = false;
+	}
+	else
+	{
+		m_buffer = static_cast<char *>(::operator new(cinfo->capacity, std::nothrow));
+		if (m_buffer == nullptr)
+		{
+			return Result(ReturnCode::kOutOfMemory);
+		}
+
+		m_ownsBuffer = true;
+	}
+
+	m_capacity    = cinfo->capacity;
+	m_offset         = 0;
+	m_peakOffset     = 0;
+	m_lastAllocation = nullptr;
+	m_initialized    = true;
+
+	return Result(ReturnCode::kSuccess);
+}
+
+void LinearAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	if (m_ownsBuffer)
+	{
+		::operator delete(m_buffer);
+	}
+
+	m_buffer         = nullptr;
+	m_capacity       = 0;
+	m_offset         = 0;
+	m_lastAllocation = nullptr;
+	m_ownsBuffer     = false;
+	m_initialized    = false;
+}
+
+bool LinearAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void *LinearAllocator::Allocate(size_t numBytes)
+{
+	return AllocateAligned(numBytes, DEFAULT_ALIGNMENT);
+}
+
+void *LinearAllocator::AllocateAligned(size_t numBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT((alignment & (alignment - 1)) == 0);
+
+	if (alignment < DEFAULT_ALIGNMENT)
+	{
+		alignment = DEFAULT_ALIGNMENT;
+	}
+
+	// Align the actual address rather than the offset since an externally provided
+	// buffer may not start on an aligned boundary.
+	uintptr_t current = reinterpret_cast<uintptr_t>(m_buffer) + m_offset;
+	uintptr_t aligned = (current + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+
+	size_t alignedOffset = aligned - reinterpret_cast<uintptr_t>(m_buffer);
+	if (alignedOffset > m_capacity || numBytes > m_capacity - alignedOffset)
+	{
+		// Out of space. The allocator must be reset before any more memory can be handed out.
+		return nullptr;
+	}
+
+	m_offset = alignedOffset + numBytes;
+	if (m_offset > m_peakOffset)
+	{
+		m_peakOffset = m_offset;
+	}
+
+	m_lastAllocation = reinterpret_cast<char *>(aligned);
+	return m_lastAllocation;
+}
+
+void LinearAllocator::Deallocate(void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	// Individual allocations are never freed, all memory is reclaimed with a call to Reset().
+	QI_ASSERT(address == nullptr || Owns(address));
+	(void)address;
+}
+
+bool LinearAllocator::TryExpandInPlace(void *address, size_t newNumBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	// Only the most recent allocation borders the free part of the buffer.
+	if (address == nullptr || address != m_lastAllocation)
+	{
+		return false;
+	}
+
+	size_t lastOffset = m_lastAllocation - m_buffer;
+	if (newNumBytes > m_capacity - lastOffset)
+	{
+		return false;
+	}
+
+	m_offset = lastOffset + newNumBytes;
+	if (m_offset > m_peakOffset)
+	{
+		m_peakOffset = m_offset;
+	}
+
+	return true;
+}
+
+bool LinearAllocator::Owns(const void *address) const
+{
+	const char *block = static_cast<const char *>(address);
+	return (block >= m_buffer && block < m_buffer + m_capacity);
+}
+
+void LinearAllocator::GetStats(AllocatorStats &stats) const
+{
+	stats.capacity         = m_capacity;
+	stats.bytesInUse       = m_offset;
+	stats.peakBytesInUse   = m_peakOffset;
+	stats.freeBytes        = m_capacity - m_offset;
+	stats.largestFreeBlock = m_capacity - m_offset;
+}
+
+void LinearAllocator::Reset()
+{
+	QI_ASSERT(m_initialized);
+	m_offset         = 0;
+	m_lastAllocation = nullptr;
+}
+
+size_t LinearAllocator::GetUsedBytes() const
+{
+	return m_offset;
+}
+
+size_t LinearAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
+
+} // namespace Qi
@@ -0,0 +1,97 @@
+//
+//  LinearAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Implement a linear (bump-pointer) allocator. Memory is handed out from a single
+/// contiguous buffer by advancing an offset, which makes allocation extremely cheap.
+/// Individual allocations cannot be freed; instead the entire allocator is rewound
+/// at once with a call to Reset(). This is ideal for temporary data that all shares
+/// the same lifetime (such as data that only lives for a single frame). The most recent
+/// allocation can be grown in place as long as there is space left in the buffer.
+/// NOTE: This allocator is not threadsafe.
+///
+
+#include "Allocator.h"
+#include "../Defines.h"
+
+namespace Qi
+{
+
+class LinearAllocator : public Allocator
+{
+	public:
+
+		LinearAllocator();
+		virtual ~LinearAllocator() override;
+
+		///
+		/// Initialization information for the linear allocator.
+		///
+		struct Cinfo : public Allocator::Cinfo
+		{
+			Cinfo() :
+				capacity(0),
+				buffer(nullptr)
+			{
+			}
+
+			size_t capacity; ///< Total number of bytes this allocator can hand out before being reset.
+			void   *buffer;  ///< Optional buffer of at least 'capacity' bytes to allocate from. The allocator does
+			                 ///  not take ownership of this buffer. If null, the allocator will allocate its own buffer.
+		};
+
+		////////////////////// Functions from Qi::Allocator ////////////////////////////
+		virtual Result Init(const Allocator::Cinfo *info) override;
+		virtual void Deinit() override;
+		virtual bool IsInitialized() const override;
+		virtual void *Allocate(size_t numBytes) override;
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override;
+		virtual void Deallocate(void *address) override;
+		virtual bool TryExpandInPlace(void *address, size_t newNumBytes) override;
+		virtual bool Owns(const void *address) const override;
+		virtual void GetStats(AllocatorStats &stats) const override;
+		////////////////////////////////////////////////////////////////////////////////
+
+		///
+		/// Rewind the allocator back to the start of its buffer. All previous allocations
+		/// made from this allocator are invalid after this call.
+		///
+		void Reset();
+
+		///
+		/// Get the number of bytes currently handed out by this allocator (including alignment padding).
+		///
+		/// @return Used bytes.
+		///
+		size_t GetUsedBytes() const;
+
+		///
+		/// Get the total number of bytes this allocator can hand out.
+		///
+		/// @return Capacity in bytes.
+		///
+		size_t GetCapacity() const;
+
+	private:
+
+		// Do not implement.
+		LinearAllocator(const LinearAllocator &other) = delete;
+		LinearAllocator &operator=(const LinearAllocator &other) = delete;
+
+		char   *m_buffer;      ///< Buffer that all allocations are made from.
+		size_t m_capacity;     ///< Size of 'm_buffer' in bytes.
+		size_t m_offset;       ///< Offset into 'm_buffer' where the next allocation will be placed.
+		size_t m_peakOffset;   ///< Largest value 'm_offset' has reached.
+		char   *m_lastAllocation; ///< Most recent allocation, the only one which can be resized in place.
+		bool   m_ownsBuffer;   ///< If true, 'm_buffer' was allocated by this object and must be freed by it.
+		bool   m_initialized;  ///< If true, this allocator is initialized and ready to use.
+};
+
+} // namespace Qi
@@ -0,0 +1,56 @@
+//
+//  MemoryCategory.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Categories that engine allocations are grouped into. Each category can be served by its own
+/// allocator (see MemorySystem::InstallAllocator()) so that a system can keep its data in a
+/// dedicated, contiguous region instead of interleaving it with everything else. Categories
+/// without a dedicated allocator share the general allocator.
+///
+
+#include "../BaseTypes.h"
+
+namespace Qi
+{
+
+enum class MemoryCategory : uint32
+{
+	kGeneral,   ///< Anything without a more specific category. Always served by the allocator passed to MemorySystem::Init().
+	kEntities,  ///< Game world entity storage.
+	kAssets,    ///< Loaded asset and level data.
+	kRendering, ///< Data owned by the rendering system.
+	kGame,      ///< Allocations made by game code.
+
+	kCount      ///< Number of categories (not a valid category).
+};
+
+static const uint32 MEMORY_CATEGORY_COUNT = static_cast<uint32>(MemoryCategory::kCount);
+
+///
+/// Get the display name of a memory category.
+///
+/// @param category Category to get the name of.
+/// @return Name of the category.
+///
+inline const char *GetMemoryCategoryName(MemoryCategory category)
+{
+	static const char *names[MEMORY_CATEGORY_COUNT] =
+	{
+		"General",
+		"Entities",
+		"Assets",
+		"Rendering",
+		"Game"
+	};
+
+	return (category < MemoryCategory::kCount) ? names[static_cast<uint32>(category)] : "<invalid>";
+}
+
+} // namespace Qi
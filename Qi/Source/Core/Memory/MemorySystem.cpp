@@ -13,10 +13,92 @@
 namespace Qi
 {
 
+namespace
+{
+	///
+	/// Scratch arena cached by each thread. The generation is compared against the
+	/// memory system's generation to detect arenas destroyed by a previous Deinit().
+	/// The arena is handed back to the memory system when the thread exits.
+	///
+	struct ThreadScratchArena
+	{
+		ThreadScratchArena() :
+			allocator(nullptr),
+			generation(0)
+		{
+		}
+
+		~ThreadScratchArena()
+		{
+			MemorySystem::GetInstance().ReleaseScratchAllocator();
+		}
+
+		LinearAllocator *allocator;
+		uint32 generation;
+	};
+
+	thread_local ThreadScratchArena t_scratchArena;
+
+	///
+	/// Allocation cache owned by each thread. Blocks still held by the cache are handed
+	/// back to the memory system when the thread exits.
+	///
+	struct ThreadCacheSlot
+	{
+		ThreadCacheSlot() :
+			generation(0)
+		{
+		}
+
+		~ThreadCacheSlot()
+		{
+			MemorySystem::GetInstance().FlushThreadCache();
+		}
+
+		ThreadCache cache;
+		uint32 generation;
+	};
+
+	thread_local ThreadCacheSlot t_threadCache;
+
+	///
+	/// Stack of allocators the calling thread's allocations are routed to (see PushScopedAllocator()).
+	///
+	struct ThreadAllocatorScopes
+	{
+		Allocator *allocators[MemorySystem::MAX_SCOPED_ALLOCATOR_DEPTH];
+		uint32 depth;
+	};
+
+	thread_local ThreadAllocatorScopes t_allocatorScopes = {};
+
+	///
+	/// Get the calling thread's cache, discarding its contents if they belong to a previous generation.
+	///
+	inline ThreadCache &GetThreadCache(uint32 generation)
+	{
+		if (t_threadCache.generation != generation)
+		{
+			t_threadCache.cache.Discard();
+			t_threadCache.generation = generation;
+		}
+
+		return t_threadCache.cache;
+	}
+}
+
 MemorySystem::MemorySystem() :
     m_initialized(false),
-	m_allocator(nullptr)
+	m_profileReportFormat(AllocationProfileFormat::kPprof),
+	m_allocator(nullptr),
+	m_scratchArenaSize(DEFAULT_SCRATCH_ARENA_SIZE),
+	m_generation(1),
+	m_threadCachesEnabled(false)
 {
+	for (uint32 ii = 0; ii < MEMORY_CATEGORY_COUNT; ++ii)
+	{
+		m_categoryAllocators[ii] = nullptr;
+	}
 }
 
 MemorySystem::~MemorySystem()
@@ -29,13 +111,77 @@ MemorySystem &MemorySystem::GetInstance()
     return allocator;
 }
     
-Result MemorySystem::Init(Allocator *allocator)
+Result MemorySystem::Init(const Cinfo &info)
 {
     QI_ASSERT(!m_initialized);
-	QI_ASSERT(allocator != nullptr);
-	QI_ASSERT(allocator->IsInitialized());
+	QI_ASSERT(info.allocator != nullptr);
+	QI_ASSERT(info.allocator->IsInitialized());
+	QI_ASSERT(info.scratchArenaSize > 0);
+
+	m_allocator = info.allocator;
+	m_scratchArenaSize = info.scratchArenaSize;
+
+	for (uint32 ii = 0; ii < MEMORY_CATEGORY_COUNT; ++ii)
+	{
+		m_categoryAllocators[ii] = m_allocator;
+
+		m_usage[ii].bytesInUse       = 0;
+		m_usage[ii].peakBytesInUse   = 0;
+		m_usage[ii].numAllocations   = 0;
+		m_usage[ii].totalAllocations = 0;
+		m_usage[ii].budget           = 0;
+		m_usage[ii].exceededBudget   = false;
+		m_usage[ii].reportedOverrun  = false;
+	}
+
+#ifdef QI_TRACK_ALLOCATIONS
+	Result result = m_tracker.Init(info.trackingCapacity);
+	if (!result.IsValid())
+	{
+		return result;
+	}
+#endif
+
+	if (info.profilerSamplingInterval > 0)
+	{
+		AllocationProfiler::Cinfo profilerInfo;
+		profilerInfo.samplingInterval = info.profilerSamplingInterval;
+
+		Result result = m_profiler.Init(profilerInfo);
+		if (!result.IsValid())
+		{
+			return result;
+		}
+	}
 
-	m_allocator = allocator;
+	if (info.relocatableRegionSize > 0)
+	{
+		RelocatableAllocator::Cinfo relocatableInfo;
+		relocatableInfo.regionSize = info.relocatableRegionSize;
+		relocatableInfo.maxHandles = info.relocatableMaxHandles;
+
+		Result result = m_relocatableAllocator.Init(relocatableInfo);
+		if (!result.IsValid())
+		{
+			return result;
+		}
+	}
+
+	m_profileReportFilename = (info.profileReportFilename != nullptr) ? info.profileReportFilename : "";
+	m_profileReportFormat   = info.profileReportFormat;
+
+	// Thread caches need to know the size of a block when it is freed, so only
+	// enable them if the allocator is able to report it.
+	m_threadCachesEnabled = false;
+	if (info.enableThreadCaches)
+	{
+		void *probe = m_allocator->Allocate(1);
+		if (probe != nullptr)
+		{
+			m_threadCachesEnabled = (m_allocator->GetAllocationSize(probe) != 0);
+			m_allocator->Deallocate(probe);
+		}
+	}
 
     m_initialized = true;
     return Result(ReturnCode::kSuccess);
@@ -45,34 +191,543 @@ void MemorySystem::Deinit()
 {
     QI_ASSERT(m_initialized);
     
-#ifdef QI_DEBUG
-    if (!m_records.empty())
+	// Destroy all scratch arenas first, their buffers are tracked like any other allocation.
+	{
+		std::lock_guard<std::mutex> lock(m_scratchAllocatorLock);
+		for (size_t ii = 0; ii < m_scratchAllocators.size(); ++ii)
+		{
+			m_scratchAllocators[ii]->Deinit();
+			delete m_scratchAllocators[ii];
+			DeallocateBytes(m_scratchBuffers[ii], MemoryCategory::kGeneral, true);
+		}
+
+		m_scratchAllocators.clear();
+		m_scratchBuffers.clear();
+		m_freeScratchAllocators.clear();
+	}
+
+#ifdef QI_TRACK_ALLOCATIONS
+    if (m_tracker.GetNumRecords() > 0)
     {
         Qi_LogWarning("Memory leaks detected:");
-        for (auto iter = m_records.begin(); iter != m_records.end(); ++iter)
+        m_tracker.ForEach([](const void *, const AllocationTracker::Record &record)
         {
-            Qi_LogWarning("\tLeak: %s(%d) - %u bytes", iter->second.filename.c_str(),
-                                                       iter->second.lineNumber,
-                                                       iter->second.numBytes);
-        }
+            Qi_LogWarning("\tLeak: %s(%d) - %llu bytes (%s)", (record.filename != nullptr) ? record.filename : "<unknown>",
+                                                              record.lineNumber,
+                                                              (unsigned long long)record.numBytes,
+                                                              GetMemoryCategoryName(record.category));
+        });
     }
 
-    m_records.clear();
+    if (m_tracker.GetNumDroppedRecords() > 0)
+    {
+        Qi_LogWarning("%u allocations were not tracked, increase the tracking capacity", m_tracker.GetNumDroppedRecords());
+    }
+
+    m_tracker.Deinit();
 #endif
 
-	// Make sure the allocator is cleaned up as well.
-	m_allocator->Deinit();
-	delete m_allocator;
+	if (m_profiler.IsInitialized())
+	{
+		if (!m_profileReportFilename.empty())
+		{
+			if (m_profiler.WriteReport(m_profileReportFilename.c_str(), m_profileReportFormat).IsValid())
+			{
+				Qi_LogInfo("Allocation profile written to %s", m_profileReportFilename.c_str());
+			}
+			else
+			{
+				Qi_LogWarning("Unable to write the allocation profile to %s", m_profileReportFilename.c_str());
+			}
+		}
+
+		if (m_profiler.GetNumDroppedSamples() > 0)
+		{
+			Qi_LogWarning("%u allocation samples were dropped by the profiler", m_profiler.GetNumDroppedSamples());
+		}
+
+		m_profiler.Deinit();
+	}
+
+	if (m_relocatableAllocator.IsInitialized())
+	{
+		if (m_relocatableAllocator.GetNumAllocations() > 0)
+		{
+			Qi_LogWarning("%u relocatable blocks were never freed", m_relocatableAllocator.GetNumAllocations());
+		}
+
+		m_relocatableAllocator.Deinit();
+	}
+
+	// Return the blocks cached by this thread and the ones waiting to be reused. Caches of other threads are
+	// discarded (they must have finished allocating by now, their blocks die with the allocator).
+	FlushThreadCache();
+	ThreadCache::FlushRemoteFrees(m_allocator, m_remoteFrees);
+
+	// Scratch arenas and thread caches still held by other threads are stale from now on.
+	{
+		std::lock_guard<std::mutex> lock(m_scratchAllocatorLock);
+		m_freeScratchAllocators.clear();
+		++m_generation;
+	}
+
+	// Report how much of each allocator was actually used so that regions can be sized appropriately,
+	// then clean up the allocators as well. Allocators may serve several categories, only destroy them once.
+	for (uint32 ii = MEMORY_CATEGORY_COUNT; ii > 0; --ii)
+	{
+		Allocator *allocator = m_categoryAllocators[ii - 1];
+		bool isLastReference = true;
+		for (uint32 jj = 0; jj < ii - 1; ++jj)
+		{
+			isLastReference &= (m_categoryAllocators[jj] != allocator);
+		}
+
+		if (isLastReference)
+		{
+			AllocatorStats stats;
+			allocator->GetStats(stats);
+			if (stats.capacity > 0)
+			{
+				Qi_LogInfo("Memory allocator (%s) peak usage: %llu of %llu bytes (%.2f%% fragmented at shutdown, %llu large pages)",
+				           GetMemoryCategoryName((MemoryCategory)(ii - 1)),
+				           (unsigned long long)stats.peakBytesInUse,
+				           (unsigned long long)stats.capacity,
+				           stats.GetFragmentation() * 100.0f,
+				           (unsigned long long)stats.largePages);
+			}
+
+			allocator->Deinit();
+			delete allocator;
+		}
+
+		m_categoryAllocators[ii - 1] = nullptr;
+	}
+
 	m_allocator = nullptr;
 
+	m_threadCachesEnabled = false;
     m_initialized = false;
 }
 
-Allocator *MemorySystem::GetAllocator() const
+void MemorySystem::InstallAllocator(MemoryCategory category, Allocator *allocator)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT(category != MemoryCategory::kGeneral && category < MemoryCategory::kCount);
+	QI_ASSERT(allocator != nullptr && allocator->IsInitialized());
+	QI_ASSERT(m_categoryAllocators[(uint32)category] == m_allocator && "Category already has a dedicated allocator");
+
+	m_categoryAllocators[(uint32)category] = allocator;
+}
+
+Allocator *MemorySystem::GetAllocator(MemoryCategory category) const
+{
+	QI_ASSERT(m_initialized);
+	return m_categoryAllocators[(uint32)category];
+}
+
+void MemorySystem::GetAllocatorStats(AllocatorStats &stats, MemoryCategory category) const
+{
+	QI_ASSERT(m_initialized);
+	m_categoryAllocators[(uint32)category]->GetStats(stats);
+}
+
+void MemorySystem::GetMemoryUsage(MemoryUsage &usage, MemoryCategory category) const
+{
+	QI_ASSERT(category < MemoryCategory::kCount);
+
+	const CategoryUsage &categoryUsage = m_usage[(uint32)category];
+	usage.bytesInUse       = categoryUsage.bytesInUse.load(std::memory_order_relaxed);
+	usage.peakBytesInUse   = categoryUsage.peakBytesInUse.load(std::memory_order_relaxed);
+	usage.numAllocations   = categoryUsage.numAllocations.load(std::memory_order_relaxed);
+	usage.totalAllocations = categoryUsage.totalAllocations.load(std::memory_order_relaxed);
+	usage.budget           = categoryUsage.budget.load(std::memory_order_relaxed);
+}
+
+void MemorySystem::SetMemoryBudget(MemoryCategory category, uint64 numBytes)
+{
+	QI_ASSERT(category < MemoryCategory::kCount);
+	m_usage[(uint32)category].budget = numBytes;
+}
+
+void MemorySystem::CheckMemoryBudgets()
+{
+	for (uint32 ii = 0; ii < MEMORY_CATEGORY_COUNT; ++ii)
+	{
+		CategoryUsage &usage = m_usage[ii];
+		uint64 budget     = usage.budget.load(std::memory_order_relaxed);
+		uint64 bytesInUse = usage.bytesInUse.load(std::memory_order_relaxed);
+
+		// Allocations since the last check may have gone over the budget and back below it again.
+		bool exceededBudget = usage.exceededBudget.exchange(false, std::memory_order_relaxed) || (budget != 0 && bytesInUse > budget);
+		if (exceededBudget && !usage.reportedOverrun)
+		{
+			Qi_LogWarning("Memory budget of %s exceeded: %llu bytes in use (peak %llu) of a %llu byte budget",
+			              GetMemoryCategoryName((MemoryCategory)ii),
+			              (unsigned long long)bytesInUse,
+			              (unsigned long long)usage.peakBytesInUse.load(std::memory_order_relaxed),
+			              (unsigned long long)budget);
+			usage.reportedOverrun = true;
+		}
+		else if (usage.reportedOverrun && (budget == 0 || bytesInUse <= budget))
+		{
+			usage.reportedOverrun = false;
+		}
+	}
+}
+
+RelocatableAllocator *MemorySystem::GetRelocatableAllocator()
+{
+	return m_relocatableAllocator.IsInitialized() ? &m_relocatableAllocator : nullptr;
+}
+
+void MemorySystem::DefragmentRelocatableMemory(uint32 budgetMicroseconds)
+{
+	if (m_relocatableAllocator.IsInitialized())
+	{
+		m_relocatableAllocator.Defragment(budgetMicroseconds);
+	}
+}
+
+bool MemorySystem::IsAllocationProfilerEnabled() const
+{
+	return m_profiler.IsInitialized();
+}
+
+const AllocationProfiler &MemorySystem::GetAllocationProfiler() const
+{
+	QI_ASSERT(m_profiler.IsInitialized());
+	return m_profiler;
+}
+
+Result MemorySystem::WriteAllocationProfile(const char *filename, AllocationProfileFormat format) const
 {
 	QI_ASSERT(m_initialized);
-	return m_allocator;
+
+	if (!m_profiler.IsInitialized())
+	{
+		return Result();
+	}
+
+	return m_profiler.WriteReport(filename, format);
+}
+
+LinearAllocator *MemorySystem::GetScratchAllocator()
+{
+	QI_ASSERT(m_initialized);
+
+	if (t_scratchArena.allocator == nullptr || t_scratchArena.generation != m_generation)
+	{
+		std::lock_guard<std::mutex> lock(m_scratchAllocatorLock);
+
+		LinearAllocator *scratch = nullptr;
+		if (!m_freeScratchAllocators.empty())
+		{
+			// Arenas are not reset when they change hands, the previous thread's allocations live until the end of the frame.
+			scratch = m_freeScratchAllocators.back();
+			m_freeScratchAllocators.pop_back();
+		}
+		else
+		{
+			// The arena's buffer is accounted for like any other engine allocation. It never comes
+			// from the calling thread's scoped allocator though, the arena outlives any scope.
+			LinearAllocator::Cinfo cinfo;
+			cinfo.capacity = m_scratchArenaSize;
+			cinfo.buffer   = AllocateUnscopedBytes(m_scratchArenaSize, Allocator::DEFAULT_ALIGNMENT, MemoryCategory::kGeneral, true, __FILE__, __LINE__);
+			if (cinfo.buffer == nullptr)
+			{
+				Qi_LogWarning("Unable to allocate a %llu byte scratch arena", (unsigned long long)m_scratchArenaSize);
+				return nullptr;
+			}
+
+			scratch = new LinearAllocator;
+			if (!scratch->Init(&cinfo).IsValid())
+			{
+				Qi_LogWarning("Unable to initialize a %llu byte scratch arena", (unsigned long long)m_scratchArenaSize);
+				delete scratch;
+				DeallocateBytes(cinfo.buffer, MemoryCategory::kGeneral, true);
+				return nullptr;
+			}
+
+			m_scratchAllocators.push_back(scratch);
+			m_scratchBuffers.push_back(cinfo.buffer);
+		}
+
+		t_scratchArena.allocator  = scratch;
+		t_scratchArena.generation = m_generation;
+	}
+
+	return t_scratchArena.allocator;
+}
+
+void MemorySystem::ReleaseScratchAllocator()
+{
+	if (t_scratchArena.allocator == nullptr)
+	{
+		return;
+	}
+
+	// Deinit() bumps the generation under the same lock, arenas of a previous generation are already gone.
+	std::lock_guard<std::mutex> lock(m_scratchAllocatorLock);
+	if (t_scratchArena.generation == m_generation)
+	{
+		m_freeScratchAllocators.push_back(t_scratchArena.allocator);
+	}
+
+	t_scratchArena.allocator = nullptr;
+}
+
+void MemorySystem::ResetScratchAllocators()
+{
+	QI_ASSERT(m_initialized);
+
+	std::lock_guard<std::mutex> lock(m_scratchAllocatorLock);
+	for (LinearAllocator *scratch : m_scratchAllocators)
+	{
+		scratch->Reset();
+	}
+}
+
+void MemorySystem::FlushThreadCache()
+{
+	if (t_threadCache.generation == m_generation)
+	{
+		if (m_initialized)
+		{
+			t_threadCache.cache.Flush(m_allocator);
+		}
+	}
+	else
+	{
+		// The cache was filled from an allocator which no longer exists.
+		t_threadCache.cache.Discard();
+	}
+}
+
+void MemorySystem::TrimRemoteFrees()
+{
+	QI_ASSERT(m_initialized);
+
+	if (m_threadCachesEnabled)
+	{
+		ThreadCache::TrimRemoteFrees(m_allocator, m_remoteFrees);
+	}
+}
+
+void MemorySystem::TrackAllocation(void *address, uint64 numBytes, MemoryCategory category, bool isArray, const char *filename, int lineNumber)
+{
+	if (address != nullptr)
+	{
+		AllocationTracker::Record record;
+		record.filename   = filename;
+		record.numBytes   = numBytes;
+		record.lineNumber = lineNumber;
+		record.category   = category;
+		record.isArray    = isArray;
+		m_tracker.Insert(address, record);
+	}
+}
+
+void MemorySystem::UntrackAllocation(void *address, MemoryCategory category, bool isArray)
+{
+	AllocationTracker::Record record;
+	if (m_tracker.Remove(address, record))
+	{
+		QI_ASSERT(record.isArray == isArray);
+		QI_ASSERT(record.category == category && "Memory freed from a different category than it was allocated from");
+		(void)category;
+		(void)isArray;
+		return;
+	}
+
+	// Freeing memory that was never allocated is only legal if the tracker ran out of room.
+	QI_ASSERT(m_tracker.GetNumDroppedRecords() > 0);
+}
+
+void MemorySystem::AddUsage(MemoryCategory category, uint64 numBytes)
+{
+	CategoryUsage &usage = m_usage[(uint32)category];
+	usage.numAllocations.fetch_add(1, std::memory_order_relaxed);
+	usage.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	uint64 bytesInUse = usage.bytesInUse.fetch_add(numBytes, std::memory_order_relaxed) + numBytes;
+	uint64 peak = usage.peakBytesInUse.load(std::memory_order_relaxed);
+	while (bytesInUse > peak && !usage.peakBytesInUse.compare_exchange_weak(peak, bytesInUse, std::memory_order_relaxed))
+	{
+	}
+
+	uint64 budget = usage.budget.load(std::memory_order_relaxed);
+	if (budget != 0 && bytesInUse > budget)
+	{
+		// Logging here could recurse back into the memory system, leave it to CheckMemoryBudgets().
+		usage.exceededBudget.store(true, std::memory_order_relaxed);
+	}
+}
+
+void MemorySystem::RemoveUsage(MemoryCategory category, uint64 numBytes)
+{
+	CategoryUsage &usage = m_usage[(uint32)category];
+	usage.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+	usage.bytesInUse.fetch_sub(numBytes, std::memory_order_relaxed);
+}
+
+void MemorySystem::PushScopedAllocator(Allocator *allocator)
+{
+	QI_ASSERT(allocator != nullptr && allocator->IsInitialized());
+	QI_ASSERT(t_allocatorScopes.depth < MAX_SCOPED_ALLOCATOR_DEPTH);
+
+	t_allocatorScopes.allocators[t_allocatorScopes.depth++] = allocator;
+}
+
+void MemorySystem::PopScopedAllocator()
+{
+	QI_ASSERT(t_allocatorScopes.depth > 0);
+	--t_allocatorScopes.depth;
+}
+
+Allocator *MemorySystem::GetScopedAllocator() const
+{
+	return (t_allocatorScopes.depth > 0) ? t_allocatorScopes.allocators[t_allocatorScopes.depth - 1] : nullptr;
+}
+
+bool MemorySystem::AreThreadCachesEnabled() const
+{
+	return m_threadCachesEnabled;
+}
+
+void *MemorySystem::AllocateBytes(size_t numBytes, uint32 alignment, MemoryCategory category, bool isArray, const char *filename, int lineNumber)
+{
+	Allocator *scopedAllocator = GetScopedAllocator();
+	if (scopedAllocator != nullptr)
+	{
+		return scopedAllocator->AllocateAligned(numBytes, alignment);
+	}
+
+	return AllocateUnscopedBytes(numBytes, alignment, category, isArray, filename, lineNumber);
+}
+
+void *MemorySystem::AllocateUnscopedBytes(size_t numBytes, uint32 alignment, MemoryCategory category, bool isArray, const char *filename, int lineNumber)
+{
+	Allocator *allocator = m_categoryAllocators[(uint32)category];
+
+	void *result = nullptr;
+	if (alignment > Allocator::DEFAULT_ALIGNMENT)
+	{
+		// Cached blocks are only guaranteed to have the default alignment.
+		result = allocator->AllocateAligned(numBytes, alignment);
+	}
+	else if (m_threadCachesEnabled && allocator == m_allocator && numBytes <= ThreadCache::MAX_CACHED_SIZE)
+	{
+		// Thread caches only hold blocks of the general allocator.
+		result = GetThreadCache(m_generation).Allocate(m_allocator, numBytes, m_remoteFrees);
+	}
+	else
+	{
+		result = allocator->Allocate(numBytes);
+	}
+
+	if (result != nullptr)
+	{
+		AddUsage(category, allocator->GetAllocationSize(result));
+	}
+
+#ifdef QI_TRACK_ALLOCATIONS
+	TrackAllocation(result, numBytes, category, isArray, filename, lineNumber);
+#else
+	(void)isArray;
+	(void)filename;
+	(void)lineNumber;
+#endif
+
+	if (m_profiler.IsInitialized())
+	{
+		m_profiler.RecordAllocation(result, numBytes);
+	}
+
+	return result;
+}
+
+void *MemorySystem::ReallocateBytes(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment, MemoryCategory category,
+									 const char *filename, int lineNumber)
+{
+	if (address == nullptr)
+	{
+		return AllocateBytes(newNumBytes, alignment, category, true, filename, lineNumber);
+	}
+
+	// Memory handed out by a scoped allocator stays in it.
+	for (uint32 ii = t_allocatorScopes.depth; ii > 0; --ii)
+	{
+		Allocator *scopedAllocator = t_allocatorScopes.allocators[ii - 1];
+		if (scopedAllocator->Owns(address))
+		{
+			return scopedAllocator->Reallocate(address, oldNumBytes, newNumBytes, alignment);
+		}
+	}
+
+	// Blocks which came out of a thread cache belong to the allocator as well, resizing them
+	// simply bypasses the cache.
+	Allocator *allocator = m_categoryAllocators[(uint32)category];
+	uint64 oldAccountedBytes = allocator->GetAllocationSize(address);
+
+	void *result = allocator->Reallocate(address, oldNumBytes, newNumBytes, alignment);
+	if (result != nullptr)
+	{
+	#ifdef QI_TRACK_ALLOCATIONS
+		UntrackAllocation(address, category, true);
+		TrackAllocation(result, newNumBytes, category, true, filename, lineNumber);
+	#endif
+
+		RemoveUsage(category, oldAccountedBytes);
+		AddUsage(category, allocator->GetAllocationSize(result));
+
+		// The resized block is profiled like a new allocation.
+		if (m_profiler.IsInitialized())
+		{
+			m_profiler.RecordDeallocation(address);
+			m_profiler.RecordAllocation(result, newNumBytes);
+		}
+	}
+
+	return result;
+}
+
+void MemorySystem::DeallocateBytes(void *address, MemoryCategory category, bool isArray)
+{
+	// Memory handed out by a scoped allocator goes back to it.
+	for (uint32 ii = t_allocatorScopes.depth; ii > 0; --ii)
+	{
+		Allocator *scopedAllocator = t_allocatorScopes.allocators[ii - 1];
+		if (scopedAllocator->Owns(address))
+		{
+			scopedAllocator->Deallocate(address);
+			return;
+		}
+	}
+
+	Allocator *allocator = m_categoryAllocators[(uint32)category];
+	size_t blockSize = allocator->GetAllocationSize(address);
+
+#ifdef QI_TRACK_ALLOCATIONS
+	UntrackAllocation(address, category, isArray);
+#else
+	(void)isArray;
+#endif
+
+	RemoveUsage(category, blockSize);
+
+	if (m_profiler.IsInitialized())
+	{
+		m_profiler.RecordDeallocation(address);
+	}
+
+	if (m_threadCachesEnabled && allocator == m_allocator &&
+		blockSize >= ThreadCache::MIN_CACHED_SIZE && blockSize <= ThreadCache::MAX_CACHED_SIZE)
+	{
+		GetThreadCache(m_generation).Deallocate(m_allocator, address, blockSize, m_remoteFrees);
+		return;
+	}
+
+	allocator->Deallocate(address);
 }
     
 } // namespace Qi
-
@@ -14,21 +14,63 @@
 /// and keep track of how much memory has been allocated
 /// (to detect memory leaks). This class is implemented
 /// as a singleton.
+/// Several allocators can be installed at once: the general allocator passed to Init() plus
+/// one dedicated allocator per MemoryCategory (see InstallAllocator()).
 ///
 
 #include "Allocator.h"
+#include "AllocationProfiler.h"
+#include "AllocationTracker.h"
+#include "LinearAllocator.h"
+#include "MemoryCategory.h"
+#include "RelocatableAllocator.h"
+#include "ThreadCache.h"
 #include "../BaseTypes.h"
+#include "../Defines.h"
+#include <atomic>
+#include <mutex>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
-#define Qi_AllocateMemory(type) Qi::MemorySystem::GetInstance().Allocate<type>(__FILE__, __LINE__)
-#define Qi_AllocateMemoryArray(type, count) Qi::MemorySystem::GetInstance().AllocateArray<type>(count, __FILE__, __LINE__)
+#define Qi_AllocateMemory(type) Qi::MemorySystem::GetInstance().Allocate<type>(Qi::MemoryCategory::kGeneral, __FILE__, __LINE__)
+#define Qi_AllocateMemoryArray(type, count) Qi::MemorySystem::GetInstance().AllocateArray<type>(count, Qi::MemoryCategory::kGeneral, __FILE__, __LINE__)
 #define Qi_FreeMemory(address) Qi::MemorySystem::GetInstance().Free(address)
 #define Qi_FreeMemoryArray(address) Qi::MemorySystem::GetInstance().FreeArray(address)
+#define Qi_AllocateMemoryFrom(type, category) Qi::MemorySystem::GetInstance().Allocate<type>(category, __FILE__, __LINE__)
+#define Qi_AllocateMemoryArrayFrom(type, count, category) Qi::MemorySystem::GetInstance().AllocateArray<type>(count, category, __FILE__, __LINE__)
+#define Qi_FreeMemoryFrom(address, category) Qi::MemorySystem::GetInstance().Free(address, category)
+#define Qi_FreeMemoryArrayFrom(address, category) Qi::MemorySystem::GetInstance().FreeArray(address, category)
+#define Qi_ReallocateMemoryArrayFrom(address, oldCount, newCount, category) Qi::MemorySystem::GetInstance().ReallocateArray(address, oldCount, newCount, category, __FILE__, __LINE__)
+#define Qi_AllocateUninitializedArrayFrom(type, count, category) Qi::MemorySystem::GetInstance().AllocateUninitializedArray<type>(count, category, __FILE__, __LINE__)
+#define Qi_ReallocateUninitializedArrayFrom(address, oldCount, newCount, category) Qi::MemorySystem::GetInstance().ReallocateUninitializedArray(address, oldCount, newCount, category, __FILE__, __LINE__)
+#define Qi_AllocateScratchMemoryArray(type, count) Qi::MemorySystem::GetInstance().AllocateScratchArray<type>(count)
 
 namespace Qi
 {
 
+///
+/// Live usage of a memory category as seen by the memory system. Sizes are the usable sizes reported
+/// by the category's allocator (see Allocator::GetAllocationSize()), in every build configuration.
+/// Allocations routed to a scoped allocator are not counted.
+///
+struct MemoryUsage
+{
+	MemoryUsage() :
+		bytesInUse(0),
+		peakBytesInUse(0),
+		numAllocations(0),
+		totalAllocations(0),
+		budget(0)
+	{
+	}
+
+	uint64 bytesInUse;       ///< Number of bytes currently allocated from the category.
+	uint64 peakBytesInUse;   ///< Largest value 'bytesInUse' has reached.
+	uint64 numAllocations;   ///< Number of live allocations.
+	uint64 totalAllocations; ///< Number of allocations made from the category since the memory system was initialized.
+	uint64 budget;           ///< Number of bytes the category is expected to stay below (0 if it has no budget).
+};
+
 class MemorySystem
 {
     public:
@@ -40,14 +82,46 @@ class MemorySystem
         ///
 		static MemorySystem &GetInstance();
     
+		///
+		/// Initialization information for the memory system.
+		///
+		struct Cinfo
+		{
+			Cinfo() :
+				allocator(nullptr),
+				scratchArenaSize(DEFAULT_SCRATCH_ARENA_SIZE),
+				enableThreadCaches(true),
+				trackingCapacity(DEFAULT_TRACKING_CAPACITY),
+				profilerSamplingInterval(0),
+				profileReportFilename(nullptr),
+				profileReportFormat(AllocationProfileFormat::kPprof),
+				relocatableRegionSize(0),
+				relocatableMaxHandles(64 * 1024)
+			{
+			}
+
+			Allocator *allocator;    ///< General allocator to install and use in this memory system. It serves every category
+			                         ///  without a dedicated allocator. After initialization, the memory system owns the Allocator instance.
+			size_t scratchArenaSize; ///< Size (in bytes) of each per-thread scratch arena.
+			bool enableThreadCaches; ///< If true, small allocations are served from per-thread caches which refill from/flush to
+			                         ///  the allocator in batches. Ignored if the allocator cannot report the size of its blocks.
+			uint32 trackingCapacity; ///< Maximum number of live allocations tracked for leak detection (only used when
+			                         ///  QI_TRACK_ALLOCATIONS is defined).
+			uint32 profilerSamplingInterval;  ///< Average number of bytes allocated between two samples of the allocation profiler
+			                                  ///  (0 disables the profiler). See AllocationProfiler.
+			const char *profileReportFilename; ///< If set, the allocation profile is written to this file in Deinit().
+			AllocationProfileFormat profileReportFormat; ///< Format of the profile written in Deinit().
+			size_t relocatableRegionSize; ///< Size (in bytes) of the region of the relocatable allocator (0 disables it).
+			uint32 relocatableMaxHandles; ///< Maximum number of live blocks in the relocatable allocator.
+		};
+
         ///
         /// Initialize the memory system for use.
         ///
-		/// @param allocator Allocator to install and use in this memory system. After
-		///                  this call, the memory system owns the Allocator instance.
+		/// @param info Initialization information.
         /// @return Initialization success.
         ///
-        Result Init(Allocator *allocator);
+        Result Init(const Cinfo &info);
     
         ///
         /// Deinitialize the memory system. Any still-allocated
@@ -56,49 +130,274 @@ class MemorySystem
         void Deinit();
     
         ///
-        /// Allocate an instance for a specific type.
+        /// Allocate an instance for a specific type. The instance is aligned to alignof(T).
         ///
+        /// @param category Category whose allocator serves the allocation.
         /// @param filename Filename that this allocation came from.
         /// @param lineNumber Line number where this allocation took place.
         /// @return Pointer to an allocated buffer.
         ///
         template<class T>
-        T *Allocate(const char *filename = nullptr, int lineNumber = 0);
+        T *Allocate(MemoryCategory category = MemoryCategory::kGeneral, const char *filename = nullptr, int lineNumber = 0);
 
 		///
-		/// Allocate an array of type T.
+		/// Allocate an array of type T. The array is aligned to alignof(T).
 		///
 		/// @param arraySize Number of elements to allocate with the array.
+		/// @param category Category whose allocator serves the allocation.
 		/// @param filename Filename that this allocation came from.
 		/// @param lineNumber Line number where this allocation took place. 
+		/// @return Pointer to the allocated array or null if out of memory or if the size of the array
+		///         in bytes does not fit into a size_t.
 		///
 		template<class T>
-		T *AllocateArray(uint32 arraySize, const char *filename = nullptr, int lineNumber = 0);
+		T *AllocateArray(size_t arraySize, MemoryCategory category = MemoryCategory::kGeneral, const char *filename = nullptr, int lineNumber = 0);
+
+		///
+		/// Resize an array allocated with AllocateArray(). The array is grown in place if its allocator
+		/// can do so, otherwise the elements are moved (bitwise) into a new buffer and the old one is freed.
+		/// Elements past 'oldArraySize' are default constructed. T must be safe to relocate with memcpy.
+		///
+		/// @param address Array to resize. If null, a new array is allocated.
+		/// @param oldArraySize Number of elements currently in the array.
+		/// @param newArraySize Number of elements the array must be able to hold.
+		/// @param category Category the array was allocated from.
+		/// @param filename Filename that this allocation came from.
+		/// @param lineNumber Line number where this allocation took place.
+		/// @return The resized array or null if out of memory or the new size in bytes does not fit into a size_t
+		///         (in which case 'address' is still valid).
+		///
+		template<class T>
+		T *ReallocateArray(T *address, size_t oldArraySize, size_t newArraySize, MemoryCategory category = MemoryCategory::kGeneral,
+						   const char *filename = nullptr, int lineNumber = 0);
     
+		///
+		/// Allocate storage for an array of type T without constructing any elements, for containers which
+		/// construct and destroy their elements themselves. Free the storage with FreeArray().
+		///
+		/// @param arraySize Number of elements the storage must be able to hold.
+		/// @param category Category whose allocator serves the allocation.
+		/// @param filename Filename that this allocation came from.
+		/// @param lineNumber Line number where this allocation took place.
+		/// @return Pointer to the storage or null if out of memory or if the size in bytes does not fit into a size_t.
+		///
+		template<class T>
+		T *AllocateUninitializedArray(size_t arraySize, MemoryCategory category = MemoryCategory::kGeneral, const char *filename = nullptr,
+									  int lineNumber = 0);
+
+		///
+		/// Resize storage allocated with AllocateUninitializedArray() like ReallocateArray(), without constructing
+		/// the elements past 'oldArraySize'. T must be safe to relocate with memcpy.
+		///
+		/// @param address Storage to resize. If null, new storage is allocated.
+		/// @param oldArraySize Number of elements the storage currently holds (only these are preserved).
+		/// @param newArraySize Number of elements the storage must be able to hold.
+		/// @param category Category the storage was allocated from.
+		/// @param filename Filename that this allocation came from.
+		/// @param lineNumber Line number where this allocation took place.
+		/// @return The resized storage or null if out of memory or the new size in bytes does not fit into a size_t
+		///         (in which case 'address' is still valid).
+		///
+		template<class T>
+		T *ReallocateUninitializedArray(T *address, size_t oldArraySize, size_t newArraySize, MemoryCategory category = MemoryCategory::kGeneral,
+										const char *filename = nullptr, int lineNumber = 0);
+
         ///
         /// Frees an allocated type.
         ///
         /// @param address Address of the buffer to free. If
         ///        null, this function will not do anything.
+        /// @param category Category the buffer was allocated from.
         ///
         template<class T>
-        void Free(T *address);
+        void Free(T *address, MemoryCategory category = MemoryCategory::kGeneral);
 
 		///
 		/// Frees an allocated array buffer.
 		///
 		/// @param address Address of the buffer to free. If
 		///        null, this function will not do anything.
+		/// @param category Category the buffer was allocated from.
 		///
 		template<class T>
-		void FreeArray(T *address);
+		void FreeArray(T *address, MemoryCategory category = MemoryCategory::kGeneral);
 
 		///
-		/// Get the allocator currently installed into the memory system.
+		/// Install a dedicated allocator for a category. Until this is called a category shares the
+		/// general allocator. This must be called before anything is allocated from the category and
+		/// before other threads start allocating from it. The same allocator may be installed for
+		/// several categories. The memory system owns the allocator and destroys it in Deinit().
 		///
+		/// @param category Category to serve with the allocator (must not be MemoryCategory::kGeneral).
+		/// @param allocator Initialized allocator.
+		///
+		void InstallAllocator(MemoryCategory category, Allocator *allocator);
+
+		///
+		/// Get the allocator serving a category.
+		///
+		/// @param category Category to get the allocator of.
 		/// @return Allocator instance.
 		///
-		Allocator *GetAllocator() const;
+		Allocator *GetAllocator(MemoryCategory category = MemoryCategory::kGeneral) const;
+
+		///
+		/// Get the usage statistics (capacity, peak usage, fragmentation, etc.) of the allocator
+		/// serving a category. Use this to size allocator regions per title.
+		///
+		/// @param stats Filled in with the current statistics.
+		/// @param category Category whose allocator to query.
+		///
+		void GetAllocatorStats(AllocatorStats &stats, MemoryCategory category = MemoryCategory::kGeneral) const;
+
+		///
+		/// Get the live usage of a category. The counters are updated atomically on every allocation, so this
+		/// is cheap enough to read every frame (i.e. to graph which system is growing).
+		///
+		/// @param usage Filled in with the current usage.
+		/// @param category Category to query.
+		///
+		void GetMemoryUsage(MemoryUsage &usage, MemoryCategory category) const;
+
+		///
+		/// Set the number of bytes a category is expected to stay below. Going over the budget
+		/// is reported by CheckMemoryBudgets().
+		///
+		/// @param category Category to set the budget of.
+		/// @param numBytes Budget in bytes (0 removes the budget).
+		///
+		void SetMemoryBudget(MemoryCategory category, uint64 numBytes);
+
+		///
+		/// Log a warning for every category which went over its budget since the last call. A category is only
+		/// reported again after it has dropped back below its budget. The engine calls this once per frame.
+		///
+		void CheckMemoryBudgets();
+
+		///
+		/// Get the relocatable allocator, used for long-lived data which is referenced through handles
+		/// so the allocator can compact it (see RelocatableAllocator).
+		///
+		/// @return Relocatable allocator or nullptr if it was not enabled in Init().
+		///
+		RelocatableAllocator *GetRelocatableAllocator();
+
+		///
+		/// Run one incremental compaction step of the relocatable allocator. The engine calls this
+		/// once per frame, after which addresses obtained from relocatable handles are stale.
+		///
+		/// @param budgetMicroseconds Time the step may take.
+		///
+		void DefragmentRelocatableMemory(uint32 budgetMicroseconds);
+
+		///
+		/// Check if the allocation profiler is sampling allocations.
+		///
+		/// @return True if the profiler is enabled.
+		///
+		bool IsAllocationProfilerEnabled() const;
+
+		///
+		/// Get the allocation profiler, i.e. to query its totals or write its report to a string.
+		/// Only valid if IsAllocationProfilerEnabled().
+		///
+		/// @return Allocation profiler.
+		///
+		const AllocationProfiler &GetAllocationProfiler() const;
+
+		///
+		/// Write the call stacks allocations were sampled from so far to a file.
+		///
+		/// @param filename File to write.
+		/// @param format Format to write the profile in.
+		/// @return Success if the profile was written.
+		///
+		Result WriteAllocationProfile(const char *filename, AllocationProfileFormat format) const;
+
+		///
+		/// Allocate an array of type T from the calling thread's scratch arena. Scratch memory
+		/// is never freed explicitly, it is reclaimed all at once by ResetScratchAllocators()
+		/// (which the engine calls at the end of every frame). Because of this, T must be
+		/// trivially destructible. The array is aligned to alignof(T).
+		///
+		/// @param arraySize Number of elements to allocate with the array.
+		/// @return Pointer to the allocated array or null if the scratch arena is exhausted (or could not be created).
+		///
+		template<class T>
+		T *AllocateScratchArray(size_t arraySize);
+
+		///
+		/// Get the scratch arena owned by the calling thread. The arena is taken from the arenas released
+		/// by threads which exited, or created the first time a thread requests it if there are none.
+		///
+		/// @return Scratch arena for the calling thread or null if its buffer could not be allocated.
+		///
+		LinearAllocator *GetScratchAllocator();
+
+		///
+		/// Give the calling thread's scratch arena back for other threads to reuse. Memory allocated from the
+		/// arena stays valid until the next ResetScratchAllocators(). This is called automatically when a
+		/// thread exits.
+		///
+		void ReleaseScratchAllocator();
+
+		///
+		/// Reset the scratch arenas of all threads. Any memory allocated from a scratch arena
+		/// is invalid after this call. NOTE: This must only be called when no other thread is
+		/// using its scratch arena (i.e. between frames).
+		///
+		void ResetScratchAllocators();
+
+		///
+		/// Return all blocks held by the calling thread's allocation cache to the allocator. This
+		/// is called automatically when a thread exits; call it manually to release memory held
+		/// by a thread which will not allocate again for a long time.
+		///
+		void FlushThreadCache();
+
+		///
+		/// Return the blocks thread caches freed for each other to the allocator for every size class
+		/// which piled up more of them than any thread allocated again. Thread caches never return
+		/// those blocks themselves so that freeing never takes the allocator's locks. The engine
+		/// calls this once per frame.
+		///
+		void TrimRemoteFrees();
+
+		///
+		/// Check if small allocations are being served from per-thread caches.
+		///
+		/// @return True if thread caches are in use.
+		///
+		bool AreThreadCachesEnabled() const;
+
+		///
+		/// Route every allocation the calling thread makes through the memory system to 'allocator' instead
+		/// of the installed allocator, until the matching PopScopedAllocator(). Scopes nest; the most recently
+		/// pushed allocator is used. Frees of memory owned by (see Allocator::Owns()) any allocator on the
+		/// calling thread's scope stack go back to that allocator, so memory allocated within a scope must be
+		/// freed or reclaimed in bulk (i.e. with StackAllocator::FreeToMarker()) before the scope is popped.
+		/// Scoped allocations bypass the thread caches and are not tracked for leaks. Prefer AllocatorScope
+		/// over calling this directly.
+		///
+		/// @param allocator Initialized allocator to route allocations to. The caller keeps ownership.
+		///
+		void PushScopedAllocator(Allocator *allocator);
+
+		///
+		/// Stop routing allocations to the allocator pushed last by the calling thread.
+		///
+		void PopScopedAllocator();
+
+		///
+		/// Get the allocator the calling thread's allocations are currently routed to.
+		///
+		/// @return Innermost scoped allocator or null if no scope is active.
+		///
+		Allocator *GetScopedAllocator() const;
+
+		static const uint32 DEFAULT_SCRATCH_ARENA_SIZE = 1024 * 1024; ///< Default size (in bytes) of each per-thread scratch arena.
+		static const uint32 DEFAULT_TRACKING_CAPACITY  = 256 * 1024;  ///< Default number of live allocations which can be tracked.
+		static const uint32 MAX_SCOPED_ALLOCATOR_DEPTH = 8;           ///< Maximum number of nested allocator scopes per thread.
     
     private:
     
@@ -109,25 +408,113 @@ class MemorySystem
 		MemorySystem();
 		~MemorySystem();
 
+		///
+		/// Compute the size in bytes of an array of T.
+		///
+		/// @param arraySize Number of elements in the array.
+		/// @param numBytes Receives the size of the array in bytes.
+		/// @return False if the size does not fit into a size_t.
+		///
+		template<class T>
+		static inline bool GetArrayByteSize(size_t arraySize, size_t &numBytes);
+
+		///
+		/// Allocate/free raw memory from the calling thread's scoped allocator or the installed allocator,
+		/// going through the calling thread's cache when possible (over-aligned allocations always bypass
+		/// the cache). Allocations from the installed allocator are recorded in the allocation tracker.
+		///
+		void *AllocateBytes(size_t numBytes, uint32 alignment, MemoryCategory category, bool isArray, const char *filename, int lineNumber);
+		void DeallocateBytes(void *address, MemoryCategory category, bool isArray);
+
+		///
+		/// Allocate raw memory like AllocateBytes(), ignoring the calling thread's scoped allocators. Used for
+		/// memory the memory system keeps for itself.
+		///
+		void *AllocateUnscopedBytes(size_t numBytes, uint32 alignment, MemoryCategory category, bool isArray, const char *filename, int lineNumber);
+
+		///
+		/// Resize raw memory allocated with AllocateBytes(), keeping it in the allocator it came from.
+		///
+		void *ReallocateBytes(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment, MemoryCategory category,
+							  const char *filename, int lineNumber);
+
         bool m_initialized; ///< If true, the memory system is initialized.
-    
-        ///
-        /// Record stored for each allocation (debug only).
-        ///
-        struct MemoryRecord
-        {
-            unsigned long long numBytes; ///< Number of bytes allocated.
-            
-			std::string filename; ///< Filename that allocated this memory.
-            int lineNumber;       ///< Line number this allocation came from.
-			bool isArray;         ///< If true, the allocation is an array type.
-        };
-    
-        typedef std::unordered_map<void *, MemoryRecord> Record;
-        Record m_records; ///< All current allocations in the system (debug only). Stored by address.
 
-		Allocator *m_allocator; ///< Memory allocator installed into this memory system. All memory allocations/
-		                        ///< deallocations will go through this allocator.
+		///
+		/// Record/release an allocation in the allocation tracker (QI_TRACK_ALLOCATIONS only).
+		///
+		void TrackAllocation(void *address, uint64 numBytes, MemoryCategory category, bool isArray, const char *filename, int lineNumber);
+		void UntrackAllocation(void *address, MemoryCategory category, bool isArray);
+
+		///
+		/// Add/remove an allocation to/from the usage counters of its category.
+		///
+		void AddUsage(MemoryCategory category, uint64 numBytes);
+		void RemoveUsage(MemoryCategory category, uint64 numBytes);
+
+		///
+		/// Usage counters of a single category. Each category lives on its own cache line so that
+		/// threads allocating from different categories do not contend.
+		///
+		struct QI_ALIGN(64) CategoryUsage
+		{
+			std::atomic<uint64> bytesInUse;       ///< See MemoryUsage.
+			std::atomic<uint64> peakBytesInUse;   ///< See MemoryUsage.
+			std::atomic<uint64> numAllocations;   ///< See MemoryUsage.
+			std::atomic<uint64> totalAllocations; ///< See MemoryUsage.
+			std::atomic<uint64> budget;           ///< See MemoryUsage.
+			std::atomic<bool>   exceededBudget;   ///< Set when an allocation pushes the category over its budget.
+			bool                reportedOverrun;  ///< If true, the current overrun was already logged (CheckMemoryBudgets() only).
+		};
+
+		CategoryUsage m_usage[MEMORY_CATEGORY_COUNT]; ///< Live usage of every category.
+
+		AllocationTracker m_tracker; ///< All current allocations in the system (QI_TRACK_ALLOCATIONS only).
+
+		AllocationProfiler m_profiler;               ///< Samples the call stacks memory is allocated from (only initialized if enabled).
+		std::string m_profileReportFilename;         ///< File the allocation profile is written to in Deinit() (empty for none).
+		AllocationProfileFormat m_profileReportFormat; ///< Format of the profile written in Deinit().
+
+		RelocatableAllocator m_relocatableAllocator; ///< Compacting allocator for handle-based data (only initialized if enabled).
+
+		Allocator *m_allocator; ///< General memory allocator installed into this memory system. All memory allocations/
+		                        ///< deallocations without a dedicated category allocator will go through this allocator.
+		Allocator *m_categoryAllocators[MEMORY_CATEGORY_COUNT]; ///< Allocator serving each category ('m_allocator' if the category has no dedicated one).
+
+		std::vector<LinearAllocator *> m_scratchAllocators; ///< Every scratch arena created, whether a thread owns it or not.
+		std::vector<void *> m_scratchBuffers;              ///< Buffers backing each entry of 'm_scratchAllocators'.
+		std::vector<LinearAllocator *> m_freeScratchAllocators; ///< Arenas released by threads which exited, handed to the next thread asking for one.
+		std::mutex m_scratchAllocatorLock;                 ///< Lock guarding the scratch arena lists.
+		size_t m_scratchArenaSize;                         ///< Size (in bytes) of each scratch arena.
+		uint32 m_generation;                               ///< Incremented on every Deinit() so threads know when their scratch arena/thread cache is stale.
+		bool m_threadCachesEnabled;                        ///< If true, small allocations go through per-thread caches.
+		RemoteFreeList m_remoteFrees[ThreadCache::NUM_SIZE_CLASSES]; ///< Blocks flushed by the thread caches, waiting to be reused by
+		                                                              ///  any thread before going back to the allocator.
+};
+
+///
+/// Routes the calling thread's allocations to an allocator for the lifetime of this object
+/// (see MemorySystem::PushScopedAllocator()).
+///
+class AllocatorScope
+{
+	public:
+
+		explicit AllocatorScope(Allocator *allocator)
+		{
+			MemorySystem::GetInstance().PushScopedAllocator(allocator);
+		}
+
+		~AllocatorScope()
+		{
+			MemorySystem::GetInstance().PopScopedAllocator();
+		}
+
+	private:
+
+		// Do not implement.
+		AllocatorScope(const AllocatorScope &other) = delete;
+		AllocatorScope &operator=(const AllocatorScope &other) = delete;
 };
 
 } // namespace Qi
@@ -10,92 +10,155 @@
 
 #include "../Defines.h"
 #include <cstdlib>
+#include <limits>
+#include <type_traits>
 
 namespace Qi
 {
 
 template<class T>
-T *MemorySystem::Allocate(const char *filename, int lineNumber)
+T *MemorySystem::Allocate(MemoryCategory category, const char *filename, int lineNumber)
 {
     QI_ASSERT(m_initialized);
  
-	T *result = (T *)m_allocator->Allocate(sizeof(T));
-
-	new (result) T;
-
-#ifdef QI_DEBUG
-    MemoryRecord record;
-    record.filename = std::string(filename);
-    record.lineNumber = lineNumber;
-	record.numBytes = sizeof(T);
-	record.isArray = false;
-    m_records[static_cast<void *>(result)] = record;
-#endif
+	T *result = (T *)AllocateBytes(sizeof(T), alignof(T), category, false, filename, lineNumber);
+	if (result != nullptr)
+	{
+		new (result) T;
+	}
     
     return result;
 }
 
 template<class T>
-T *MemorySystem::AllocateArray(uint32 arraySize, const char *filename, int lineNumber)
+T *MemorySystem::AllocateArray(size_t arraySize, MemoryCategory category, const char *filename, int lineNumber)
 {
 	QI_ASSERT(m_initialized);
 
-	T *result = (T *)m_allocator->Allocate(sizeof(T) * arraySize);
+	size_t numBytes;
+	if (!GetArrayByteSize<T>(arraySize, numBytes))
+	{
+		return nullptr;
+	}
+
+	T *result = (T *)AllocateBytes(numBytes, alignof(T), category, true, filename, lineNumber);
+	if (result != nullptr)
+	{
+		new (result) T[arraySize];
+	}
 
-	new (result) T[arraySize];
+	return result;
+}
 
-#ifdef QI_DEBUG
-	MemoryRecord record;
-	record.filename = std::string(filename);
-	record.lineNumber = lineNumber;
-	record.numBytes = sizeof(T);
-	record.isArray = true;
-	m_records[static_cast<void *>(result)] = record;
-#endif
+template<class T>
+T *MemorySystem::ReallocateArray(T *address, size_t oldArraySize, size_t newArraySize, MemoryCategory category, const char *filename, int lineNumber)
+{
+	T *result = ReallocateUninitializedArray(address, oldArraySize, newArraySize, category, filename, lineNumber);
+	if (result != nullptr)
+	{
+		for (size_t ii = oldArraySize; ii < newArraySize; ++ii)
+		{
+			new (&result[ii]) T;
+		}
+	}
 
 	return result;
+}
 
-	return nullptr;
+template<class T>
+T *MemorySystem::AllocateUninitializedArray(size_t arraySize, MemoryCategory category, const char *filename, int lineNumber)
+{
+	QI_ASSERT(m_initialized);
+
+	size_t numBytes;
+	if (!GetArrayByteSize<T>(arraySize, numBytes))
+	{
+		return nullptr;
+	}
+
+	return (T *)AllocateBytes(numBytes, alignof(T), category, true, filename, lineNumber);
 }
 
 template<class T>
-void MemorySystem::Free(T *address)
+T *MemorySystem::ReallocateUninitializedArray(T *address, size_t oldArraySize, size_t newArraySize, MemoryCategory category,
+											  const char *filename, int lineNumber)
+{
+	QI_ASSERT(m_initialized);
+
+	size_t newNumBytes;
+	if (!GetArrayByteSize<T>(newArraySize, newNumBytes))
+	{
+		return nullptr;
+	}
+
+	return (T *)ReallocateBytes(address, sizeof(T) * oldArraySize, newNumBytes, alignof(T), category, filename, lineNumber);
+}
+
+template<class T>
+void MemorySystem::Free(T *address, MemoryCategory category)
 {
     QI_ASSERT(m_initialized);
     
     if (address != nullptr)
     {
-
-	#ifdef QI_DEBUG
-		auto iter = m_records.find(static_cast<void *>(address));
-        QI_ASSERT(iter != m_records.end());
-		QI_ASSERT(iter->second.isArray == false);
-		m_records.erase(iter);
-	#endif
-
-		m_allocator->Deallocate(address);
+		DeallocateBytes(address, category, false);
         address = nullptr;
     }
 }
 
 template<class T>
-void MemorySystem::FreeArray(T *address)
+void MemorySystem::FreeArray(T *address, MemoryCategory category)
 {
 	QI_ASSERT(m_initialized);
 
 	if (address != nullptr)
 	{
+		DeallocateBytes(address, category, true);
+        address = nullptr;
+	}
+}
 
-#ifdef QI_DEBUG
-		auto iter = m_records.find(static_cast<void *>(address));
-		QI_ASSERT(iter != m_records.end());
-		QI_ASSERT(iter->second.isArray == true);
-		m_records.erase(iter);
-#endif
+template<class T>
+T *MemorySystem::AllocateScratchArray(size_t arraySize)
+{
+	static_assert(std::is_trivially_destructible<T>::value, "Scratch memory is reclaimed without calling destructors");
+	QI_ASSERT(m_initialized);
 
-		m_allocator->Deallocate(address);
-        address = nullptr;
+	size_t numBytes;
+	if (!GetArrayByteSize<T>(arraySize, numBytes))
+	{
+		return nullptr;
 	}
+
+	LinearAllocator *scratch = GetScratchAllocator();
+	if (scratch == nullptr)
+	{
+		return nullptr;
+	}
+
+	T *result = (T *)scratch->AllocateAligned(numBytes, alignof(T));
+	if (result != nullptr)
+	{
+		for (size_t ii = 0; ii < arraySize; ++ii)
+		{
+			new (&result[ii]) T;
+		}
+	}
+
+	return result;
+}
+
+template<class T>
+bool MemorySystem::GetArrayByteSize(size_t arraySize, size_t &numBytes)
+{
+	// Multiplying first would silently wrap around and allocate a much smaller array.
+	if (arraySize > std::numeric_limits<size_t>::max() / sizeof(T))
+	{
+		return false;
+	}
+
+	numBytes = arraySize * sizeof(T);
+	return true;
 }
     
 } // namespace Qi
@@ -0,0 +1,423 @@
+//
+//  PoolAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "PoolAllocator.h"
+#include "SystemMemory.h"
+#include <new>
+
+namespace Qi
+{
+
+const uint32 PoolAllocator::m_SIZE_CLASS_BYTES[PoolAllocator::m_NUM_SIZE_CLASSES] =
+{
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+PoolAllocator::PoolAllocator() :
+	m_pageClasses(nullptr),
+	m_region(nullptr),
+	m_regionSize(0),
+	m_useLargePages(false),
+	m_largePageSource(LargePageSource::kNone),
+	m_pageSize(0),
+	m_numPages(0),
+	m_nextPage(0),
+	m_initialized(false)
+{
+	// Build the size -> size class lookup table. Each entry maps to the smallest class which
+	// can hold (index * granularity) bytes.
+	uint32 classIndex = 0;
+	for (uint32 ii = 0; ii <= m_MAX_POOLED_SIZE / m_SIZE_CLASS_GRANULARITY; ++ii)
+	{
+		while (m_SIZE_CLASS_BYTES[classIndex] < ii * m_SIZE_CLASS_GRANULARITY)
+		{
+			++classIndex;
+		}
+
+		m_sizeToClass[ii] = static_cast<unsigned char>(classIndex);
+	}
+
+	for (uint32 ii = 0; ii < m_NUM_SIZE_CLASSES; ++ii)
+	{
+		m_sizeClasses[ii].blockSize  = m_SIZE_CLASS_BYTES[ii];
+		m_sizeClasses[ii].freeList   = nullptr;
+		m_sizeClasses[ii].pageCursor = nullptr;
+		m_sizeClasses[ii].pageEnd    = nullptr;
+		m_sizeClasses[ii].bytesInUse = 0;
+	}
+}
+
+PoolAllocator::~PoolAllocator()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result PoolAllocator::Init(const Allocator::Cinfo *info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info != nullptr);
+
+	const Cinfo *cinfo = static_cast<const Cinfo *>(info);
+	QI_ASSERT(cinfo->pageSize >= m_MAX_POOLED_SIZE);
+	QI_ASSERT(cinfo->pageSize % MAX_ALIGNMENT == 0);
+	QI_ASSERT(cinfo->regionSize >= cinfo->pageSize);
+
+	m_pageSize   = cinfo->pageSize;
+	m_numPages   = cinfo->regionSize / m_pageSize;
+	m_regionSize = m_numPages * m_pageSize;
+
+	m_useLargePages = cinfo->useLargePages;
+	if (m_useLargePages)
+	{
+		m_region = static_cast<char *>(AllocateLargePageMemory(m_regionSize, m_largePageSource));
+	}
+	else
+	{
+		m_region = static_cast<char *>(SystemAllocate(m_regionSize, MAX_ALIGNMENT));
+	}
+
+	m_pageClasses = new (std::nothrow) unsigned char[m_numPages];
+	if (m_region == nullptr || m_pageClasses == nullptr)
+	{
+		FreeRegion();
+		delete [] m_pageClasses;
+		m_region      = nullptr;
+		m_pageClasses = nullptr;
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_nextPage    = 0;
+	m_initialized = true;
+
+	return Result(ReturnCode::kSuccess);
+}
+
+void PoolAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	for (uint32 ii = 0; ii < m_NUM_SIZE_CLASSES; ++ii)
+	{
+		m_sizeClasses[ii].freeList   = nullptr;
+		m_sizeClasses[ii].pageCursor = nullptr;
+		m_sizeClasses[ii].pageEnd    = nullptr;
+		m_sizeClasses[ii].bytesInUse = 0;
+	}
+
+	FreeRegion();
+	delete [] m_pageClasses;
+
+	m_region      = nullptr;
+	m_pageClasses = nullptr;
+	m_regionSize  = 0;
+	m_numPages    = 0;
+	m_initialized = false;
+}
+
+bool PoolAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void *PoolAllocator::Allocate(size_t numBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	if (numBytes <= m_MAX_POOLED_SIZE)
+	{
+		uint32 classIndex = GetSizeClassIndex(numBytes);
+		SizeClass &sizeClass = m_sizeClasses[classIndex];
+
+		std::lock_guard<std::mutex> lock(sizeClass.lock);
+
+		void *block = AllocateFromClass(classIndex);
+		if (block != nullptr)
+		{
+			return block;
+		}
+
+		// The region is exhausted, fall through to the system allocator.
+	}
+
+	return SystemAllocateSized(numBytes, DEFAULT_ALIGNMENT);
+}
+
+void *PoolAllocator::AllocateAligned(size_t numBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT((alignment & (alignment - 1)) == 0);
+
+	if (alignment <= DEFAULT_ALIGNMENT)
+	{
+		return Allocate(numBytes);
+	}
+
+	uint32 classIndex = GetAlignedSizeClassIndex(numBytes, alignment);
+	if (classIndex < m_NUM_SIZE_CLASSES)
+	{
+		std::lock_guard<std::mutex> lock(m_sizeClasses[classIndex].lock);
+
+		void *block = AllocateFromClass(classIndex);
+		if (block != nullptr)
+		{
+			return block;
+		}
+	}
+
+	return SystemAllocateSized(numBytes, alignment);
+}
+
+void PoolAllocator::Deallocate(void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr)
+	{
+		return;
+	}
+
+	if (!IsPooled(address))
+	{
+		SystemFreeSized(address);
+		return;
+	}
+
+	SizeClass &sizeClass = m_sizeClasses[GetPageClassIndex(address)];
+
+	std::lock_guard<std::mutex> lock(sizeClass.lock);
+	FreeToClass(sizeClass, address);
+}
+
+void *PoolAllocator::Reallocate(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+
+	// Large blocks live in system memory on both sides of the resize, let the system grow them in place.
+	if (address != nullptr && !IsPooled(address) && newNumBytes > m_MAX_POOLED_SIZE)
+	{
+		return SystemReallocateSized(address, newNumBytes, (alignment > DEFAULT_ALIGNMENT) ? alignment : DEFAULT_ALIGNMENT);
+	}
+
+	return Allocator::Reallocate(address, oldNumBytes, newNumBytes, alignment);
+}
+
+uint32 PoolAllocator::AllocateBatch(size_t numBytes, void **blocks, uint32 count)
+{
+	QI_ASSERT(m_initialized);
+
+	if (numBytes > m_MAX_POOLED_SIZE)
+	{
+		return Allocator::AllocateBatch(numBytes, blocks, count);
+	}
+
+	uint32 classIndex = GetSizeClassIndex(numBytes);
+	uint32 numAllocated = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_sizeClasses[classIndex].lock);
+		for (; numAllocated < count; ++numAllocated)
+		{
+			blocks[numAllocated] = AllocateFromClass(classIndex);
+			if (blocks[numAllocated] == nullptr)
+			{
+				break;
+			}
+		}
+	}
+
+	// Anything the region couldn't satisfy comes from the system allocator.
+	for (; numAllocated < count; ++numAllocated)
+	{
+		blocks[numAllocated] = SystemAllocateSized(numBytes, DEFAULT_ALIGNMENT);
+		if (blocks[numAllocated] == nullptr)
+		{
+			break;
+		}
+	}
+
+	return numAllocated;
+}
+
+void PoolAllocator::DeallocateBatch(void **blocks, uint32 count)
+{
+	QI_ASSERT(m_initialized);
+
+	// Batches typically contain blocks of a single size class, so keep the lock of the
+	// current class held until a block from a different class shows up.
+	std::unique_lock<std::mutex> lock;
+	SizeClass *lockedClass = nullptr;
+
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		if (blocks[ii] == nullptr)
+		{
+			continue;
+		}
+
+		if (!IsPooled(blocks[ii]))
+		{
+			SystemFreeSized(blocks[ii]);
+			continue;
+		}
+
+		SizeClass *sizeClass = &m_sizeClasses[GetPageClassIndex(blocks[ii])];
+		if (sizeClass != lockedClass)
+		{
+			lock = std::unique_lock<std::mutex>(sizeClass->lock);
+			lockedClass = sizeClass;
+		}
+
+		FreeToClass(*sizeClass, blocks[ii]);
+	}
+}
+
+size_t PoolAllocator::GetAllocationSize(const void *address) const
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr)
+	{
+		return 0;
+	}
+
+	if (!IsPooled(address))
+	{
+		return GetSystemAllocationSize(address);
+	}
+
+	return m_sizeClasses[GetPageClassIndex(address)].blockSize;
+}
+
+void PoolAllocator::GetStats(AllocatorStats &stats) const
+{
+	stats.largePages = GetLargePageCount(m_region, m_regionSize, m_largePageSource);
+
+	stats.capacity   = m_regionSize;
+	stats.bytesInUse = 0;
+	for (uint32 ii = 0; ii < m_NUM_SIZE_CLASSES; ++ii)
+	{
+		std::lock_guard<std::mutex> lock(m_sizeClasses[ii].lock);
+		stats.bytesInUse += m_sizeClasses[ii].bytesInUse;
+	}
+
+	// Pages are never returned to the region, so the number of pages handed out
+	// is the high-water mark of the region.
+	size_t usedPages = (m_nextPage < m_numPages) ? (size_t)m_nextPage : m_numPages;
+
+	stats.peakBytesInUse   = (uint64)usedPages * m_pageSize;
+	stats.freeBytes        = stats.capacity - stats.bytesInUse;
+	stats.largestFreeBlock = (uint64)(m_numPages - usedPages) * m_pageSize;
+}
+
+uint32 PoolAllocator::GetMaxPooledSize()
+{
+	return m_MAX_POOLED_SIZE;
+}
+
+uint32 PoolAllocator::GetSizeClassIndex(size_t numBytes) const
+{
+	return m_sizeToClass[(numBytes + m_SIZE_CLASS_GRANULARITY - 1) / m_SIZE_CLASS_GRANULARITY];
+}
+
+uint32 PoolAllocator::GetAlignedSizeClassIndex(size_t numBytes, uint32 alignment) const
+{
+	if (numBytes > m_MAX_POOLED_SIZE || alignment > MAX_ALIGNMENT)
+	{
+		return m_NUM_SIZE_CLASSES;
+	}
+
+	// A block is at least as large as its alignment so that consecutive blocks stay aligned.
+	uint32 classIndex = GetSizeClassIndex((numBytes > alignment) ? numBytes : alignment);
+	while (classIndex < m_NUM_SIZE_CLASSES && (m_SIZE_CLASS_BYTES[classIndex] % alignment) != 0)
+	{
+		++classIndex;
+	}
+
+	return classIndex;
+}
+
+bool PoolAllocator::IsPooled(const void *address) const
+{
+	const char *block = static_cast<const char *>(address);
+	return (block >= m_region && block < m_region + m_regionSize);
+}
+
+uint32 PoolAllocator::GetPageClassIndex(const void *address) const
+{
+	size_t page = static_cast<size_t>(static_cast<const char *>(address) - m_region) / m_pageSize;
+	return m_pageClasses[page];
+}
+
+void *PoolAllocator::AllocateFromClass(uint32 classIndex)
+{
+	SizeClass &sizeClass = m_sizeClasses[classIndex];
+
+	// Reuse a previously freed block first.
+	if (sizeClass.freeList != nullptr)
+	{
+		FreeBlock *block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		sizeClass.bytesInUse += sizeClass.blockSize;
+		return block;
+	}
+
+	// Otherwise carve a fresh block out of the current page, grabbing a new page if needed.
+	if (static_cast<uint32>(sizeClass.pageEnd - sizeClass.pageCursor) < sizeClass.blockSize)
+	{
+		char *page = AcquirePage(classIndex);
+		if (page == nullptr)
+		{
+			return nullptr;
+		}
+
+		sizeClass.pageCursor = page;
+		sizeClass.pageEnd    = page + m_pageSize;
+	}
+
+	void *block = sizeClass.pageCursor;
+	sizeClass.pageCursor += sizeClass.blockSize;
+	sizeClass.bytesInUse += sizeClass.blockSize;
+	return block;
+}
+
+void PoolAllocator::FreeToClass(SizeClass &sizeClass, void *address)
+{
+	FreeBlock *freeBlock = static_cast<FreeBlock *>(address);
+	freeBlock->next = sizeClass.freeList;
+	sizeClass.freeList = freeBlock;
+	sizeClass.bytesInUse -= sizeClass.blockSize;
+}
+
+void PoolAllocator::FreeRegion()
+{
+	if (m_useLargePages)
+	{
+		FreeLargePageMemory(m_region, m_regionSize);
+	}
+	else
+	{
+		SystemFree(m_region);
+	}
+
+	m_largePageSource = LargePageSource::kNone;
+}
+
+char *PoolAllocator::AcquirePage(uint32 classIndex)
+{
+	size_t page = m_nextPage.fetch_add(1);
+	if (page >= m_numPages)
+	{
+		// Keep the counter from wrapping around after many failed requests.
+		m_nextPage = m_numPages;
+		return nullptr;
+	}
+
+	m_pageClasses[page] = static_cast<unsigned char>(classIndex);
+	return m_region + (page * (size_t)m_pageSize);
+}
+
+} // namespace Qi
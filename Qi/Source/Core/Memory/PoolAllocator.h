@@ -0,0 +1,177 @@
+//
+//  PoolAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Implement a segregated-fit pool allocator. Small allocations are rounded up to one
+/// of a fixed set of size classes and served from a free list dedicated to that class,
+/// making both allocation and deallocation O(1). All pooled memory lives inside of a single
+/// region reserved during initialization which is split into pages, each page serving
+/// exactly one size class. Allocations larger than the biggest size class (or made after
+/// the region has been exhausted) fall back to the operating system's allocator.
+/// Each size class has its own lock so threads allocating different sizes never contend.
+///
+
+#include "Allocator.h"
+#include "VirtualMemory.h"
+#include "../Defines.h"
+#include <atomic>
+#include <mutex>
+
+namespace Qi
+{
+
+class PoolAllocator : public Allocator
+{
+	public:
+
+		PoolAllocator();
+		virtual ~PoolAllocator() override;
+
+		///
+		/// Initialization information for the pool allocator.
+		///
+		struct Cinfo : public Allocator::Cinfo
+		{
+			Cinfo() :
+				regionSize(64 * 1024 * 1024),
+				pageSize(64 * 1024),
+				useLargePages(false)
+			{
+			}
+
+			size_t regionSize; ///< Total number of bytes reserved for all size classes.
+			uint32 pageSize;   ///< Granularity (in bytes) at which the region is handed to a size class. Must be
+			                   ///  at least as large as the largest size class and a multiple of MAX_ALIGNMENT.
+			bool useLargePages; ///< If true, the region is backed by large pages where the system provides them.
+		};
+
+		////////////////////// Functions from Qi::Allocator ////////////////////////////
+		virtual Result Init(const Allocator::Cinfo *info) override;
+		virtual void Deinit() override;
+		virtual bool IsInitialized() const override;
+		virtual void *Allocate(size_t numBytes) override;
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override;
+		virtual void Deallocate(void *address) override;
+		virtual void *Reallocate(void *address, size_t oldNumBytes, size_t newNumBytes, uint32 alignment) override;
+		virtual uint32 AllocateBatch(size_t numBytes, void **blocks, uint32 count) override;
+		virtual void DeallocateBatch(void **blocks, uint32 count) override;
+		virtual size_t GetAllocationSize(const void *address) const override;
+		virtual void GetStats(AllocatorStats &stats) const override;
+		////////////////////////////////////////////////////////////////////////////////
+
+		///
+		/// Get the block size of the largest size class. Allocations bigger than
+		/// this are not pooled.
+		///
+		/// @return Largest pooled allocation size in bytes.
+		///
+		static uint32 GetMaxPooledSize();
+
+	private:
+
+		// Do not implement.
+		PoolAllocator(const PoolAllocator &other) = delete;
+		PoolAllocator &operator=(const PoolAllocator &other) = delete;
+
+		///
+		/// Node stored inside of every free block to link the free list together.
+		///
+		struct FreeBlock
+		{
+			FreeBlock *next;
+		};
+
+		///
+		/// Allocation state for a single size class.
+		///
+		struct SizeClass
+		{
+			uint32 blockSize;    ///< Size of every block in this class.
+			FreeBlock *freeList; ///< Blocks which have been returned to this class.
+			char *pageCursor;    ///< Next never-used block in the current page.
+			char *pageEnd;       ///< End of the current page.
+			uint64 bytesInUse;   ///< Number of bytes currently handed out from this class.
+			mutable std::mutex lock; ///< Guards all of the above.
+		};
+
+		///
+		/// Get the size class index to use for an allocation size.
+		///
+		/// @param numBytes Requested allocation size. Must be <= GetMaxPooledSize().
+		/// @return Index into 'm_sizeClasses'.
+		///
+		inline uint32 GetSizeClassIndex(size_t numBytes) const;
+
+		///
+		/// Get the size class index to use for an aligned allocation. Blocks of a class whose size is a
+		/// multiple of the alignment are always aligned since every page starts on a MAX_ALIGNMENT boundary.
+		///
+		/// @param numBytes Requested allocation size.
+		/// @param alignment Requested alignment (no larger than MAX_ALIGNMENT).
+		/// @return Index into 'm_sizeClasses' or m_NUM_SIZE_CLASSES if no class can serve the request.
+		///
+		inline uint32 GetAlignedSizeClassIndex(size_t numBytes, uint32 alignment) const;
+
+		///
+		/// Check if an address lies within the pooled region.
+		///
+		inline bool IsPooled(const void *address) const;
+
+		///
+		/// Get the size class which owns the page containing a pooled address.
+		///
+		inline uint32 GetPageClassIndex(const void *address) const;
+
+		///
+		/// Return the pooled region to the system, using whichever function allocated it.
+		///
+		void FreeRegion();
+
+		///
+		/// Take a block from a size class. The lock of the class must be held.
+		///
+		/// @param classIndex Size class to allocate from.
+		/// @return Block or null if the region is exhausted.
+		///
+		void *AllocateFromClass(uint32 classIndex);
+
+		///
+		/// Return a block to a size class. The lock of the class must be held.
+		///
+		inline void FreeToClass(SizeClass &sizeClass, void *address);
+
+		///
+		/// Reserve a new page from the region for a size class.
+		///
+		/// @param classIndex Size class that will own the page.
+		/// @return Start of the page or null if the region is exhausted.
+		///
+		char *AcquirePage(uint32 classIndex);
+
+		static const uint32 m_NUM_SIZE_CLASSES       = 14;   ///< Number of size classes.
+		static const uint32 m_SIZE_CLASS_GRANULARITY = 16;   ///< All size classes are multiples of this value.
+		static const uint32 m_MAX_POOLED_SIZE        = 2048; ///< Block size of the largest size class.
+		static const uint32 m_SIZE_CLASS_BYTES[m_NUM_SIZE_CLASSES]; ///< Block size of each size class.
+
+		SizeClass m_sizeClasses[m_NUM_SIZE_CLASSES]; ///< State for every size class.
+		unsigned char m_sizeToClass[m_MAX_POOLED_SIZE / m_SIZE_CLASS_GRANULARITY + 1]; ///< Maps (size / granularity) to a size class index.
+		unsigned char *m_pageClasses;                ///< Size class that owns each page of the region.
+
+		char   *m_region;                  ///< Memory backing all pooled allocations.
+		size_t m_regionSize;               ///< Size of 'm_region' in bytes.
+		bool   m_useLargePages;            ///< If true, 'm_region' was allocated with AllocateLargePageMemory().
+		LargePageSource m_largePageSource; ///< Where the large pages backing 'm_region' came from.
+		uint32 m_pageSize;                 ///< Size of each page in bytes.
+		size_t m_numPages;                 ///< Number of pages in the region.
+		std::atomic<size_t> m_nextPage;    ///< Next page in the region which has not been handed out.
+		bool   m_initialized;              ///< If true, this allocator is initialized and ready to use.
+};
+
+} // namespace Qi
@@ -0,0 +1,365 @@
+//
+//  RelocatableAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "RelocatableAllocator.h"
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace Qi
+{
+
+const RelocatableAllocator::Handle RelocatableAllocator::INVALID_HANDLE;
+
+static_assert(sizeof(RelocatableAllocator::Handle) + sizeof(size_t) <= Allocator::DEFAULT_ALIGNMENT, "Block header does not fit");
+
+RelocatableAllocator::RelocatableAllocator() :
+	m_region(nullptr),
+	m_regionSize(0),
+	m_top(0),
+	m_firstHole(m_NO_BLOCK),
+	m_handleOffsets(nullptr),
+	m_freeHandles(nullptr),
+	m_numFreeHandles(0),
+	m_maxHandles(0),
+	m_compacting(false),
+	m_compactFrontier(0),
+	m_compactScan(0),
+	m_bytesInUse(0),
+	m_peakBytesInUse(0),
+	m_initialized(false)
+{
+}
+
+RelocatableAllocator::~RelocatableAllocator()
+{
+	if (m_initialized)
+	{
+		Deinit();
+	}
+}
+
+Result RelocatableAllocator::Init(const Cinfo &info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info.regionSize >= m_MIN_BLOCK_SIZE);
+	QI_ASSERT(info.maxHandles > 0 && info.maxHandles != INVALID_HANDLE);
+
+	// The handle table is bookkeeping of the allocator itself and must not go through the memory system.
+	m_regionSize    = info.regionSize & ~(size_t)(Allocator::DEFAULT_ALIGNMENT - 1);
+	m_region        = static_cast<char *>(::operator new(m_regionSize, std::nothrow));
+	m_handleOffsets = new (std::nothrow) size_t[info.maxHandles];
+	m_freeHandles   = new (std::nothrow) Handle[info.maxHandles];
+
+	if (m_region == nullptr || m_handleOffsets == nullptr || m_freeHandles == nullptr)
+	{
+		::operator delete(m_region);
+		delete [] m_handleOffsets;
+		delete [] m_freeHandles;
+		m_region        = nullptr;
+		m_handleOffsets = nullptr;
+		m_freeHandles   = nullptr;
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	// Hand out the lowest handles first.
+	m_maxHandles     = info.maxHandles;
+	m_numFreeHandles = info.maxHandles;
+	for (uint32 ii = 0; ii < m_maxHandles; ++ii)
+	{
+		m_handleOffsets[ii] = m_NO_BLOCK;
+		m_freeHandles[ii]   = m_maxHandles - 1 - ii;
+	}
+
+	m_top            = 0;
+	m_firstHole      = m_NO_BLOCK;
+	m_compacting     = false;
+	m_bytesInUse     = 0;
+	m_peakBytesInUse = 0;
+
+	m_initialized = true;
+	return Result(ReturnCode::kSuccess);
+}
+
+void RelocatableAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	::operator delete(m_region);
+	delete [] m_handleOffsets;
+	delete [] m_freeHandles;
+
+	m_region         = nullptr;
+	m_regionSize     = 0;
+	m_handleOffsets  = nullptr;
+	m_freeHandles    = nullptr;
+	m_numFreeHandles = 0;
+	m_maxHandles     = 0;
+	m_initialized    = false;
+}
+
+bool RelocatableAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+RelocatableAllocator::Handle RelocatableAllocator::Allocate(size_t numBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	if (numBytes > m_regionSize - m_HEADER_SIZE)
+	{
+		return INVALID_HANDLE;
+	}
+
+	size_t blockSize = (numBytes + m_HEADER_SIZE + Allocator::DEFAULT_ALIGNMENT - 1) & ~(size_t)(Allocator::DEFAULT_ALIGNMENT - 1);
+	if (blockSize < m_MIN_BLOCK_SIZE)
+	{
+		blockSize = m_MIN_BLOCK_SIZE;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_numFreeHandles == 0)
+	{
+		return INVALID_HANDLE;
+	}
+
+	// Reuse the first hole which is large enough. While a compaction pass is running the holes
+	// are about to be slid over, so only the end of the region is used.
+	size_t offset = m_NO_BLOCK;
+	if (!m_compacting)
+	{
+		size_t *link = &m_firstHole;
+		while (*link != m_NO_BLOCK)
+		{
+			size_t holeOffset = *link;
+			size_t holeSize   = GetBlock(holeOffset)->size;
+			if (holeSize >= blockSize)
+			{
+				if (holeSize - blockSize >= m_MIN_BLOCK_SIZE)
+				{
+					// Split off the tail of the hole, it takes the hole's place in the list.
+					size_t remainderOffset = holeOffset + blockSize;
+					BlockHeader *remainder = GetBlock(remainderOffset);
+					remainder->size   = holeSize - blockSize;
+					remainder->handle = INVALID_HANDLE;
+					GetNextHole(remainderOffset) = GetNextHole(holeOffset);
+					*link = remainderOffset;
+				}
+				else
+				{
+					blockSize = holeSize;
+					*link = GetNextHole(holeOffset);
+				}
+
+				offset = holeOffset;
+				break;
+			}
+
+			link = &GetNextHole(holeOffset);
+		}
+	}
+
+	if (offset == m_NO_BLOCK)
+	{
+		if (blockSize > m_regionSize - m_top)
+		{
+			return INVALID_HANDLE;
+		}
+
+		offset = m_top;
+		m_top += blockSize;
+	}
+
+	Handle handle = m_freeHandles[--m_numFreeHandles];
+	m_handleOffsets[handle] = offset;
+
+	BlockHeader *block = GetBlock(offset);
+	block->size   = blockSize;
+	block->handle = handle;
+
+	m_bytesInUse += blockSize;
+	if (m_bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = m_bytesInUse;
+	}
+
+	return handle;
+}
+
+void RelocatableAllocator::Free(Handle handle)
+{
+	QI_ASSERT(m_initialized);
+
+	if (handle == INVALID_HANDLE)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	QI_ASSERT(handle < m_maxHandles && m_handleOffsets[handle] != m_NO_BLOCK);
+
+	size_t offset = m_handleOffsets[handle];
+	BlockHeader *block = GetBlock(offset);
+	QI_ASSERT(block->handle == handle);
+
+	block->handle = INVALID_HANDLE;
+	m_handleOffsets[handle] = m_NO_BLOCK;
+	m_freeHandles[m_numFreeHandles++] = handle;
+	m_bytesInUse -= block->size;
+
+	if (m_compacting && offset < m_compactFrontier)
+	{
+		// The packed part of the region has a hole again, restart the pass from it.
+		CloseCompactionGap();
+		m_compactFrontier = offset;
+		m_compactScan     = offset;
+	}
+
+	if (offset + block->size == m_top && (!m_compacting || offset >= m_compactScan))
+	{
+		// The last block simply gives its memory back to the end of the region.
+		m_top = offset;
+	}
+	else if (!m_compacting)
+	{
+		GetNextHole(offset) = m_firstHole;
+		m_firstHole = offset;
+	}
+}
+
+size_t RelocatableAllocator::GetSize(Handle handle) const
+{
+	QI_ASSERT(handle < m_maxHandles && m_handleOffsets[handle] != m_NO_BLOCK);
+	return GetBlock(m_handleOffsets[handle])->size - m_HEADER_SIZE;
+}
+
+bool RelocatableAllocator::Defragment(uint32 budgetMicroseconds)
+{
+	QI_ASSERT(m_initialized);
+
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(budgetMicroseconds);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (!m_compacting)
+	{
+		if (m_top == m_bytesInUse)
+		{
+			return true; // No holes.
+		}
+
+		// Start a new pass. The hole list is dropped, every hole gets slid over.
+		m_compacting      = true;
+		m_firstHole       = m_NO_BLOCK;
+		m_compactFrontier = 0;
+		m_compactScan     = 0;
+	}
+
+	// Walk the blocks in address order, moving every live block down to the frontier. Reading the
+	// clock costs about as much as stepping over a few headers, so it is only read after every move
+	// and every so often while skipping.
+	static const uint32 CLOCK_CHECK_INTERVAL = 64;
+	uint32 numSkipped = 0;
+
+	while (m_compactScan < m_top)
+	{
+		BlockHeader *block = GetBlock(m_compactScan);
+		size_t blockSize = block->size;
+		bool checkClock = false;
+
+		if (block->handle == INVALID_HANDLE)
+		{
+			m_compactScan += blockSize;
+			checkClock = (++numSkipped % CLOCK_CHECK_INTERVAL) == 0;
+		}
+		else if (m_compactScan == m_compactFrontier)
+		{
+			m_compactFrontier += blockSize;
+			m_compactScan     += blockSize;
+			checkClock = (++numSkipped % CLOCK_CHECK_INTERVAL) == 0;
+		}
+		else
+		{
+			std::memmove(m_region + m_compactFrontier, block, blockSize);
+			m_handleOffsets[GetBlock(m_compactFrontier)->handle] = m_compactFrontier;
+
+			m_compactFrontier += blockSize;
+			m_compactScan     += blockSize;
+			checkClock = true;
+		}
+
+		if (checkClock && Clock::now() >= deadline)
+		{
+			break;
+		}
+	}
+
+	if (m_compactScan < m_top)
+	{
+		return false;
+	}
+
+	m_top        = m_compactFrontier;
+	m_compacting = false;
+	QI_ASSERT(m_top == m_bytesInUse);
+	return true;
+}
+
+uint32 RelocatableAllocator::GetNumAllocations() const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_maxHandles - m_numFreeHandles;
+}
+
+void RelocatableAllocator::GetStats(AllocatorStats &stats) const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	size_t largestBlock = m_regionSize - m_top;
+	for (size_t hole = m_firstHole; hole != m_NO_BLOCK; hole = GetNextHole(hole))
+	{
+		if (GetBlock(hole)->size > largestBlock)
+		{
+			largestBlock = GetBlock(hole)->size;
+		}
+	}
+
+	stats.capacity         = m_regionSize;
+	stats.bytesInUse       = m_bytesInUse;
+	stats.peakBytesInUse   = m_peakBytesInUse;
+	stats.freeBytes        = m_regionSize - m_bytesInUse;
+	stats.largestFreeBlock = (largestBlock > m_HEADER_SIZE) ? largestBlock - m_HEADER_SIZE : 0;
+	stats.largePages       = 0;
+}
+
+RelocatableAllocator::BlockHeader *RelocatableAllocator::GetBlock(size_t offset) const
+{
+	return reinterpret_cast<BlockHeader *>(m_region + offset);
+}
+
+size_t &RelocatableAllocator::GetNextHole(size_t offset) const
+{
+	return *reinterpret_cast<size_t *>(m_region + offset + m_HEADER_SIZE);
+}
+
+void RelocatableAllocator::CloseCompactionGap()
+{
+	if (m_compactScan > m_compactFrontier)
+	{
+		BlockHeader *gap = GetBlock(m_compactFrontier);
+		gap->size   = m_compactScan - m_compactFrontier;
+		gap->handle = INVALID_HANDLE;
+	}
+
+	m_compactScan = m_compactFrontier;
+}
+
+} // namespace Qi
@@ -0,0 +1,200 @@
+//
+//  RelocatableAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Allocator for objects which are referenced through handles instead of pointers, so it is
+/// free to move them around. Blocks are carved from a single region: a freed block leaves a
+/// hole which later allocations of the same size or smaller can reuse, and holes that nobody
+/// reuses are removed by Defragment(), which slides live blocks down over them and patches the
+/// handle table (the same index indirection TightlyPackedArray uses). Compaction is incremental:
+/// each call works until its time budget is used up and the next call picks up where it left
+/// off, so it can run a little every frame without causing hitches.
+///
+/// Blocks are moved with memmove, so only trivially relocatable data may be stored in them, and
+/// an address obtained from a handle is only valid until the next call to Defragment().
+///
+
+#include "Allocator.h"
+#include "../BaseTypes.h"
+#include "../Defines.h"
+#include <mutex>
+
+namespace Qi
+{
+
+class RelocatableAllocator
+{
+	public:
+
+		///
+		/// Handle to a block of the allocator.
+		///
+		typedef uint32 Handle;
+
+		static const Handle INVALID_HANDLE = 0xffffffff;
+
+		RelocatableAllocator();
+		~RelocatableAllocator();
+
+		///
+		/// Initialization information for the relocatable allocator.
+		///
+		struct Cinfo
+		{
+			Cinfo() :
+				regionSize(16 * 1024 * 1024),
+				maxHandles(64 * 1024)
+			{
+			}
+
+			size_t regionSize; ///< Total number of bytes to reserve for the allocator.
+			uint32 maxHandles; ///< Maximum number of blocks which can be allocated at the same time.
+		};
+
+		///
+		/// Initialize the allocator.
+		///
+		/// @param info Initialization information.
+		/// @return Initialization success.
+		///
+		Result Init(const Cinfo &info);
+
+		///
+		/// Deinitialize the allocator, releasing its region. All handles become invalid.
+		///
+		void Deinit();
+
+		///
+		/// Check if the allocator is initialized.
+		///
+		/// @return True if initialized.
+		///
+		bool IsInitialized() const;
+
+		///
+		/// Allocate a block. The block is aligned to Allocator::DEFAULT_ALIGNMENT.
+		///
+		/// @param numBytes Size of the block.
+		/// @return Handle to the block or INVALID_HANDLE if there is no room for it (Defragment() may make room).
+		///
+		Handle Allocate(size_t numBytes);
+
+		///
+		/// Free a block.
+		///
+		/// @param handle Handle to free (INVALID_HANDLE is ignored).
+		///
+		void Free(Handle handle);
+
+		///
+		/// Get the current address of a block. The address stays valid until the next call to Defragment().
+		///
+		/// @param handle Handle to a live block.
+		/// @return Address of the block.
+		///
+		inline void *GetAddress(Handle handle) const;
+
+		///
+		/// Get the usable size of a block, which may be larger than the size it was allocated with.
+		///
+		/// @param handle Handle to a live block.
+		/// @return Size of the block in bytes.
+		///
+		size_t GetSize(Handle handle) const;
+
+		///
+		/// Move live blocks over the holes left by freed ones until the region is compact or the
+		/// time budget is used up. A single block is never split across calls, so moving a very
+		/// large block may overrun the budget.
+		///
+		/// @param budgetMicroseconds Time the call may take (0 moves at most one block).
+		/// @return True if the region contains no holes anymore.
+		///
+		bool Defragment(uint32 budgetMicroseconds);
+
+		///
+		/// Get the number of blocks currently allocated.
+		///
+		/// @return Number of live blocks.
+		///
+		uint32 GetNumAllocations() const;
+
+		///
+		/// Get statistics about the allocator. 'largestFreeBlock' is the largest allocation which can
+		/// succeed without defragmenting.
+		///
+		/// @param stats Receives the statistics.
+		///
+		void GetStats(AllocatorStats &stats) const;
+
+	private:
+
+		// Do not implement.
+		RelocatableAllocator(const RelocatableAllocator &other) = delete;
+		RelocatableAllocator &operator=(const RelocatableAllocator &other) = delete;
+
+		static const size_t m_NO_BLOCK = ~(size_t)0; ///< Offset marking the end of the hole list and unused handles.
+
+		///
+		/// Header placed in front of every block in the region. Holes store the offset of the
+		/// next hole in their payload.
+		///
+		struct BlockHeader
+		{
+			size_t size;   ///< Size of the block including this header.
+			Handle handle; ///< Handle owning the block (INVALID_HANDLE for a hole).
+		};
+
+		static const size_t m_HEADER_SIZE    = Allocator::DEFAULT_ALIGNMENT; ///< Space reserved for a BlockHeader, keeps payloads aligned.
+		static const size_t m_MIN_BLOCK_SIZE = 2 * Allocator::DEFAULT_ALIGNMENT; ///< Smallest block, has room for the header and a hole link.
+
+		///
+		/// Get the header of the block at an offset into the region.
+		///
+		inline BlockHeader *GetBlock(size_t offset) const;
+
+		///
+		/// Get the link to the next hole stored in a hole's payload.
+		///
+		inline size_t &GetNextHole(size_t offset) const;
+
+		///
+		/// Turn the unused span between the compaction frontier and the scan position back into a
+		/// hole so the block walk stays valid. 'm_lock' must be held.
+		///
+		void CloseCompactionGap();
+
+		char   *m_region;          ///< Memory blocks are carved from.
+		size_t m_regionSize;       ///< Size of 'm_region' in bytes.
+		size_t m_top;              ///< Offset of the first byte never handed out. Holes make up 'm_top - m_bytesInUse' bytes below it.
+		size_t m_firstHole;        ///< First entry of the singly linked list of reusable holes (m_NO_BLOCK if empty).
+
+		size_t *m_handleOffsets;   ///< Offset of the block owned by each handle (m_NO_BLOCK if the handle is unused).
+		Handle *m_freeHandles;     ///< Stack of unused handles.
+		uint32 m_numFreeHandles;   ///< Number of entries in 'm_freeHandles'.
+		uint32 m_maxHandles;       ///< Number of entries in 'm_handleOffsets'.
+
+		bool   m_compacting;       ///< If true, a compaction pass is in progress and the hole list is not used.
+		size_t m_compactFrontier;  ///< Everything below this offset is packed live blocks (valid while compacting).
+		size_t m_compactScan;      ///< Next block the compaction pass examines (valid while compacting).
+
+		size_t m_bytesInUse;       ///< Bytes of live blocks, headers included.
+		size_t m_peakBytesInUse;   ///< Largest value 'm_bytesInUse' has reached.
+		mutable std::mutex m_lock; ///< Guards the region layout and the handle table.
+		bool   m_initialized;      ///< If true, the allocator is initialized and ready to use.
+};
+
+void *RelocatableAllocator::GetAddress(Handle handle) const
+{
+	QI_ASSERT(handle < m_maxHandles && m_handleOffsets[handle] != m_NO_BLOCK);
+	return m_region + m_handleOffsets[handle] + m_HEADER_SIZE;
+}
+
+} // namespace Qi
@@ -0,0 +1,82 @@
+//
+//  RemoteFreeList.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "RemoteFreeList.h"
+
+namespace Qi
+{
+
+RemoteFreeList::RemoteFreeList() :
+	m_head(nullptr),
+	m_count(0)
+{
+}
+
+RemoteFreeList::~RemoteFreeList()
+{
+}
+
+void RemoteFreeList::Push(void *block)
+{
+	QI_ASSERT(block != nullptr);
+
+	Node *node = static_cast<Node *>(block);
+	node->next = nullptr;
+	PushLinked(node, 1);
+}
+
+void RemoteFreeList::PushBatch(void **blocks, uint32 count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Link the batch together privately, then publish it all at once.
+	for (uint32 ii = 0; ii + 1 < count; ++ii)
+	{
+		static_cast<Node *>(blocks[ii])->next = static_cast<Node *>(blocks[ii + 1]);
+	}
+
+	static_cast<Node *>(blocks[count - 1])->next = nullptr;
+	PushLinked(static_cast<Node *>(blocks[0]), count);
+}
+
+void *RemoteFreeList::TakeAll()
+{
+	// Cheap check first so polling an empty list does not take the cache line exclusively.
+	if (m_head.load(std::memory_order_relaxed) == nullptr)
+	{
+		return nullptr;
+	}
+
+	Node *first = m_head.exchange(nullptr, std::memory_order_acquire);
+
+	// Batches pushed while the list is being taken may go uncounted. The count is only an estimate,
+	// which is not worth walking the batches for.
+	m_count.store(0, std::memory_order_relaxed);
+	return first;
+}
+
+uint32 RemoteFreeList::GetApproximateCount() const
+{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+void RemoteFreeList::PushLinked(Node *first, uint32 count)
+{
+	m_count.fetch_add(count, std::memory_order_relaxed);
+
+	Node *head = m_head.load(std::memory_order_relaxed);
+	do
+	{
+		first->nextBatch = head;
+	} while (!m_head.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+}
+
+} // namespace Qi
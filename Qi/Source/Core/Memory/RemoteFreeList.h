@@ -0,0 +1,116 @@
+//
+//  RemoteFreeList.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Lock-free intrusive list of freed memory blocks, used to hand blocks from the threads which free
+/// them to the threads which will allocate them again. Blocks are pushed and taken in batches: the
+/// blocks of a batch are linked to each other, and only the first block of every batch is linked to
+/// the next batch. Any number of threads may push (a single compare-and-swap per batch) while consumers
+/// take every batch at once with TakeAll(), without touching any block. Taking single batches is
+/// deliberately not supported: swapping out the whole list cannot suffer from the ABA problem a
+/// lock-free pop would have. The links are stored in the first two pointers of every block.
+///
+
+#include "../BaseTypes.h"
+#include "../Defines.h"
+#include <atomic>
+
+namespace Qi
+{
+
+class QI_ALIGN(64) RemoteFreeList
+{
+	public:
+
+		RemoteFreeList();
+		~RemoteFreeList();
+
+		///
+		/// Push a single block as a batch of its own.
+		///
+		/// @param block Block to push (at least 2 * sizeof(void *) bytes).
+		///
+		void Push(void *block);
+
+		///
+		/// Push several blocks as one batch with a single atomic operation.
+		///
+		/// @param blocks Blocks to push (at least 2 * sizeof(void *) bytes each).
+		/// @param count Number of entries in 'blocks'.
+		///
+		void PushBatch(void **blocks, uint32 count);
+
+		///
+		/// Take every batch in the list. This is a single atomic exchange no matter how many blocks
+		/// the list holds. Walk the returned batches with GetNextBatch() and their blocks with GetNext().
+		///
+		/// @return First block of the first batch or null if the list is empty.
+		///
+		void *TakeAll();
+
+		///
+		/// Get the batch following a batch returned by TakeAll().
+		///
+		/// @param batch First block of a batch.
+		/// @return First block of the next batch or null if this was the last one.
+		///
+		static inline void *GetNextBatch(void *batch);
+
+		///
+		/// Get the block following a block of a batch returned by TakeAll().
+		///
+		/// @param block Block in the batch.
+		/// @return Next block or null at the end of the batch.
+		///
+		static inline void *GetNext(void *block);
+
+		///
+		/// Get the number of blocks in the list. The count is updated separately from the list, so
+		/// it may be slightly off while other threads push or take blocks.
+		///
+		/// @return Approximate number of blocks.
+		///
+		uint32 GetApproximateCount() const;
+
+	private:
+
+		// Do not implement.
+		RemoteFreeList(const RemoteFreeList &other) = delete;
+		RemoteFreeList &operator=(const RemoteFreeList &other) = delete;
+
+		///
+		/// Link stored inside of every block in the list.
+		///
+		struct Node
+		{
+			Node *next;      ///< Next block of the same batch.
+			Node *nextBatch; ///< First block of the next batch (only set in the first block of a batch).
+		};
+
+		///
+		/// Push a batch which is already linked together.
+		///
+		void PushLinked(Node *first, uint32 count);
+
+		std::atomic<Node *> m_head;   ///< First block of the most recently pushed batch.
+		std::atomic<uint32> m_count;  ///< Approximate number of blocks in the list.
+};
+
+void *RemoteFreeList::GetNextBatch(void *batch)
+{
+	return static_cast<Node *>(batch)->nextBatch;
+}
+
+void *RemoteFreeList::GetNext(void *block)
+{
+	return static_cast<Node *>(block)->next;
+}
+
+} // namespace Qi
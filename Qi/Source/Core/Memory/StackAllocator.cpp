@@ -0,0 +1,268 @@
+//
+//  StackAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "StackAllocator.h"
+#include <new>
+
+namespace Qi
+{
+
+StackAllocator::StackAllocator() :
+	m_buffer(nullptr),
+	m_capacity(0),
+	m_bottomOffset(0),
+	m_topOffset(0),
+	m_peakBytesInUse(0),
+	m_lastBottomAllocation(nullptr),
+	m_allocationSide(Side::kBottom),
+	m_ownsBuffer(false),
+	m_initialized(false)
+{
+}
+
+StackAllocator::~StackAllocator()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result StackAllocator::Init(const Allocator::Cinfo *info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info != nullptr);
+
+	const Cinfo *cinfo = static_cast<const Cinfo *>(info);
+	QI_ASSERT(cinfo->capacity > 0);
+
+	if (cinfo->buffer != nullptr)
+	{
+		m_buffer     = static_cast<char *>(cinfo->buffer);
+		m_ownsBuffer = false;
+	}
+	else
+	{
+		m_buffer = static_cast<char *>(::operator new(cinfo->capacity, std::nothrow));
+		if (m_buffer == nullptr)
+		{
+			return Result(ReturnCode::kOutOfMemory);
+		}
+
+		m_ownsBuffer = true;
+	}
+
+	m_capacity       = cinfo->capacity;
+	m_bottomOffset   = 0;
+	m_topOffset      = m_capacity;
+	m_peakBytesInUse       = 0;
+	m_lastBottomAllocation = nullptr;
+	m_allocationSide       = Side::kBottom;
+	m_initialized          = true;
+
+	return Result(ReturnCode::kSuccess);
+}
+
+void StackAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	if (m_ownsBuffer)
+	{
+		::operator delete(m_buffer);
+	}
+
+	m_buffer               = nullptr;
+	m_capacity             = 0;
+	m_bottomOffset         = 0;
+	m_topOffset            = 0;
+	m_lastBottomAllocation = nullptr;
+	m_ownsBuffer           = false;
+	m_initialized          = false;
+}
+
+bool StackAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void *StackAllocator::Allocate(size_t numBytes)
+{
+	return AllocateFromSide(m_allocationSide, numBytes, DEFAULT_ALIGNMENT);
+}
+
+void *StackAllocator::AllocateAligned(size_t numBytes, uint32 alignment)
+{
+	return AllocateFromSide(m_allocationSide, numBytes, alignment);
+}
+
+void StackAllocator::Deallocate(void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	// Individual allocations are never freed, memory is reclaimed with FreeToMarker() or Reset().
+	QI_ASSERT(address == nullptr || Owns(address));
+	(void)address;
+}
+
+bool StackAllocator::TryExpandInPlace(void *address, size_t newNumBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	// The top stack grows down, so only the most recent allocation on the bottom stack can grow.
+	if (address == nullptr || address != m_lastBottomAllocation)
+	{
+		return false;
+	}
+
+	size_t lastOffset = m_lastBottomAllocation - m_buffer;
+	if (newNumBytes > m_topOffset - lastOffset)
+	{
+		return false;
+	}
+
+	m_bottomOffset = lastOffset + newNumBytes;
+
+	size_t bytesInUse = m_capacity - GetFreeBytes();
+	if (bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = bytesInUse;
+	}
+
+	return true;
+}
+
+bool StackAllocator::Owns(const void *address) const
+{
+	const char *block = static_cast<const char *>(address);
+	return (block >= m_buffer && block < m_buffer + m_capacity);
+}
+
+void StackAllocator::GetStats(AllocatorStats &stats) const
+{
+	stats.capacity         = m_capacity;
+	stats.bytesInUse       = m_capacity - GetFreeBytes();
+	stats.peakBytesInUse   = m_peakBytesInUse;
+	stats.freeBytes        = GetFreeBytes();
+	stats.largestFreeBlock = GetFreeBytes();
+}
+
+void *StackAllocator::AllocateFromSide(Side side, size_t numBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT((alignment & (alignment - 1)) == 0);
+
+	if (alignment < DEFAULT_ALIGNMENT)
+	{
+		alignment = DEFAULT_ALIGNMENT;
+	}
+
+	// Align the actual address rather than the offset since an externally provided
+	// buffer may not start on an aligned boundary.
+	uintptr_t base      = reinterpret_cast<uintptr_t>(m_buffer);
+	uintptr_t alignMask = ~static_cast<uintptr_t>(alignment - 1);
+	uintptr_t aligned   = 0;
+
+	if (side == Side::kBottom)
+	{
+		aligned = (base + m_bottomOffset + (alignment - 1)) & alignMask;
+		if (aligned > base + m_topOffset || numBytes > base + m_topOffset - aligned)
+		{
+			// The stacks would overlap.
+			return nullptr;
+		}
+
+		m_bottomOffset = aligned + numBytes - base;
+		m_lastBottomAllocation = reinterpret_cast<char *>(aligned);
+	}
+	else
+	{
+		if (numBytes > m_topOffset)
+		{
+			return nullptr;
+		}
+
+		aligned = (base + m_topOffset - numBytes) & alignMask;
+		if (aligned < base + m_bottomOffset)
+		{
+			return nullptr;
+		}
+
+		m_topOffset = aligned - base;
+	}
+
+	size_t bytesInUse = m_capacity - GetFreeBytes();
+	if (bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = bytesInUse;
+	}
+
+	return reinterpret_cast<void *>(aligned);
+}
+
+void StackAllocator::SetAllocationSide(Side side)
+{
+	m_allocationSide = side;
+}
+
+StackAllocator::Side StackAllocator::GetAllocationSide() const
+{
+	return m_allocationSide;
+}
+
+StackAllocator::Marker StackAllocator::GetMarker(Side side) const
+{
+	QI_ASSERT(m_initialized);
+
+	Marker marker;
+	marker.side   = side;
+	marker.offset = (side == Side::kBottom) ? m_bottomOffset : m_topOffset;
+	return marker;
+}
+
+void StackAllocator::FreeToMarker(const Marker &marker)
+{
+	QI_ASSERT(m_initialized);
+
+	if (marker.side == Side::kBottom)
+	{
+		QI_ASSERT(marker.offset <= m_bottomOffset && "Marker was already freed");
+		m_bottomOffset = marker.offset;
+		m_lastBottomAllocation = nullptr;
+	}
+	else
+	{
+		QI_ASSERT(marker.offset >= m_topOffset && marker.offset <= m_capacity && "Marker was already freed");
+		m_topOffset = marker.offset;
+	}
+}
+
+void StackAllocator::Reset(Side side)
+{
+	QI_ASSERT(m_initialized);
+
+	if (side == Side::kBottom)
+	{
+		m_bottomOffset         = 0;
+		m_lastBottomAllocation = nullptr;
+	}
+	else
+	{
+		m_topOffset = m_capacity;
+	}
+}
+
+void StackAllocator::Reset()
+{
+	Reset(Side::kBottom);
+	Reset(Side::kTop);
+}
+
+size_t StackAllocator::GetFreeBytes() const
+{
+	return m_topOffset - m_bottomOffset;
+}
+
+} // namespace Qi
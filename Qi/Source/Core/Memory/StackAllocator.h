@@ -0,0 +1,159 @@
+//
+//  StackAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Implement a double-ended stack allocator. Memory is handed out from both ends of a single
+/// contiguous buffer: the bottom stack grows up from the start of the buffer and the top stack
+/// grows down from the end of it. Individual allocations cannot be freed; instead the current
+/// position of either stack can be captured with GetMarker() and everything allocated on that
+/// side after it is released at once with FreeToMarker(). This makes it possible to keep data
+/// with a long lifetime on one side (i.e. level data) while data with a short lifetime (i.e.
+/// decompression buffers used while loading) is pushed and popped on the other. The most recent
+/// allocation on the bottom stack can be grown in place until it reaches the top stack.
+/// NOTE: This allocator is not threadsafe.
+///
+
+#include "Allocator.h"
+#include "../Defines.h"
+
+namespace Qi
+{
+
+class StackAllocator : public Allocator
+{
+	public:
+
+		StackAllocator();
+		virtual ~StackAllocator() override;
+
+		///
+		/// Initialization information for the stack allocator.
+		///
+		struct Cinfo : public Allocator::Cinfo
+		{
+			Cinfo() :
+				capacity(0),
+				buffer(nullptr)
+			{
+			}
+
+			size_t capacity; ///< Total number of bytes shared by both stacks.
+			void   *buffer;  ///< Optional buffer of at least 'capacity' bytes to allocate from. The allocator does
+			                 ///  not take ownership of this buffer. If null, the allocator will allocate its own buffer.
+		};
+
+		///
+		/// The two stacks maintained by the allocator.
+		///
+		enum class Side
+		{
+			kBottom, ///< Grows up from the start of the buffer.
+			kTop     ///< Grows down from the end of the buffer.
+		};
+
+		///
+		/// Position of one of the stacks, used to release everything allocated after it.
+		///
+		struct Marker
+		{
+			Side   side;   ///< Stack this marker belongs to.
+			size_t offset; ///< Offset of the stack's top into the buffer when the marker was taken.
+		};
+
+		////////////////////// Functions from Qi::Allocator ////////////////////////////
+		virtual Result Init(const Allocator::Cinfo *info) override;
+		virtual void Deinit() override;
+		virtual bool IsInitialized() const override;
+		virtual void *Allocate(size_t numBytes) override;
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override;
+		virtual void Deallocate(void *address) override;
+		virtual bool TryExpandInPlace(void *address, size_t newNumBytes) override;
+		virtual bool Owns(const void *address) const override;
+		virtual void GetStats(AllocatorStats &stats) const override;
+		////////////////////////////////////////////////////////////////////////////////
+
+		///
+		/// Allocate from a specific stack.
+		///
+		/// @param side Stack to allocate from.
+		/// @param numBytes Number of bytes to allocate.
+		/// @param alignment Alignment (in bytes) of the returned buffer. Must be a power of two.
+		/// @return Allocated buffer or null if the stacks have run into each other.
+		///
+		void *AllocateFromSide(Side side, size_t numBytes, uint32 alignment = DEFAULT_ALIGNMENT);
+
+		///
+		/// Set the stack used by Allocate() and AllocateAligned() (and therefore by the memory
+		/// system when this allocator is installed as a scoped allocator). Defaults to Side::kBottom.
+		///
+		/// @param side Stack to allocate from.
+		///
+		void SetAllocationSide(Side side);
+
+		///
+		/// Get the stack used by Allocate() and AllocateAligned().
+		///
+		/// @return Current allocation side.
+		///
+		Side GetAllocationSide() const;
+
+		///
+		/// Capture the current position of a stack.
+		///
+		/// @param side Stack to get the position of.
+		/// @return Marker which can later be passed to FreeToMarker().
+		///
+		Marker GetMarker(Side side) const;
+
+		///
+		/// Release everything allocated on the marker's stack since the marker was taken. Markers
+		/// taken after this one (on the same stack) are invalid after this call.
+		///
+		/// @param marker Marker returned by GetMarker().
+		///
+		void FreeToMarker(const Marker &marker);
+
+		///
+		/// Release everything allocated on one stack.
+		///
+		/// @param side Stack to release.
+		///
+		void Reset(Side side);
+
+		///
+		/// Release everything allocated on both stacks.
+		///
+		void Reset();
+
+		///
+		/// Get the number of bytes between the two stacks that are still available.
+		///
+		/// @return Free bytes.
+		///
+		size_t GetFreeBytes() const;
+
+	private:
+
+		// Do not implement.
+		StackAllocator(const StackAllocator &other) = delete;
+		StackAllocator &operator=(const StackAllocator &other) = delete;
+
+		char   *m_buffer;         ///< Buffer that all allocations are made from.
+		size_t m_capacity;        ///< Size of 'm_buffer' in bytes.
+		size_t m_bottomOffset;    ///< Offset of the first byte above the bottom stack.
+		size_t m_topOffset;       ///< Offset of the last byte allocated by the top stack ('m_capacity' if it is empty).
+		size_t m_peakBytesInUse;  ///< Largest number of bytes used by both stacks together.
+		char   *m_lastBottomAllocation; ///< Most recent allocation on the bottom stack, the only one which can be resized in place.
+		Side   m_allocationSide;  ///< Stack used by Allocate() and AllocateAligned().
+		bool   m_ownsBuffer;      ///< If true, 'm_buffer' was allocated by this object and must be freed by it.
+		bool   m_initialized;     ///< If true, this allocator is initialized and ready to use.
+};
+
+} // namespace Qi
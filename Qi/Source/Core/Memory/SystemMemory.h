@@ -0,0 +1,221 @@
+//
+//  SystemMemory.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Thin wrappers around the operating system's aligned allocation functions. Allocators use
+/// these whenever they need to get memory from (or give memory back to) the system. Memory
+/// returned by SystemAllocate() must only ever be released with SystemFree().
+///
+
+#include "../Defines.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(QI_WINDOWS)
+	#include <malloc.h>
+#endif
+
+namespace Qi
+{
+
+///
+/// Allocate memory from the operating system.
+///
+/// @param numBytes Number of bytes to allocate.
+/// @param alignment Alignment of the returned buffer. Must be a power of two.
+/// @return Allocated buffer or null if the system is out of memory.
+///
+inline void *SystemAllocate(size_t numBytes, size_t alignment)
+{
+	QI_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+#if defined(QI_WINDOWS)
+	return _aligned_malloc(numBytes, alignment);
+#else
+	// posix_memalign() requires the alignment to be at least the size of a pointer.
+	void *memory = nullptr;
+	if (posix_memalign(&memory, (alignment < sizeof(void *)) ? sizeof(void *) : alignment, numBytes) != 0)
+	{
+		return nullptr;
+	}
+
+	return memory;
+#endif
+}
+
+///
+/// Resize memory allocated with SystemAllocate(). The system grows the buffer in place when it
+/// can (large buffers are usually remapped instead of copied).
+///
+/// @param address Buffer to resize. If null, this behaves like SystemAllocate().
+/// @param oldNumBytes Number of bytes currently used in the buffer.
+/// @param numBytes New size of the buffer in bytes.
+/// @param alignment Alignment the buffer was allocated with. Must be a power of two.
+/// @return Resized buffer or null if the system is out of memory (in which case 'address' is still valid).
+///
+inline void *SystemReallocate(void *address, size_t oldNumBytes, size_t numBytes, size_t alignment)
+{
+	QI_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+#if defined(QI_WINDOWS)
+	return _aligned_realloc(address, numBytes, alignment);
+#else
+	// realloc() only guarantees the alignment of malloc(), anything larger has to be moved by hand.
+	if (alignment <= alignof(std::max_align_t))
+	{
+		return realloc(address, numBytes);
+	}
+
+	void *memory = SystemAllocate(numBytes, alignment);
+	if (memory != nullptr && address != nullptr)
+	{
+		std::memcpy(memory, address, (oldNumBytes < numBytes) ? oldNumBytes : numBytes);
+		free(address);
+	}
+
+	return memory;
+#endif
+}
+
+///
+/// Return memory allocated with SystemAllocate() to the operating system.
+///
+/// @param address Buffer to free. If null, this function will not do anything.
+///
+inline void SystemFree(void *address)
+{
+#if defined(QI_WINDOWS)
+	_aligned_free(address);
+#else
+	free(address);
+#endif
+}
+
+///
+/// Header stored in front of memory allocated with SystemAllocateSized(). It is padded to the
+/// alignment of the buffer, the fields sit right in front of the buffer.
+///
+struct SystemSizedHeader
+{
+	size_t headerSize; ///< Number of bytes between the start of the system allocation and the buffer.
+	size_t numBytes;   ///< Requested size of the buffer.
+};
+
+///
+/// Get the header of a buffer allocated with SystemAllocateSized().
+///
+inline SystemSizedHeader *GetSystemSizedHeader(const void *address)
+{
+	return reinterpret_cast<SystemSizedHeader *>(const_cast<char *>(static_cast<const char *>(address)) - sizeof(SystemSizedHeader));
+}
+
+///
+/// Get the number of bytes in front of a buffer of the given alignment needed to hold its header.
+///
+inline size_t GetSystemSizedHeaderSize(size_t alignment)
+{
+	// Alignments are powers of two, so the larger of the two is a multiple of the other one.
+	return (alignment > sizeof(SystemSizedHeader)) ? alignment : sizeof(SystemSizedHeader);
+}
+
+///
+/// Allocate memory from the operating system which remembers its size, for allocators which
+/// have to report the size of buffers they got from the system (see GetSystemAllocationSize()).
+///
+/// @param numBytes Number of bytes to allocate.
+/// @param alignment Alignment of the returned buffer. Must be a power of two.
+/// @return Allocated buffer or null if the system is out of memory.
+///
+inline void *SystemAllocateSized(size_t numBytes, size_t alignment)
+{
+	size_t headerSize = GetSystemSizedHeaderSize(alignment);
+	if (numBytes > (size_t)-1 - headerSize)
+	{
+		return nullptr;
+	}
+
+	char *memory = static_cast<char *>(SystemAllocate(numBytes + headerSize, alignment));
+	if (memory == nullptr)
+	{
+		return nullptr;
+	}
+
+	SystemSizedHeader *header = GetSystemSizedHeader(memory + headerSize);
+	header->headerSize = headerSize;
+	header->numBytes   = numBytes;
+	return memory + headerSize;
+}
+
+///
+/// Resize memory allocated with SystemAllocateSized(), see SystemReallocate().
+///
+/// @param address Buffer to resize. If null, this behaves like SystemAllocateSized().
+/// @param numBytes New size of the buffer in bytes.
+/// @param alignment Alignment of the buffer. Must be a power of two.
+/// @return Resized buffer or null if the system is out of memory (in which case 'address' is still valid).
+///
+inline void *SystemReallocateSized(void *address, size_t numBytes, size_t alignment)
+{
+	if (address == nullptr)
+	{
+		return SystemAllocateSized(numBytes, alignment);
+	}
+
+	SystemSizedHeader header = *GetSystemSizedHeader(address);
+	if (GetSystemSizedHeaderSize(alignment) != header.headerSize || numBytes > (size_t)-1 - header.headerSize)
+	{
+		// The header would have to change size, move the buffer by hand.
+		void *memory = SystemAllocateSized(numBytes, alignment);
+		if (memory != nullptr)
+		{
+			std::memcpy(memory, address, (header.numBytes < numBytes) ? header.numBytes : numBytes);
+			SystemFree(static_cast<char *>(address) - header.headerSize);
+		}
+
+		return memory;
+	}
+
+	char *memory = static_cast<char *>(SystemReallocate(static_cast<char *>(address) - header.headerSize, header.numBytes + header.headerSize,
+	                                                    numBytes + header.headerSize, alignment));
+	if (memory == nullptr)
+	{
+		return nullptr;
+	}
+
+	GetSystemSizedHeader(memory + header.headerSize)->numBytes = numBytes;
+	return memory + header.headerSize;
+}
+
+///
+/// Return memory allocated with SystemAllocateSized() to the operating system.
+///
+/// @param address Buffer to free. If null, this function will not do anything.
+///
+inline void SystemFreeSized(void *address)
+{
+	if (address != nullptr)
+	{
+		SystemFree(static_cast<char *>(address) - GetSystemSizedHeader(address)->headerSize);
+	}
+}
+
+///
+/// Get the size of a buffer allocated with SystemAllocateSized().
+///
+/// @param address Buffer to query.
+/// @return Number of bytes requested for the buffer.
+///
+inline size_t GetSystemAllocationSize(const void *address)
+{
+	return GetSystemSizedHeader(address)->numBytes;
+}
+
+} // namespace Qi
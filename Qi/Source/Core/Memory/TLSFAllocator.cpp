@@ -0,0 +1,600 @@
+//
+//  TLSFAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "TLSFAllocator.h"
+#include <cstddef>
+#include <new>
+
+#if defined(QI_WINDOWS)
+	#include <intrin.h>
+#endif
+
+namespace Qi
+{
+
+namespace
+{
+	///
+	/// Get the index of the most significant set bit. 'value' must not be 0.
+	///
+	inline uint32 FindLastSet(uint64 value)
+	{
+	#if defined(QI_WINDOWS)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return (uint32)index;
+	#else
+		return 63 - (uint32)__builtin_clzll(value);
+	#endif
+	}
+
+	///
+	/// Get the index of the least significant set bit. 'value' must not be 0.
+	///
+	inline uint32 FindFirstSet(uint32 value)
+	{
+	#if defined(QI_WINDOWS)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return (uint32)index;
+	#else
+		return (uint32)__builtin_ctz(value);
+	#endif
+	}
+}
+
+TLSFAllocator::TLSFAllocator() :
+	m_flBitmap(0),
+	m_region(nullptr),
+	m_regionSize(0),
+	m_bytesInUse(0),
+	m_peakBytesInUse(0),
+	m_freeBytes(0),
+	m_useLargePages(false),
+	m_largePageSource(LargePageSource::kNone),
+	m_initialized(false)
+{
+	static_assert(offsetof(BlockHeader, nextFree) == m_HEADER_SIZE, "Payload must start directly after the used part of the header");
+
+	for (uint32 fl = 0; fl < m_FL_INDEX_COUNT; ++fl)
+	{
+		m_slBitmap[fl] = 0;
+		for (uint32 sl = 0; sl < m_SL_INDEX_COUNT; ++sl)
+		{
+			m_freeLists[fl][sl] = nullptr;
+		}
+	}
+}
+
+TLSFAllocator::~TLSFAllocator()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result TLSFAllocator::Init(const Allocator::Cinfo *info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info != nullptr);
+
+	const Cinfo *cinfo = static_cast<const Cinfo *>(info);
+	QI_ASSERT(cinfo->regionSize >= 2 * m_HEADER_SIZE + m_MIN_BLOCK_SIZE);
+	QI_ASSERT((uint64)cinfo->regionSize < ((uint64)1 << m_FL_INDEX_MAX));
+
+	m_useLargePages = cinfo->useLargePages;
+	if (m_useLargePages)
+	{
+		m_region = static_cast<char *>(AllocateLargePageMemory(cinfo->regionSize, m_largePageSource));
+	}
+	else
+	{
+		m_region = static_cast<char *>(::operator new(cinfo->regionSize, std::nothrow));
+	}
+
+	if (m_region == nullptr)
+	{
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_regionSize     = cinfo->regionSize;
+	m_bytesInUse     = 0;
+	m_peakBytesInUse = 0;
+	m_freeBytes      = 0;
+
+	// The region starts out as one big free block followed by a zero-sized, used sentinel block
+	// which stops merging from running off of the end of the region.
+	uint64 blockSize = (m_regionSize - 2 * m_HEADER_SIZE) & ~(uint64)(m_ALIGNMENT - 1);
+
+	BlockHeader *block = reinterpret_cast<BlockHeader *>(m_region);
+	block->prevPhysical = nullptr;
+	block->size = blockSize | m_FLAG_FREE;
+
+	BlockHeader *sentinel = GetNextPhysical(block);
+	sentinel->prevPhysical = block;
+	sentinel->size = 0 | m_FLAG_PREV_FREE;
+
+	InsertFreeBlock(block);
+
+	m_initialized = true;
+	return Result(ReturnCode::kSuccess);
+}
+
+void TLSFAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	if (m_useLargePages)
+	{
+		FreeLargePageMemory(m_region, m_regionSize);
+	}
+	else
+	{
+		::operator delete(m_region);
+	}
+
+	m_region          = nullptr;
+	m_largePageSource = LargePageSource::kNone;
+	m_regionSize = 0;
+
+	m_flBitmap = 0;
+	for (uint32 fl = 0; fl < m_FL_INDEX_COUNT; ++fl)
+	{
+		m_slBitmap[fl] = 0;
+		for (uint32 sl = 0; sl < m_SL_INDEX_COUNT; ++sl)
+		{
+			m_freeLists[fl][sl] = nullptr;
+		}
+	}
+
+	m_initialized = false;
+}
+
+bool TLSFAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void *TLSFAllocator::Allocate(size_t numBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	return AllocateLocked(numBytes, m_ALIGNMENT);
+}
+
+void *TLSFAllocator::AllocateAligned(size_t numBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT((alignment & (alignment - 1)) == 0);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	return AllocateLocked(numBytes, (alignment > m_ALIGNMENT) ? alignment : m_ALIGNMENT);
+}
+
+void TLSFAllocator::Deallocate(void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	DeallocateLocked(address);
+}
+
+bool TLSFAllocator::TryExpandInPlace(void *address, size_t newNumBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr || newNumBytes > m_regionSize)
+	{
+		return false;
+	}
+
+	uint64 size = ((uint64)newNumBytes + m_ALIGNMENT - 1) & ~(uint64)(m_ALIGNMENT - 1);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	BlockHeader *block = GetHeader(address);
+	QI_ASSERT(!IsFree(block));
+
+	uint64 blockSize = GetSize(block);
+	if (size <= blockSize)
+	{
+		return true;
+	}
+
+	// Free blocks are always merged with their neighbors, so the next block is the only free memory
+	// directly behind this one.
+	BlockHeader *next = GetNextPhysical(block);
+	if (!IsFree(next) || blockSize + m_HEADER_SIZE + GetSize(next) < size)
+	{
+		return false;
+	}
+
+	RemoveFreeBlock(next);
+	SetSize(block, blockSize + m_HEADER_SIZE + GetSize(next));
+	GetNextPhysical(block)->prevPhysical = block;
+
+	// Give back whatever is not needed and let the following block know its neighbor is in use.
+	SplitBlock(block, size);
+	SetPrevFree(GetNextPhysical(block), false);
+
+	m_bytesInUse += GetSize(block) - blockSize;
+	if (m_bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = m_bytesInUse;
+	}
+
+	return true;
+}
+
+uint32 TLSFAllocator::AllocateBatch(size_t numBytes, void **blocks, uint32 count)
+{
+	QI_ASSERT(m_initialized);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		blocks[ii] = AllocateLocked(numBytes, m_ALIGNMENT);
+		if (blocks[ii] == nullptr)
+		{
+			return ii;
+		}
+	}
+
+	return count;
+}
+
+void TLSFAllocator::DeallocateBatch(void **blocks, uint32 count)
+{
+	QI_ASSERT(m_initialized);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	for (uint32 ii = 0; ii < count; ++ii)
+	{
+		if (blocks[ii] != nullptr)
+		{
+			DeallocateLocked(blocks[ii]);
+		}
+	}
+}
+
+size_t TLSFAllocator::GetAllocationSize(const void *address) const
+{
+	QI_ASSERT(m_initialized);
+
+	// Other threads only ever touch the flag bits of a used block's header (when its neighbor is
+	// freed), the size bits only change when the block's owner frees or resizes it so no lock is required.
+	return (address != nullptr) ? (size_t)GetSize(GetHeader(address)) : 0;
+}
+
+void TLSFAllocator::GetStats(AllocatorStats &stats) const
+{
+	// Counting transparent huge pages reads from the file system, keep that outside of the lock.
+	stats.largePages = GetLargePageCount(m_region, m_regionSize, m_largePageSource);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	stats.capacity       = m_regionSize;
+	stats.bytesInUse     = m_bytesInUse;
+	stats.peakBytesInUse = m_peakBytesInUse;
+	stats.freeBytes      = m_freeBytes;
+
+	// The largest free block lives in the highest non-empty bin. Bins cover a range of sizes
+	// so that one list has to be walked.
+	stats.largestFreeBlock = 0;
+	if (m_flBitmap != 0)
+	{
+		uint32 fl = FindLastSet(m_flBitmap);
+		uint32 sl = FindLastSet(m_slBitmap[fl]);
+		for (const BlockHeader *block = m_freeLists[fl][sl]; block != nullptr; block = block->nextFree)
+		{
+			if (GetSize(block) > stats.largestFreeBlock)
+			{
+				stats.largestFreeBlock = GetSize(block);
+			}
+		}
+	}
+}
+
+void *TLSFAllocator::AllocateLocked(size_t numBytes, uint32 alignment)
+{
+	// Also keeps the size computations below from overflowing.
+	if (numBytes > m_regionSize)
+	{
+		return nullptr;
+	}
+
+	uint64 size = ((uint64)numBytes + m_ALIGNMENT - 1) & ~(uint64)(m_ALIGNMENT - 1);
+	if (size < m_MIN_BLOCK_SIZE)
+	{
+		size = m_MIN_BLOCK_SIZE;
+	}
+
+	// Payloads are only naturally aligned to m_ALIGNMENT. For anything larger, look for a block with enough
+	// slack to split a free block off of its front and move the payload onto the requested boundary.
+	uint64 searchSize = size;
+	if (alignment > m_ALIGNMENT)
+	{
+		searchSize += alignment + m_HEADER_SIZE + m_MIN_BLOCK_SIZE;
+	}
+
+	uint32 fl, sl;
+	MappingSearch(searchSize, fl, sl);
+	if (fl >= m_FL_INDEX_COUNT)
+	{
+		// Larger than anything this allocator can ever hold.
+		return nullptr;
+	}
+
+	BlockHeader *block = FindSuitableBlock(fl, sl);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	RemoveFreeBlock(block);
+	if (alignment > m_ALIGNMENT)
+	{
+		block = SplitBlockForAlignment(block, alignment);
+	}
+
+	SplitBlock(block, size);
+
+	SetFree(block, false);
+	SetPrevFree(GetNextPhysical(block), false);
+
+	m_bytesInUse += GetSize(block);
+	if (m_bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = m_bytesInUse;
+	}
+
+	return GetPayload(block);
+}
+
+void TLSFAllocator::DeallocateLocked(void *address)
+{
+	QI_ASSERT(static_cast<char *>(address) > m_region && static_cast<char *>(address) < m_region + m_regionSize);
+
+	BlockHeader *block = GetHeader(address);
+	QI_ASSERT(!IsFree(block) && "Double free detected");
+
+	m_bytesInUse -= GetSize(block);
+
+	SetFree(block, true);
+	SetPrevFree(GetNextPhysical(block), true);
+
+	block = MergeBlock(block);
+	InsertFreeBlock(block);
+}
+
+uint64 TLSFAllocator::GetSize(const BlockHeader *block) const
+{
+	return block->size & ~m_FLAG_MASK;
+}
+
+void TLSFAllocator::SetSize(BlockHeader *block, uint64 size)
+{
+	block->size = size | (block->size & m_FLAG_MASK);
+}
+
+bool TLSFAllocator::IsFree(const BlockHeader *block) const
+{
+	return (block->size & m_FLAG_FREE) != 0;
+}
+
+void TLSFAllocator::SetFree(BlockHeader *block, bool free)
+{
+	block->size = free ? (block->size | m_FLAG_FREE) : (block->size & ~m_FLAG_FREE);
+}
+
+bool TLSFAllocator::IsPrevFree(const BlockHeader *block) const
+{
+	return (block->size & m_FLAG_PREV_FREE) != 0;
+}
+
+void TLSFAllocator::SetPrevFree(BlockHeader *block, bool free)
+{
+	block->size = free ? (block->size | m_FLAG_PREV_FREE) : (block->size & ~m_FLAG_PREV_FREE);
+}
+
+TLSFAllocator::BlockHeader *TLSFAllocator::GetNextPhysical(const BlockHeader *block) const
+{
+	return reinterpret_cast<BlockHeader *>(reinterpret_cast<char *>(GetPayload(block)) + GetSize(block));
+}
+
+void *TLSFAllocator::GetPayload(const BlockHeader *block) const
+{
+	return const_cast<char *>(reinterpret_cast<const char *>(block)) + m_HEADER_SIZE;
+}
+
+TLSFAllocator::BlockHeader *TLSFAllocator::GetHeader(const void *payload) const
+{
+	return reinterpret_cast<BlockHeader *>(const_cast<char *>(static_cast<const char *>(payload)) - m_HEADER_SIZE);
+}
+
+void TLSFAllocator::MappingInsert(uint64 size, uint32 &fl, uint32 &sl) const
+{
+	if (size < m_SMALL_BLOCK_SIZE)
+	{
+		// Small blocks are binned linearly in the first first-level bin.
+		fl = 0;
+		sl = (uint32)(size / (m_SMALL_BLOCK_SIZE / m_SL_INDEX_COUNT));
+	}
+	else
+	{
+		uint32 lastSet = FindLastSet(size);
+		sl = (uint32)(size >> (lastSet - m_SL_INDEX_COUNT_LOG2)) ^ (1 << m_SL_INDEX_COUNT_LOG2);
+		fl = lastSet - (m_FL_INDEX_SHIFT - 1);
+	}
+}
+
+void TLSFAllocator::MappingSearch(uint64 size, uint32 &fl, uint32 &sl) const
+{
+	// Round the size up to the next bin boundary so that any block found in the resulting
+	// bin is large enough without having to search the list.
+	if (size >= m_SMALL_BLOCK_SIZE)
+	{
+		size += ((uint64)1 << (FindLastSet(size) - m_SL_INDEX_COUNT_LOG2)) - 1;
+	}
+
+	MappingInsert(size, fl, sl);
+}
+
+TLSFAllocator::BlockHeader *TLSFAllocator::FindSuitableBlock(uint32 &fl, uint32 &sl) const
+{
+	// Look for a non-empty bin at or above 'sl' in the same first level.
+	uint32 slMap = m_slBitmap[fl] & (~0u << sl);
+	if (slMap == 0)
+	{
+		// Nothing there, move to the next non-empty first level.
+		uint32 flMap = (fl + 1 < 32) ? (m_flBitmap & (~0u << (fl + 1))) : 0;
+		if (flMap == 0)
+		{
+			return nullptr;
+		}
+
+		fl    = FindFirstSet(flMap);
+		slMap = m_slBitmap[fl];
+	}
+
+	sl = FindFirstSet(slMap);
+	return m_freeLists[fl][sl];
+}
+
+void TLSFAllocator::InsertFreeBlock(BlockHeader *block)
+{
+	uint32 fl, sl;
+	MappingInsert(GetSize(block), fl, sl);
+
+	BlockHeader *head = m_freeLists[fl][sl];
+	block->nextFree = head;
+	block->prevFree = nullptr;
+	if (head != nullptr)
+	{
+		head->prevFree = block;
+	}
+
+	m_freeLists[fl][sl] = block;
+	m_flBitmap     |= (1u << fl);
+	m_slBitmap[fl] |= (1u << sl);
+
+	m_freeBytes += GetSize(block);
+}
+
+void TLSFAllocator::RemoveFreeBlock(BlockHeader *block)
+{
+	uint32 fl, sl;
+	MappingInsert(GetSize(block), fl, sl);
+
+	if (block->prevFree != nullptr)
+	{
+		block->prevFree->nextFree = block->nextFree;
+	}
+	else
+	{
+		m_freeLists[fl][sl] = block->nextFree;
+	}
+
+	if (block->nextFree != nullptr)
+	{
+		block->nextFree->prevFree = block->prevFree;
+	}
+
+	// Clear the bitmap bits once the bin is empty.
+	if (m_freeLists[fl][sl] == nullptr)
+	{
+		m_slBitmap[fl] &= ~(1u << sl);
+		if (m_slBitmap[fl] == 0)
+		{
+			m_flBitmap &= ~(1u << fl);
+		}
+	}
+
+	m_freeBytes -= GetSize(block);
+}
+
+void TLSFAllocator::SplitBlock(BlockHeader *block, uint64 size)
+{
+	uint64 blockSize = GetSize(block);
+	if (blockSize < size + m_HEADER_SIZE + m_MIN_BLOCK_SIZE)
+	{
+		// The remainder is too small to be a block of its own, hand out the whole block.
+		return;
+	}
+
+	SetSize(block, size);
+
+	BlockHeader *remainder = GetNextPhysical(block);
+	remainder->prevPhysical = block;
+	remainder->size = (blockSize - size - m_HEADER_SIZE) | m_FLAG_FREE;
+
+	GetNextPhysical(remainder)->prevPhysical = remainder;
+	InsertFreeBlock(remainder);
+}
+
+TLSFAllocator::BlockHeader *TLSFAllocator::SplitBlockForAlignment(BlockHeader *block, uint32 alignment)
+{
+	uintptr_t payload = reinterpret_cast<uintptr_t>(GetPayload(block));
+	uintptr_t aligned = (payload + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	if (aligned == payload)
+	{
+		return block;
+	}
+
+	// The gap in front of the aligned payload has to be able to hold a free block of its own.
+	if (aligned - payload < m_HEADER_SIZE + m_MIN_BLOCK_SIZE)
+	{
+		aligned += alignment;
+	}
+
+	uint64 gap       = aligned - payload;
+	uint64 blockSize = GetSize(block);
+	QI_ASSERT(blockSize > gap);
+
+	BlockHeader *alignedBlock = GetHeader(reinterpret_cast<void *>(aligned));
+	alignedBlock->prevPhysical = block;
+	alignedBlock->size = (blockSize - gap) | m_FLAG_FREE | m_FLAG_PREV_FREE;
+	GetNextPhysical(alignedBlock)->prevPhysical = alignedBlock;
+
+	SetSize(block, gap - m_HEADER_SIZE);
+	InsertFreeBlock(block);
+
+	return alignedBlock;
+}
+
+TLSFAllocator::BlockHeader *TLSFAllocator::MergeBlock(BlockHeader *block)
+{
+	if (IsPrevFree(block))
+	{
+		BlockHeader *prev = block->prevPhysical;
+		QI_ASSERT(prev != nullptr && IsFree(prev));
+
+		RemoveFreeBlock(prev);
+		SetSize(prev, GetSize(prev) + m_HEADER_SIZE + GetSize(block));
+		block = prev;
+
+		GetNextPhysical(block)->prevPhysical = block;
+	}
+
+	BlockHeader *next = GetNextPhysical(block);
+	if (IsFree(next))
+	{
+		RemoveFreeBlock(next);
+		SetSize(block, GetSize(block) + m_HEADER_SIZE + GetSize(next));
+
+		GetNextPhysical(block)->prevPhysical = block;
+	}
+
+	return block;
+}
+
+} // namespace Qi
@@ -0,0 +1,175 @@
+//
+//  TLSFAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Implement a two-level segregated fit (TLSF) allocator. Free blocks are binned by a first
+/// level (power of two) and a second level (linear subdivision of that power of two) index.
+/// A pair of bitmaps records which bins contain blocks, so finding a suitable free block is
+/// a couple of bit scans. Freed blocks are immediately merged with their physical neighbors.
+/// Allocation and deallocation are both O(1) in the worst case, so allocation latency never
+/// spikes. A used block can grow in place by absorbing the free block that physically
+/// follows it. All memory is served from a single region reserved during initialization; the
+/// allocator never returns memory to the operating system or asks it for more.
+///
+
+#include "Allocator.h"
+#include "VirtualMemory.h"
+#include "../Defines.h"
+#include <mutex>
+
+namespace Qi
+{
+
+class TLSFAllocator : public Allocator
+{
+	public:
+
+		TLSFAllocator();
+		virtual ~TLSFAllocator() override;
+
+		///
+		/// Initialization information for the TLSF allocator.
+		///
+		struct Cinfo : public Allocator::Cinfo
+		{
+			Cinfo() :
+				regionSize(64 * 1024 * 1024),
+				useLargePages(false)
+			{
+			}
+
+			size_t regionSize;  ///< Total number of bytes to reserve for the allocator.
+			bool useLargePages; ///< If true, the region is backed by large pages where the system provides them.
+		};
+
+		////////////////////// Functions from Qi::Allocator ////////////////////////////
+		virtual Result Init(const Allocator::Cinfo *info) override;
+		virtual void Deinit() override;
+		virtual bool IsInitialized() const override;
+		virtual void *Allocate(size_t numBytes) override;
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override;
+		virtual void Deallocate(void *address) override;
+		virtual bool TryExpandInPlace(void *address, size_t newNumBytes) override;
+		virtual uint32 AllocateBatch(size_t numBytes, void **blocks, uint32 count) override;
+		virtual void DeallocateBatch(void **blocks, uint32 count) override;
+		virtual size_t GetAllocationSize(const void *address) const override;
+		virtual void GetStats(AllocatorStats &stats) const override;
+		////////////////////////////////////////////////////////////////////////////////
+
+	private:
+
+		// Do not implement.
+		TLSFAllocator(const TLSFAllocator &other) = delete;
+		TLSFAllocator &operator=(const TLSFAllocator &other) = delete;
+
+		///
+		/// Header placed in front of every block in the region. The free list links are
+		/// only valid while the block is free and live in the block's payload.
+		///
+		struct BlockHeader
+		{
+			BlockHeader *prevPhysical; ///< Block located directly before this one in memory.
+			uint64      size;          ///< Payload size of this block. The low bits store the block flags.
+
+			BlockHeader *nextFree;     ///< Next block in the same free list (free blocks only).
+			BlockHeader *prevFree;     ///< Previous block in the same free list (free blocks only).
+		};
+
+		///
+		/// Allocate/deallocate a block. The allocator lock must be held.
+		///
+		void *AllocateLocked(size_t numBytes, uint32 alignment);
+		void DeallocateLocked(void *address);
+
+		// Block helpers.
+		inline uint64 GetSize(const BlockHeader *block) const;
+		inline void SetSize(BlockHeader *block, uint64 size);
+		inline bool IsFree(const BlockHeader *block) const;
+		inline void SetFree(BlockHeader *block, bool free);
+		inline bool IsPrevFree(const BlockHeader *block) const;
+		inline void SetPrevFree(BlockHeader *block, bool free);
+		inline BlockHeader *GetNextPhysical(const BlockHeader *block) const;
+		inline void *GetPayload(const BlockHeader *block) const;
+		inline BlockHeader *GetHeader(const void *payload) const;
+
+		///
+		/// Compute the first and second level indices for a block size.
+		///
+		inline void MappingInsert(uint64 size, uint32 &fl, uint32 &sl) const;
+
+		///
+		/// Compute the first and second level indices of the first bin whose blocks are all
+		/// guaranteed to be at least 'size' bytes.
+		///
+		inline void MappingSearch(uint64 size, uint32 &fl, uint32 &sl) const;
+
+		///
+		/// Find a free block of at least the size described by 'fl' and 'sl'. The indices are
+		/// updated to the bin the block was found in.
+		///
+		/// @return Suitable free block or null if there is none.
+		///
+		BlockHeader *FindSuitableBlock(uint32 &fl, uint32 &sl) const;
+
+		void InsertFreeBlock(BlockHeader *block);
+		void RemoveFreeBlock(BlockHeader *block);
+
+		///
+		/// Split a block into one of 'size' bytes and a free remainder (if the remainder is big
+		/// enough to be a block of its own).
+		///
+		void SplitBlock(BlockHeader *block, uint64 size);
+
+		///
+		/// Split a free block (which has already been removed from its free list) so that the payload of
+		/// the returned block lies on an 'alignment' boundary. The space in front of it becomes a free block.
+		///
+		/// @return The aligned block (which is not part of any free list).
+		///
+		BlockHeader *SplitBlockForAlignment(BlockHeader *block, uint32 alignment);
+
+		///
+		/// Merge a free block with its free physical neighbors.
+		///
+		/// @return The merged block.
+		///
+		BlockHeader *MergeBlock(BlockHeader *block);
+
+		static const uint32 m_ALIGNMENT_LOG2      = 4;                                        ///< Log2 of the alignment of every payload.
+		static const uint32 m_ALIGNMENT           = 1 << m_ALIGNMENT_LOG2;                   ///< Alignment of every payload.
+		static const uint32 m_SL_INDEX_COUNT_LOG2 = 4;                                        ///< Log2 of the number of second level bins.
+		static const uint32 m_SL_INDEX_COUNT      = 1 << m_SL_INDEX_COUNT_LOG2;              ///< Number of second level bins per first level bin.
+		static const uint32 m_FL_INDEX_MAX        = 39;                                       ///< Log2 of the largest supported block size (one first level bin per bit of 'm_flBitmap').
+		static const uint32 m_FL_INDEX_SHIFT      = m_SL_INDEX_COUNT_LOG2 + m_ALIGNMENT_LOG2; ///< Log2 of the smallest non-linearly binned size.
+		static const uint32 m_FL_INDEX_COUNT      = m_FL_INDEX_MAX - m_FL_INDEX_SHIFT + 1;    ///< Number of first level bins.
+		static const uint32 m_SMALL_BLOCK_SIZE    = 1 << m_FL_INDEX_SHIFT;                   ///< Blocks below this size are binned linearly.
+		static const uint32 m_HEADER_SIZE         = 16; ///< Overhead of a used block (the part of BlockHeader in front of the payload).
+		static const uint32 m_MIN_BLOCK_SIZE      = 16; ///< Smallest payload (must be able to hold the free list links).
+
+		static const uint64 m_FLAG_FREE      = 1; ///< Set on 'size' when the block is free.
+		static const uint64 m_FLAG_PREV_FREE = 2; ///< Set on 'size' when the previous physical block is free.
+		static const uint64 m_FLAG_MASK      = m_FLAG_FREE | m_FLAG_PREV_FREE;
+
+		uint32 m_flBitmap;                                  ///< Bit 'fl' is set when any bin in first level 'fl' has a block.
+		uint32 m_slBitmap[m_FL_INDEX_COUNT];               ///< Bit 'sl' of entry 'fl' is set when bin [fl][sl] has a block.
+		BlockHeader *m_freeLists[m_FL_INDEX_COUNT][m_SL_INDEX_COUNT]; ///< Heads of every free list.
+
+		char   *m_region;          ///< Memory backing all allocations.
+		size_t m_regionSize;       ///< Size of 'm_region' in bytes.
+		uint64 m_bytesInUse;       ///< Payload bytes currently allocated.
+		uint64 m_peakBytesInUse;   ///< Largest value 'm_bytesInUse' has reached.
+		uint64 m_freeBytes;        ///< Payload bytes of all free blocks.
+		bool   m_useLargePages;    ///< If true, 'm_region' was allocated with AllocateLargePageMemory().
+		LargePageSource m_largePageSource; ///< Where the large pages backing 'm_region' came from.
+		mutable std::mutex m_lock; ///< Guards all allocator state.
+		bool   m_initialized;      ///< If true, this allocator is initialized and ready to use.
+};
+
+} // namespace Qi
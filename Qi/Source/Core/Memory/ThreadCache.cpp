@@ -0,0 +1,203 @@
+//
+//  ThreadCache.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "ThreadCache.h"
+
+namespace Qi
+{
+
+const uint32 ThreadCache::MIN_CACHED_SIZE;
+const uint32 ThreadCache::MAX_CACHED_SIZE;
+const uint32 ThreadCache::NUM_SIZE_CLASSES;
+const uint32 ThreadCache::MAX_REMOTE_FREES;
+
+ThreadCache::ThreadCache()
+{
+	Discard();
+}
+
+ThreadCache::~ThreadCache()
+{
+}
+
+void *ThreadCache::Allocate(Allocator *allocator, size_t numBytes, RemoteFreeList *remoteFrees)
+{
+	QI_ASSERT(numBytes <= MAX_CACHED_SIZE);
+
+	// Round up to the size class which can hold the request.
+	uint32 classIndex = m_servingClasses[(numBytes > 0) ? (numBytes - 1) / m_SIZE_CLASS_GRANULARITY : 0];
+	Magazine &magazine = m_magazines[classIndex];
+
+	if (magazine.count == 0 && magazine.remoteBatches == nullptr && remoteFrees != nullptr)
+	{
+		// Take back every batch other threads freed at once. The ones that do not fit into the
+		// magazine stay with this cache for the next refills rather than being pushed back.
+		magazine.remoteBatches = remoteFrees[classIndex].TakeAll();
+	}
+
+	if (magazine.count == 0 && magazine.remoteBatches != nullptr)
+	{
+		void *batch = magazine.remoteBatches;
+		magazine.remoteBatches = RemoteFreeList::GetNextBatch(batch);
+		for (void *block = batch; block != nullptr; block = RemoteFreeList::GetNext(block))
+		{
+			QI_ASSERT(magazine.count < m_MAGAZINE_SIZE);
+			magazine.blocks[magazine.count++] = block;
+		}
+	}
+
+	if (magazine.count == 0)
+	{
+		size_t blockSize = (classIndex + 1) * m_SIZE_CLASS_GRANULARITY;
+		magazine.count = allocator->AllocateBatch(blockSize, magazine.blocks, m_BATCH_SIZE);
+		if (magazine.count == 0)
+		{
+			return nullptr;
+		}
+
+		// The allocator may have rounded the request up to one of its own size classes, in which case the
+		// blocks are freed to a larger magazine. Serve this size class from that magazine from now on.
+		size_t usableSize = allocator->GetAllocationSize(magazine.blocks[0]);
+		if (usableSize >= MIN_CACHED_SIZE && usableSize <= MAX_CACHED_SIZE && GetBlockClassIndex(usableSize) != classIndex)
+		{
+			uint32 blockClassIndex = GetBlockClassIndex(usableSize);
+			QI_ASSERT(blockClassIndex > classIndex);
+			m_servingClasses[classIndex] = blockClassIndex;
+
+			Magazine &blockMagazine = m_magazines[blockClassIndex];
+			while (magazine.count > 0 && blockMagazine.count < m_MAGAZINE_SIZE)
+			{
+				blockMagazine.blocks[blockMagazine.count++] = magazine.blocks[--magazine.count];
+			}
+
+			if (magazine.count > 0)
+			{
+				allocator->DeallocateBatch(magazine.blocks, magazine.count);
+				magazine.count = 0;
+			}
+
+			return blockMagazine.blocks[--blockMagazine.count];
+		}
+	}
+
+	return magazine.blocks[--magazine.count];
+}
+
+void ThreadCache::Deallocate(Allocator *allocator, void *address, size_t blockSize, RemoteFreeList *remoteFrees)
+{
+	QI_ASSERT(blockSize >= MIN_CACHED_SIZE && blockSize <= MAX_CACHED_SIZE);
+
+	uint32 classIndex = GetBlockClassIndex(blockSize);
+	Magazine &magazine = m_magazines[classIndex];
+
+	if (magazine.count == m_MAGAZINE_SIZE)
+	{
+		// Hand the oldest half of the magazine to whichever thread allocates this size next.
+		if (remoteFrees != nullptr)
+		{
+			remoteFrees[classIndex].PushBatch(magazine.blocks, m_BATCH_SIZE);
+		}
+		else
+		{
+			allocator->DeallocateBatch(magazine.blocks, m_BATCH_SIZE);
+		}
+
+		for (uint32 ii = m_BATCH_SIZE; ii < m_MAGAZINE_SIZE; ++ii)
+		{
+			magazine.blocks[ii - m_BATCH_SIZE] = magazine.blocks[ii];
+		}
+
+		magazine.count -= m_BATCH_SIZE;
+	}
+
+	magazine.blocks[magazine.count++] = address;
+}
+
+void ThreadCache::Flush(Allocator *allocator)
+{
+	for (uint32 ii = 0; ii < NUM_SIZE_CLASSES; ++ii)
+	{
+		if (m_magazines[ii].count > 0)
+		{
+			allocator->DeallocateBatch(m_magazines[ii].blocks, m_magazines[ii].count);
+			m_magazines[ii].count = 0;
+		}
+
+		DeallocateBatches(allocator, m_magazines[ii].remoteBatches);
+		m_magazines[ii].remoteBatches = nullptr;
+	}
+}
+
+void ThreadCache::FlushRemoteFrees(Allocator *allocator, RemoteFreeList *remoteFrees)
+{
+	for (uint32 ii = 0; ii < NUM_SIZE_CLASSES; ++ii)
+	{
+		DeallocateBatches(allocator, remoteFrees[ii].TakeAll());
+	}
+}
+
+void ThreadCache::TrimRemoteFrees(Allocator *allocator, RemoteFreeList *remoteFrees)
+{
+	for (uint32 ii = 0; ii < NUM_SIZE_CLASSES; ++ii)
+	{
+		if (remoteFrees[ii].GetApproximateCount() > MAX_REMOTE_FREES)
+		{
+			DeallocateBatches(allocator, remoteFrees[ii].TakeAll());
+		}
+	}
+}
+
+void ThreadCache::Discard()
+{
+	for (uint32 ii = 0; ii < NUM_SIZE_CLASSES; ++ii)
+	{
+		m_magazines[ii].count = 0;
+		m_magazines[ii].remoteBatches = nullptr;
+		m_servingClasses[ii] = ii;
+	}
+}
+
+uint32 ThreadCache::GetBlockClassIndex(size_t blockSize)
+{
+	// Backing allocators may return blocks which are larger than the size class they were requested for.
+	return static_cast<uint32>(blockSize / m_SIZE_CLASS_GRANULARITY) - 1;
+}
+
+void ThreadCache::DeallocateBatches(Allocator *allocator, void *batches)
+{
+	void *blocks[m_BATCH_SIZE];
+	uint32 count = 0;
+	void *batch = batches;
+	while (batch != nullptr)
+	{
+		// Blocks are only freed once the links stored inside of them have been read.
+		void *nextBatch = RemoteFreeList::GetNextBatch(batch);
+		void *block = batch;
+		while (block != nullptr)
+		{
+			void *next = RemoteFreeList::GetNext(block);
+			blocks[count++] = block;
+			if (count == m_BATCH_SIZE)
+			{
+				allocator->DeallocateBatch(blocks, count);
+				count = 0;
+			}
+
+			block = next;
+		}
+
+		batch = nextBatch;
+	}
+
+	if (count > 0)
+	{
+		allocator->DeallocateBatch(blocks, count);
+	}
+}
+
+} // namespace Qi
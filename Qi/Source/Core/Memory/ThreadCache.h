@@ -0,0 +1,142 @@
+//
+//  ThreadCache.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Per-thread cache of small memory blocks which sits in front of an Allocator. Each size class
+/// keeps a "magazine" of free blocks which can be handed out/taken back without touching the
+/// backing allocator (and therefore without any locking). When a magazine runs empty it is refilled
+/// with a batch of blocks from the backing allocator, and when it overflows half of it is flushed
+/// back in a single batch. This keeps contention on the backing allocator low when many threads
+/// allocate at the same time. A ThreadCache must only ever be used by the thread that owns it.
+///
+/// Freed blocks are filed by the usable size the backing allocator reports for them. Allocators which
+/// round requests up to their own size classes are detected on refill, and the size class is then served
+/// from the magazine its blocks are freed to, so that blocks do not pile up where nobody allocates them.
+///
+/// Caches in front of the same allocator can share one RemoteFreeList per size class. Overflowing
+/// magazines are then always pushed onto the shared list instead of the allocator, and empty magazines
+/// are refilled from it first, so blocks freed by one thread travel back to the threads allocating them
+/// without taking the allocator's locks (i.e. a producer allocating messages which a consumer frees).
+/// A refill takes the whole shared list at once and keeps the batches which do not fit into the
+/// magazine to itself, so no block is walked or published again. Lists which pile up because nobody
+/// allocates their size class are returned to the allocator by TrimRemoteFrees().
+///
+
+#include "Allocator.h"
+#include "RemoteFreeList.h"
+#include "../Defines.h"
+
+namespace Qi
+{
+
+class ThreadCache
+{
+	public:
+
+		ThreadCache();
+		~ThreadCache();
+
+		///
+		/// Allocate a block, refilling the magazine of its size class from the remote frees or the backing
+		/// allocator if necessary.
+		///
+		/// @param allocator Backing allocator.
+		/// @param numBytes Number of bytes to allocate. Must be <= MAX_CACHED_SIZE.
+		/// @param remoteFrees Lists of blocks freed by other caches, NUM_SIZE_CLASSES entries (optional).
+		/// @return Allocated block or null if the backing allocator is out of memory.
+		///
+		void *Allocate(Allocator *allocator, size_t numBytes, RemoteFreeList *remoteFrees = nullptr);
+
+		///
+		/// Return a block to the cache, flushing half of the magazine of its size class to the remote
+		/// frees (or the backing allocator if they are not given) if the magazine is full.
+		///
+		/// @param allocator Backing allocator.
+		/// @param address Block to free.
+		/// @param blockSize Usable size of the block as reported by the backing allocator. Must be
+		///                  between MIN_CACHED_SIZE and MAX_CACHED_SIZE.
+		/// @param remoteFrees Lists of blocks freed by other caches, NUM_SIZE_CLASSES entries (optional).
+		///
+		void Deallocate(Allocator *allocator, void *address, size_t blockSize, RemoteFreeList *remoteFrees = nullptr);
+
+		///
+		/// Return every cached block, including batches taken from the remote frees, to the backing allocator.
+		///
+		/// @param allocator Backing allocator.
+		///
+		void Flush(Allocator *allocator);
+
+		///
+		/// Forget about every cached block and the size classes learned from the backing allocator, without
+		/// returning any block to it. Only use this when the backing allocator has already been destroyed.
+		///
+		void Discard();
+
+		///
+		/// Return every block in a set of remote free lists to the backing allocator.
+		///
+		/// @param allocator Backing allocator.
+		/// @param remoteFrees Lists to empty, NUM_SIZE_CLASSES entries.
+		///
+		static void FlushRemoteFrees(Allocator *allocator, RemoteFreeList *remoteFrees);
+
+		///
+		/// Return the blocks of every remote free list which holds more than MAX_REMOTE_FREES blocks
+		/// to the backing allocator. Meant to be called periodically by a single thread, so that
+		/// memory freed for size classes which are no longer allocated does not pile up.
+		///
+		/// @param allocator Backing allocator.
+		/// @param remoteFrees Lists to trim, NUM_SIZE_CLASSES entries.
+		///
+		static void TrimRemoteFrees(Allocator *allocator, RemoteFreeList *remoteFrees);
+
+		static const uint32 MIN_CACHED_SIZE  = 16;  ///< Smallest block (in bytes) held by the cache.
+		static const uint32 MAX_CACHED_SIZE  = 256; ///< Largest allocation (in bytes) served by the cache.
+		static const uint32 NUM_SIZE_CLASSES = 16;  ///< Number of size classes, and of the remote free lists shared by caches.
+		static const uint32 MAX_REMOTE_FREES = 1024; ///< Blocks a remote free list may hold before TrimRemoteFrees() returns them.
+
+	private:
+
+		// Do not implement.
+		ThreadCache(const ThreadCache &other) = delete;
+		ThreadCache &operator=(const ThreadCache &other) = delete;
+
+		static const uint32 m_SIZE_CLASS_GRANULARITY = MAX_CACHED_SIZE / NUM_SIZE_CLASSES;    ///< Size classes are multiples of this value.
+		static const uint32 m_MAGAZINE_SIZE          = 64;                                    ///< Maximum number of blocks cached per size class.
+		static const uint32 m_BATCH_SIZE             = m_MAGAZINE_SIZE / 2;                   ///< Number of blocks moved per refill/flush.
+
+		///
+		/// Return a chain of batches taken from a remote free list to the backing allocator.
+		///
+		static void DeallocateBatches(Allocator *allocator, void *batches);
+
+		///
+		/// Get the size class a block is filed under when it is freed. Rounds down so that a block is only
+		/// ever handed out for requests it can hold.
+		///
+		/// @param blockSize Usable size of the block, between MIN_CACHED_SIZE and MAX_CACHED_SIZE.
+		///
+		static uint32 GetBlockClassIndex(size_t blockSize);
+
+		///
+		/// Cached free blocks for a single size class. Used as a stack.
+		///
+		struct Magazine
+		{
+			void   *blocks[m_MAGAZINE_SIZE];
+			uint32 count;
+			void   *remoteBatches; ///< Batches taken from the remote frees which did not fit into the magazine yet.
+		};
+
+		Magazine m_magazines[NUM_SIZE_CLASSES];      ///< Magazine for each size class.
+		uint32 m_servingClasses[NUM_SIZE_CLASSES];   ///< Magazine which serves the requests of each size class.
+};
+
+} // namespace Qi
@@ -0,0 +1,289 @@
+//
+//  VirtualMemory.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Thin wrappers around the operating system's virtual memory functions. Address space is
+/// reserved first (which costs no physical memory) and individual pages are then committed
+/// and decommitted as they are needed. All addresses and sizes passed to these functions
+/// must be multiples of GetVirtualPageSize(). Large regions which are accessed all over (world
+/// data, entity storage) can instead be allocated with AllocateLargePageMemory() to cut down on
+/// TLB misses.
+///
+
+#include "../BaseTypes.h"
+#include "../Defines.h"
+#include <cstddef>
+#include <cstdio>
+
+#if defined(QI_WINDOWS)
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+namespace Qi
+{
+
+///
+/// Get the granularity that virtual memory is reserved and committed with.
+///
+/// @return Page size in bytes.
+///
+inline size_t GetVirtualPageSize()
+{
+#if defined(QI_WINDOWS)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+///
+/// Reserve a range of address space. The range cannot be accessed until it is committed.
+///
+/// @param numBytes Number of bytes to reserve.
+/// @return Start of the reserved range or null if there is not enough address space.
+///
+inline void *ReserveVirtualMemory(size_t numBytes)
+{
+#if defined(QI_WINDOWS)
+	return VirtualAlloc(nullptr, numBytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	// MAP_NORESERVE keeps the reservation from counting against the commit limit.
+	void *memory = mmap(nullptr, numBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return (memory != MAP_FAILED) ? memory : nullptr;
+#endif
+}
+
+///
+/// Back part of a reserved range with physical memory. Newly committed pages are zeroed.
+///
+/// @param address Start of the pages to commit.
+/// @param numBytes Number of bytes to commit.
+/// @return True if the pages were committed.
+///
+inline bool CommitVirtualMemory(void *address, size_t numBytes)
+{
+#if defined(QI_WINDOWS)
+	return VirtualAlloc(address, numBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	return mprotect(address, numBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+///
+/// Return the physical memory behind part of a reserved range to the operating system. The
+/// address space stays reserved and can be committed again later.
+///
+/// @param address Start of the pages to decommit.
+/// @param numBytes Number of bytes to decommit.
+///
+inline void DecommitVirtualMemory(void *address, size_t numBytes)
+{
+#if defined(QI_WINDOWS)
+	VirtualFree(address, numBytes, MEM_DECOMMIT);
+#else
+	madvise(address, numBytes, MADV_DONTNEED);
+	mprotect(address, numBytes, PROT_NONE);
+#endif
+}
+
+///
+/// Release a range reserved with ReserveVirtualMemory(), including all of its committed pages.
+///
+/// @param address Start of the reserved range.
+/// @param numBytes Number of bytes that were reserved.
+///
+inline void ReleaseVirtualMemory(void *address, size_t numBytes)
+{
+#if defined(QI_WINDOWS)
+	VirtualFree(address, 0, MEM_RELEASE);
+#else
+	munmap(address, numBytes);
+#endif
+}
+
+///
+/// Where the large pages backing a region came from.
+///
+enum class LargePageSource
+{
+	kNone,        ///< The system did not provide large pages, the region uses regular pages.
+	kExplicit,    ///< The region was allocated from the reserved large page pool (MAP_HUGETLB/MEM_LARGE_PAGES).
+	kTransparent  ///< The region asked the kernel to back it with transparent huge pages (MADV_HUGEPAGE).
+};
+
+static const size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024; ///< Size of the large pages requested by AllocateLargePageMemory().
+
+///
+/// Ask the kernel to back a reserved range with transparent huge pages as it is committed. Only
+/// the parts of the range which cover whole, aligned large pages can be backed by them.
+///
+/// @param address Start of the range.
+/// @param numBytes Size of the range in bytes.
+/// @return True if the system supports transparent huge pages.
+///
+inline bool AdviseLargePages(void *address, size_t numBytes)
+{
+#if !defined(QI_WINDOWS) && defined(MADV_HUGEPAGE)
+	return madvise(address, numBytes, MADV_HUGEPAGE) == 0;
+#else
+	return false;
+#endif
+}
+
+///
+/// Allocate committed memory backed by large pages. Explicit large pages are tried first; if the
+/// system has none available the region is allocated with regular pages aligned to LARGE_PAGE_SIZE
+/// and the kernel is asked to back it with transparent huge pages instead.
+///
+/// @param numBytes Number of bytes to allocate (rounded up to a multiple of LARGE_PAGE_SIZE).
+/// @param source Receives where the large pages came from.
+/// @return Allocated region or null if the system is out of memory.
+///
+inline void *AllocateLargePageMemory(size_t numBytes, LargePageSource &source)
+{
+	numBytes = (numBytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1);
+	source   = LargePageSource::kNone;
+
+#if defined(QI_WINDOWS)
+	// Large pages require the "Lock pages in memory" privilege, fall back to regular pages without it.
+	size_t largePageMinimum = GetLargePageMinimum();
+	if (largePageMinimum > 0 && (numBytes % largePageMinimum) == 0)
+	{
+		void *memory = VirtualAlloc(nullptr, numBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (memory != nullptr)
+		{
+			source = LargePageSource::kExplicit;
+			return memory;
+		}
+	}
+
+	return VirtualAlloc(nullptr, numBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	#if defined(MAP_HUGETLB)
+		void *memory = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			source = LargePageSource::kExplicit;
+			return memory;
+		}
+	#endif
+
+	// Over-allocate so that the region can be trimmed to a large page boundary, the kernel only
+	// uses huge pages for aligned ranges.
+	char *mapping = static_cast<char *>(mmap(nullptr, numBytes + LARGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (mapping == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(mapping) + LARGE_PAGE_SIZE - 1) & ~(uintptr_t)(LARGE_PAGE_SIZE - 1));
+	if (aligned > mapping)
+	{
+		munmap(mapping, aligned - mapping);
+	}
+
+	size_t tail = (mapping + numBytes + LARGE_PAGE_SIZE) - (aligned + numBytes);
+	if (tail > 0)
+	{
+		munmap(aligned + numBytes, tail);
+	}
+
+	if (AdviseLargePages(aligned, numBytes))
+	{
+		source = LargePageSource::kTransparent;
+	}
+
+	return aligned;
+#endif
+}
+
+///
+/// Free memory allocated with AllocateLargePageMemory().
+///
+/// @param address Region to free. If null, this function will not do anything.
+/// @param numBytes Number of bytes that were requested when the region was allocated.
+///
+inline void FreeLargePageMemory(void *address, size_t numBytes)
+{
+	if (address == nullptr)
+	{
+		return;
+	}
+
+#if defined(QI_WINDOWS)
+	VirtualFree(address, 0, MEM_RELEASE);
+#else
+	munmap(address, (numBytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1));
+#endif
+}
+
+///
+/// Count the large pages currently backing a region. Transparent huge pages are only assigned
+/// as the region is touched (and may be split up again by the kernel), so for those this is a
+/// snapshot read from /proc/self/smaps. If the kernel merged the region with a neighboring
+/// mapping the neighbor's huge pages are counted as well.
+///
+/// @param address Start of the region.
+/// @param numBytes Size of the region in bytes.
+/// @param source Where the region's large pages came from.
+/// @return Number of LARGE_PAGE_SIZE pages backing the region.
+///
+inline uint64 GetLargePageCount(const void *address, size_t numBytes, LargePageSource source)
+{
+	if (address == nullptr || source == LargePageSource::kNone)
+	{
+		return 0;
+	}
+
+	if (source == LargePageSource::kExplicit)
+	{
+		return (numBytes + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE;
+	}
+
+	uint64 hugeBytes = 0;
+
+#if !defined(QI_WINDOWS)
+	FILE *smaps = fopen("/proc/self/smaps", "r");
+	if (smaps == nullptr)
+	{
+		return 0;
+	}
+
+	uintptr_t regionStart = reinterpret_cast<uintptr_t>(address);
+	uintptr_t regionEnd   = regionStart + numBytes;
+	bool inRegion = false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), smaps) != nullptr)
+	{
+		unsigned long long start, end, kilobytes;
+		if (sscanf(line, "%llx-%llx ", &start, &end) == 2)
+		{
+			// Header line of the next mapping.
+			inRegion = (start < regionEnd && end > regionStart);
+		}
+		else if (inRegion && sscanf(line, "AnonHugePages: %llu kB", &kilobytes) == 1)
+		{
+			hugeBytes += kilobytes * 1024;
+		}
+	}
+
+	fclose(smaps);
+#endif
+
+	return hugeBytes / LARGE_PAGE_SIZE;
+}
+
+} // namespace Qi
@@ -0,0 +1,250 @@
+//
+//  VirtualRegionAllocator.cpp
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#include "VirtualRegionAllocator.h"
+#include <new>
+
+namespace Qi
+{
+
+VirtualRegionAllocator::VirtualRegionAllocator() :
+	m_reservation(nullptr),
+	m_reservationSize(0),
+	m_region(nullptr),
+	m_slotSize(0),
+	m_numSlots(0),
+	m_pageSize(0),
+	m_largePageSource(LargePageSource::kNone),
+	m_committedBytes(nullptr),
+	m_freeSlots(nullptr),
+	m_numFreeSlots(0),
+	m_bytesInUse(0),
+	m_peakBytesInUse(0),
+	m_initialized(false)
+{
+}
+
+VirtualRegionAllocator::~VirtualRegionAllocator()
+{
+	QI_ASSERT(!m_initialized);
+}
+
+Result VirtualRegionAllocator::Init(const Allocator::Cinfo *info)
+{
+	QI_ASSERT(!m_initialized);
+	QI_ASSERT(info != nullptr);
+
+	const Cinfo *cinfo = static_cast<const Cinfo *>(info);
+	QI_ASSERT(cinfo->maxAllocationSize > 0 && cinfo->maxAllocations > 0);
+
+	// Huge pages are only used for whole, aligned large pages, so commit in those steps and
+	// line the slots up with large page boundaries.
+	m_pageSize = cinfo->useLargePages ? (uint32)LARGE_PAGE_SIZE : (uint32)GetVirtualPageSize();
+	m_slotSize = ((uint64)cinfo->maxAllocationSize + m_pageSize - 1) & ~(uint64)(m_pageSize - 1);
+	m_numSlots = cinfo->maxAllocations;
+
+	m_reservationSize = m_slotSize * m_numSlots + (cinfo->useLargePages ? LARGE_PAGE_SIZE : 0);
+
+	m_committedBytes = static_cast<size_t *>(::operator new(m_numSlots * sizeof(size_t), std::nothrow));
+	m_freeSlots      = static_cast<uint32 *>(::operator new(m_numSlots * sizeof(uint32), std::nothrow));
+	m_reservation    = static_cast<char *>(ReserveVirtualMemory(m_reservationSize));
+	if (m_committedBytes == nullptr || m_freeSlots == nullptr || m_reservation == nullptr)
+	{
+		::operator delete(m_committedBytes);
+		::operator delete(m_freeSlots);
+		if (m_reservation != nullptr)
+		{
+			ReleaseVirtualMemory(m_reservation, m_reservationSize);
+		}
+
+		m_committedBytes = nullptr;
+		m_freeSlots      = nullptr;
+		m_reservation    = nullptr;
+		return Result(ReturnCode::kOutOfMemory);
+	}
+
+	m_region = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(m_reservation) + m_pageSize - 1) & ~(uintptr_t)(m_pageSize - 1));
+
+	m_largePageSource = LargePageSource::kNone;
+	if (cinfo->useLargePages && AdviseLargePages(m_region, m_slotSize * m_numSlots))
+	{
+		m_largePageSource = LargePageSource::kTransparent;
+	}
+
+	// Hand out the lowest slots first.
+	for (uint32 ii = 0; ii < m_numSlots; ++ii)
+	{
+		m_committedBytes[ii] = 0;
+		m_freeSlots[ii]      = m_numSlots - ii - 1;
+	}
+
+	m_numFreeSlots   = m_numSlots;
+	m_bytesInUse     = 0;
+	m_peakBytesInUse = 0;
+	m_initialized    = true;
+
+	return Result(ReturnCode::kSuccess);
+}
+
+void VirtualRegionAllocator::Deinit()
+{
+	QI_ASSERT(m_initialized);
+
+	// Releasing the reservation also releases every committed page.
+	ReleaseVirtualMemory(m_reservation, m_reservationSize);
+	::operator delete(m_committedBytes);
+	::operator delete(m_freeSlots);
+
+	m_reservation     = nullptr;
+	m_reservationSize = 0;
+	m_region          = nullptr;
+	m_largePageSource = LargePageSource::kNone;
+	m_committedBytes  = nullptr;
+	m_freeSlots       = nullptr;
+	m_numSlots        = 0;
+	m_numFreeSlots    = 0;
+	m_initialized     = false;
+}
+
+bool VirtualRegionAllocator::IsInitialized() const
+{
+	return m_initialized;
+}
+
+void *VirtualRegionAllocator::Allocate(size_t numBytes)
+{
+	return AllocateAligned(numBytes, DEFAULT_ALIGNMENT);
+}
+
+void *VirtualRegionAllocator::AllocateAligned(size_t numBytes, uint32 alignment)
+{
+	QI_ASSERT(m_initialized);
+	QI_ASSERT((alignment & (alignment - 1)) == 0);
+
+	// Every slot starts on a page boundary.
+	if (alignment > m_pageSize || numBytes > m_slotSize)
+	{
+		return nullptr;
+	}
+
+	uint32 slotIndex;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_numFreeSlots == 0)
+		{
+			return nullptr;
+		}
+
+		slotIndex = m_freeSlots[--m_numFreeSlots];
+	}
+
+	if (!ResizeSlot(slotIndex, numBytes))
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_freeSlots[m_numFreeSlots++] = slotIndex;
+		return nullptr;
+	}
+
+	return m_region + slotIndex * m_slotSize;
+}
+
+void VirtualRegionAllocator::Deallocate(void *address)
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr)
+	{
+		return;
+	}
+
+	QI_ASSERT(Owns(address));
+	uint32 slotIndex = GetSlotIndex(address);
+
+	// Give the physical memory back to the system, the address space is reused by the next allocation.
+	ResizeSlot(slotIndex, 0);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_freeSlots[m_numFreeSlots++] = slotIndex;
+}
+
+bool VirtualRegionAllocator::TryExpandInPlace(void *address, size_t newNumBytes)
+{
+	QI_ASSERT(m_initialized);
+
+	if (address == nullptr || newNumBytes > m_slotSize)
+	{
+		return false;
+	}
+
+	QI_ASSERT(Owns(address));
+	return ResizeSlot(GetSlotIndex(address), newNumBytes);
+}
+
+size_t VirtualRegionAllocator::GetAllocationSize(const void *address) const
+{
+	QI_ASSERT(m_initialized);
+
+	// Only the owner of an allocation resizes it, so no lock is required.
+	return (address != nullptr) ? m_committedBytes[GetSlotIndex(address)] : 0;
+}
+
+bool VirtualRegionAllocator::Owns(const void *address) const
+{
+	const char *block = static_cast<const char *>(address);
+	return (block >= m_region && block < m_region + m_slotSize * m_numSlots);
+}
+
+void VirtualRegionAllocator::GetStats(AllocatorStats &stats) const
+{
+	stats.largePages = GetLargePageCount(m_region, m_slotSize * m_numSlots, m_largePageSource);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	stats.capacity         = m_slotSize * m_numSlots;
+	stats.bytesInUse       = m_bytesInUse;
+	stats.peakBytesInUse   = m_peakBytesInUse;
+	stats.freeBytes        = stats.capacity - m_bytesInUse;
+	stats.largestFreeBlock = (m_numFreeSlots > 0) ? m_slotSize : 0;
+}
+
+uint32 VirtualRegionAllocator::GetSlotIndex(const void *address) const
+{
+	return (uint32)((static_cast<const char *>(address) - m_region) / m_slotSize);
+}
+
+bool VirtualRegionAllocator::ResizeSlot(uint32 slotIndex, size_t numBytes)
+{
+	uint64 newCommitted = ((uint64)numBytes + m_pageSize - 1) & ~(uint64)(m_pageSize - 1);
+	uint64 oldCommitted = m_committedBytes[slotIndex];
+	char *slot = m_region + slotIndex * m_slotSize;
+
+	if (newCommitted > oldCommitted)
+	{
+		if (!CommitVirtualMemory(slot + oldCommitted, newCommitted - oldCommitted))
+		{
+			return false;
+		}
+	}
+	else if (newCommitted < oldCommitted)
+	{
+		DecommitVirtualMemory(slot + newCommitted, oldCommitted - newCommitted);
+	}
+
+	m_committedBytes[slotIndex] = (size_t)newCommitted;
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_bytesInUse = m_bytesInUse + newCommitted - oldCommitted;
+	if (m_bytesInUse > m_peakBytesInUse)
+	{
+		m_peakBytesInUse = m_bytesInUse;
+	}
+
+	return true;
+}
+
+} // namespace Qi
@@ -0,0 +1,101 @@
+//
+//  VirtualRegionAllocator.h
+//  Qi Game Engine
+//
+//  Created by Cody White on 10/17/26.
+//  Copyright (c) 2026 Cody White. All rights reserved.
+//
+
+#pragma once
+
+///
+/// Implement an allocator which gives every allocation its own range of reserved address space.
+/// A large range is reserved up front and split into fixed-size slots (one per allocation), but only
+/// the pages an allocation actually uses are committed. Growing an allocation commits more pages
+/// behind it and shrinking it decommits the pages it no longer needs, so an allocation never moves:
+/// containers allocated from this allocator grow without copying and pointers into them stay valid.
+/// Every allocation costs at least one page, so install this allocator for categories holding a few
+/// large, growable containers (see MemorySystem::InstallAllocator()) rather than as the general allocator.
+///
+
+#include "Allocator.h"
+#include "VirtualMemory.h"
+#include "../Defines.h"
+#include <mutex>
+
+namespace Qi
+{
+
+class VirtualRegionAllocator : public Allocator
+{
+	public:
+
+		VirtualRegionAllocator();
+		virtual ~VirtualRegionAllocator() override;
+
+		///
+		/// Initialization information for the virtual region allocator.
+		///
+		struct Cinfo : public Allocator::Cinfo
+		{
+			Cinfo() :
+				maxAllocationSize(256 * 1024 * 1024),
+				maxAllocations(64),
+				useLargePages(false)
+			{
+			}
+
+			size_t maxAllocationSize; ///< Largest size (in bytes) any single allocation can grow to. This much address space is reserved per allocation.
+			uint32 maxAllocations;    ///< Number of allocations which can be live at the same time.
+			bool useLargePages;       ///< If true, slots are committed in LARGE_PAGE_SIZE steps and backed by transparent huge pages
+			                          ///  where the system supports them.
+		};
+
+		////////////////////// Functions from Qi::Allocator ////////////////////////////
+		virtual Result Init(const Allocator::Cinfo *info) override;
+		virtual void Deinit() override;
+		virtual bool IsInitialized() const override;
+		virtual void *Allocate(size_t numBytes) override;
+		virtual void *AllocateAligned(size_t numBytes, uint32 alignment) override;
+		virtual void Deallocate(void *address) override;
+		virtual bool TryExpandInPlace(void *address, size_t newNumBytes) override;
+		virtual size_t GetAllocationSize(const void *address) const override;
+		virtual bool Owns(const void *address) const override;
+		virtual void GetStats(AllocatorStats &stats) const override;
+		////////////////////////////////////////////////////////////////////////////////
+
+	private:
+
+		// Do not implement.
+		VirtualRegionAllocator(const VirtualRegionAllocator &other) = delete;
+		VirtualRegionAllocator &operator=(const VirtualRegionAllocator &other) = delete;
+
+		///
+		/// Get the slot an allocation lives in.
+		///
+		inline uint32 GetSlotIndex(const void *address) const;
+
+		///
+		/// Commit or decommit the pages of a slot so that exactly 'numBytes' (rounded up to whole pages) are committed.
+		///
+		/// @return True if the slot now has the requested size.
+		///
+		bool ResizeSlot(uint32 slotIndex, size_t numBytes);
+
+		char   *m_reservation;      ///< Address space reserved from the system (may start before 'm_region' to align it).
+		uint64 m_reservationSize;   ///< Size of 'm_reservation' in bytes.
+		char   *m_region;           ///< Reserved address space holding every slot.
+		uint64 m_slotSize;          ///< Address space reserved per allocation (a multiple of the page size).
+		uint32 m_numSlots;          ///< Number of slots in 'm_region'.
+		uint32 m_pageSize;          ///< Granularity memory is committed with.
+		LargePageSource m_largePageSource; ///< Where the large pages backing the slots come from.
+		size_t *m_committedBytes;   ///< Number of committed bytes of each slot.
+		uint32 *m_freeSlots;        ///< Stack of unused slot indices.
+		uint32 m_numFreeSlots;      ///< Number of entries in 'm_freeSlots'.
+		uint64 m_bytesInUse;        ///< Committed bytes across all slots.
+		uint64 m_peakBytesInUse;    ///< Largest value 'm_bytesInUse' has reached.
+		mutable std::mutex m_lock;  ///< Guards the free slot stack and the usage counters.
+		bool   m_initialized;       ///< If true, this allocator is initialized and ready to use.
+};
+
+} // namespace Qi
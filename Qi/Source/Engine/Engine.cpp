@@ -10,6 +10,9 @@
 #include "../Core/Utility/Logger/Logger.h"
 #include "../Core/Memory/MemorySystem.h"
 #include "../Core/Memory/HeapAllocator.h"
+#include "../Core/Memory/PoolAllocator.h"
+#include "../Core/Memory/TLSFAllocator.h"
+#include "../Core/Memory/VirtualRegionAllocator.h"
 #include "Systems/SystemBase.h"
 #include "Systems/EntitySystem.h"
 #include "Systems/Renderer/RenderingSystem.h"
@@ -22,6 +25,7 @@ namespace Qi
 Engine::Engine() :
     m_initiailzed(false),
     m_shouldShutdown(false),
+    m_defragmentationBudget(0),
 	m_entitySystem(nullptr),
 	m_renderingSystem(nullptr)
 {
@@ -55,16 +59,51 @@ Result Engine::Init(const EngineConfig &config)
 
 	// Initialize the memory allocation system after the logger but before everything else.
 	{
-		// Install a heap allocator for now until more allocators are available, then make
-		// the allocator type optional.
-		HeapAllocator *allocator = new HeapAllocator;
-		allocator->Init(nullptr);
+		Allocator *allocator = nullptr;
+		result = CreateAllocator(config.allocatorType, config.allocatorRegionSize, config.allocatorUseLargePages, &allocator);
+		if (!result.IsValid())
+		{
+			return result;
+		}
+
+		MemorySystem::Cinfo memoryInfo;
+		memoryInfo.allocator          = allocator;
+		memoryInfo.scratchArenaSize   = config.scratchArenaSize;
+		memoryInfo.enableThreadCaches = config.threadCachesEnabled;
+		memoryInfo.trackingCapacity   = config.allocationTrackingCapacity;
+		memoryInfo.profilerSamplingInterval = config.allocationSamplingInterval;
+		memoryInfo.profileReportFilename    = !config.allocationProfileFile.empty() ? config.allocationProfileFile.c_str() : nullptr;
+		memoryInfo.relocatableRegionSize    = config.relocatableRegionSize;
+		memoryInfo.relocatableMaxHandles    = config.relocatableMaxHandles;
 
-		result = MemorySystem::GetInstance().Init(allocator);
+		result = MemorySystem::GetInstance().Init(memoryInfo);
 		if (!result.IsValid())
 		{
 			return result;
 		}
+
+		m_defragmentationBudget = config.defragmentationBudgetMicroseconds;
+
+		// Apply the budget of every category and give categories which asked for it their own allocator.
+		for (uint32 ii = 0; ii < MEMORY_CATEGORY_COUNT; ++ii)
+		{
+			MemorySystem::GetInstance().SetMemoryBudget((MemoryCategory)ii, config.memoryBudgets[ii]);
+
+			const EngineConfig::CategoryAllocatorConfig &categoryConfig = config.categoryAllocators[ii];
+			if (ii == (uint32)MemoryCategory::kGeneral || !categoryConfig.dedicated)
+			{
+				continue;
+			}
+
+			Allocator *categoryAllocator = nullptr;
+			result = CreateAllocator(categoryConfig.type, categoryConfig.regionSize, categoryConfig.useLargePages, &categoryAllocator);
+			if (!result.IsValid())
+			{
+				return result;
+			}
+
+			MemorySystem::GetInstance().InstallAllocator((MemoryCategory)ii, categoryAllocator);
+		}
 	}
     
     Qi_LogInfo("-Initializing engine-");
@@ -102,6 +141,18 @@ bool Engine::Step(const float dt)
         m_engineSystems[ii]->Update(dt);
     }
 
+    // Systems are done dereferencing relocatable handles for this frame, compact a little.
+    MemorySystem::GetInstance().DefragmentRelocatableMemory(m_defragmentationBudget);
+
+    // Report systems which grew past their memory budget this frame.
+    MemorySystem::GetInstance().CheckMemoryBudgets();
+
+    // Give blocks which threads freed for each other but nobody allocated again back to the allocator.
+    MemorySystem::GetInstance().TrimRemoteFrees();
+
+    // All per-frame temporaries are dead at this point, reclaim the scratch arenas.
+    MemorySystem::GetInstance().ResetScratchAllocators();
+
     return true;
 }
 
@@ -119,6 +170,79 @@ void Engine::Shutdown()
     Logger::GetInstance().Deinit();
 }
 
+Result Engine::CreateAllocator(EngineConfig::AllocatorType type, size_t regionSize, bool useLargePages, Allocator **allocator)
+{
+    Result result(ReturnCode::kSuccess);
+    *allocator = nullptr;
+    
+    switch (type)
+    {
+        case EngineConfig::AllocatorType::kHeap:
+        {
+            HeapAllocator *heapAllocator = new HeapAllocator;
+            result = heapAllocator->Init(nullptr);
+            *allocator = heapAllocator;
+            break;
+        }
+            
+        case EngineConfig::AllocatorType::kPool:
+        {
+            PoolAllocator::Cinfo cinfo;
+            cinfo.regionSize    = regionSize;
+            cinfo.useLargePages = useLargePages;
+            
+            PoolAllocator *poolAllocator = new PoolAllocator;
+            result = poolAllocator->Init(&cinfo);
+            *allocator = poolAllocator;
+            break;
+        }
+            
+        case EngineConfig::AllocatorType::kTLSF:
+        {
+            TLSFAllocator::Cinfo cinfo;
+            cinfo.regionSize    = regionSize;
+            cinfo.useLargePages = useLargePages;
+            
+            TLSFAllocator *tlsfAllocator = new TLSFAllocator;
+            result = tlsfAllocator->Init(&cinfo);
+            *allocator = tlsfAllocator;
+            break;
+        }
+
+        case EngineConfig::AllocatorType::kVirtualRegion:
+        {
+            VirtualRegionAllocator::Cinfo cinfo;
+            cinfo.maxAllocationSize = regionSize;
+            cinfo.useLargePages     = useLargePages;
+
+            VirtualRegionAllocator *virtualAllocator = new VirtualRegionAllocator;
+            result = virtualAllocator->Init(&cinfo);
+            *allocator = virtualAllocator;
+            break;
+        }
+            
+        default:
+            QI_ASSERT(0 && "Unsupported allocator type");
+            result.code = ReturnCode::kUnknownError;
+            break;
+    }
+    
+    if (!result.IsValid())
+    {
+        delete *allocator;
+        *allocator = nullptr;
+    }
+    else if (useLargePages)
+    {
+        // Transparent huge pages are only assigned as memory is touched, the final count is logged at shutdown.
+        AllocatorStats stats;
+        (*allocator)->GetStats(stats);
+        Qi_LogInfo("Allocator obtained %llu large pages up front", (unsigned long long)stats.largePages);
+    }
+    
+    return result;
+}
+
 Result Engine::CreateInternalSystems(const EngineConfig &config)
 {
     Result result(ReturnCode::kSuccess);
@@ -29,6 +29,7 @@ namespace Qi
 {
 
 // Forward declarations.
+class Allocator;
 class SystemBase;
 class EntitySystem;
 class RenderingSystem;
@@ -91,6 +92,18 @@ class Engine
         Engine(const Engine &other) = delete;
         Engine &operator=(const Engine &other) = delete;
     
+        ///
+        /// Create and initialize a memory allocator.
+        ///
+        /// @param type Type of allocator to create.
+        /// @param regionSize Size (in bytes) of the region reserved by the allocator (pool and TLSF allocators) or the
+        ///                   largest size of a single allocation (virtual region allocators).
+        /// @param useLargePages If true, back the allocator's memory with large pages where the system provides them.
+        /// @param allocator Initialized allocator, ready to be installed into the memory system.
+        /// @return Creation success.
+        ///
+        Result CreateAllocator(EngineConfig::AllocatorType type, size_t regionSize, bool useLargePages, Allocator **allocator);
+    
         ///
         /// Create the internal systems to handle various engine tasks (rendering, entities, physics, etc.).
         ///
@@ -114,6 +127,7 @@ class Engine
     
         bool m_initiailzed;     ///< If true, the engine has been properly initialized.
         bool m_shouldShutdown;  ///< If true, the engine should shutdown on the next update tick.
+        uint32 m_defragmentationBudget; ///< Microseconds the relocatable allocator may spend compacting each frame.
     
         Array<SystemBase *> m_engineSystems; ///< All engine systems that the engine knows about (both internal and custom systems).
     
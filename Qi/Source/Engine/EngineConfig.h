@@ -15,6 +15,7 @@
 
 #include "../Core/Defines.h"
 #include "../Core/BaseTypes.h"
+#include "../Core/Memory/MemoryCategory.h"
 #include <string>
 
 namespace Qi
@@ -24,15 +25,83 @@ struct EngineConfig
 {
     public:
 
+        ///
+        /// Memory allocators the engine can install into the memory system.
+        ///
+        enum class AllocatorType
+        {
+            kHeap, ///< Forward every allocation to the operating system (development/debugging).
+            kPool, ///< Size-class pool allocator for small allocations (production).
+            kTLSF, ///< Two-level segregated fit allocator with bounded allocation latency (production).
+            kVirtualRegion ///< Reserve address space per allocation and commit pages on demand, allocations grow without ever moving
+                           ///  (dedicated categories holding a few large containers only).
+        };
+
+        ///
+        /// Configuration of a dedicated allocator for a memory category. Categories without
+        /// a dedicated allocator share the general allocator (see 'allocatorType').
+        ///
+        struct CategoryAllocatorConfig
+        {
+            CategoryAllocatorConfig() :
+                dedicated(false),
+                type(AllocatorType::kTLSF),
+                regionSize(16 * 1024 * 1024),
+                useLargePages(false)
+            {}
+
+            bool dedicated;     ///< If true, the category is served by its own allocator.
+            AllocatorType type; ///< Type of the dedicated allocator.
+            size_t regionSize;  ///< Size (in bytes) of the region reserved by the dedicated allocator (pool and TLSF allocators) or the
+                                ///  largest size a single allocation can grow to (virtual region allocators).
+            bool useLargePages; ///< If true, the allocator's memory is backed by 2MB pages where the system provides them (pool, TLSF
+                                ///  and virtual region allocators only). See AllocatorStats::largePages for how many were obtained.
+        };
+
         ///
         /// Initialize the default configuration.
         ///
         EngineConfig() :
-            flushLogFile(false)
-        {}
+            flushLogFile(false),
+            scratchArenaSize(1024 * 1024),
+        #ifdef QI_DEBUG
+            allocatorType(AllocatorType::kHeap),
+        #else
+            allocatorType(AllocatorType::kPool),
+        #endif
+            allocatorRegionSize(64 * 1024 * 1024),
+            allocatorUseLargePages(false),
+            threadCachesEnabled(true),
+            allocationTrackingCapacity(256 * 1024),
+            allocationSamplingInterval(0),
+            relocatableRegionSize(0),
+            relocatableMaxHandles(64 * 1024),
+            defragmentationBudgetMicroseconds(250)
+        {
+            for (uint32 ii = 0; ii < MEMORY_CATEGORY_COUNT; ++ii)
+            {
+                memoryBudgets[ii] = 0;
+            }
+        }
 
-        std::string configFile; ///< Configuration file to use for configuring the engine. If this is not set, the engine will use internal defaults.
-        bool flushLogFile;      ///< If true, the logfile is flushed after each write.
+        std::string configFile;      ///< Configuration file to use for configuring the engine. If this is not set, the engine will use internal defaults.
+        bool flushLogFile;           ///< If true, the logfile is flushed after each write.
+        size_t scratchArenaSize;     ///< Size (in bytes) of the per-thread scratch arenas which are reset at the end of every frame.
+        AllocatorType allocatorType; ///< Allocator to install into the memory system.
+        size_t allocatorRegionSize;  ///< Size (in bytes) of the region reserved up front by the pool and TLSF allocators.
+        bool allocatorUseLargePages; ///< If true, the region of the pool and TLSF allocators is backed by 2MB pages where the system provides them.
+        bool threadCachesEnabled;    ///< If true, small allocations are served from per-thread caches (pool and TLSF allocators only).
+        uint32 allocationTrackingCapacity; ///< Maximum number of live allocations tracked for leak detection (QI_TRACK_ALLOCATIONS builds only).
+        uint32 allocationSamplingInterval; ///< Average number of bytes allocated between two call stack samples of the allocation profiler
+                                           ///  (0 disables it). 512KB keeps the overhead around 1%.
+        std::string allocationProfileFile; ///< If set, the allocation profile is written to this file (pprof heap profile format) at shutdown.
+        size_t relocatableRegionSize;      ///< Size (in bytes) of the memory system's relocatable allocator (0 disables it).
+        uint32 relocatableMaxHandles;      ///< Maximum number of live blocks in the relocatable allocator.
+        uint32 defragmentationBudgetMicroseconds; ///< Time the relocatable allocator may spend compacting itself every frame.
+        uint64 memoryBudgets[MEMORY_CATEGORY_COUNT]; ///< Number of bytes each MemoryCategory is expected to stay below (0 for no budget).
+                                                     ///  Overruns are logged once per frame (see MemorySystem::CheckMemoryBudgets()).
+        CategoryAllocatorConfig categoryAllocators[MEMORY_CATEGORY_COUNT]; ///< Dedicated allocator for each MemoryCategory. The entry for
+                                                                           ///  MemoryCategory::kGeneral is ignored.
 };
 
 } // namespace Qi
@@ -21,7 +21,8 @@ QI_REFLECT_CLASS(EntitySystem)
 }
 
 EntitySystem::EntitySystem() :
-    SystemBase("EntitySystem")
+    SystemBase("EntitySystem"),
+    m_entities(MemoryCategory::kEntities)
 {
 }
 
@@ -35,6 +36,7 @@ Result EntitySystem::Init(const CInfo &cinfo)
 
     Result result(ReturnCode::kSuccess);
 
+    // The entity array grows in pages on demand, the configured count is only reserved up front.
     int maxEntities = 0;
     cinfo.configVariables->GetVariableValue<int>(ConfigVariables::kMaxWorldEntities, maxEntities);
     result = m_entities.SetSize(maxEntities);
@@ -78,9 +80,26 @@ void EntitySystem::RemoveEntity(const Qi::EntitySystem::EntityHandle &handle)
 	m_entities.ReleaseHandle(handle);
 }
 
+Result EntitySystem::CreateEntities(EntityHandle *handles, uint32 count)
+{
+    QI_ASSERT(m_initialized);
+	return m_entities.AcquireHandles(handles, count);
+}
+
+void EntitySystem::RemoveEntities(const EntityHandle *handles, uint32 count)
+{
+    QI_ASSERT(m_initialized);
+	m_entities.ReleaseHandles(handles, count);
+}
+
 Entity &EntitySystem::GetEntity(const EntityHandle &handle)
 {
 	return m_entities.GetElement(handle);
 }
 
+bool EntitySystem::IsValidEntity(const EntityHandle &handle) const
+{
+	return m_entities.IsValid(handle);
+}
+
 } // namespace Qi
@@ -38,7 +38,7 @@ class EntitySystem : public SystemBase
         //////////////////////////////////////////
     
 		typedef TightlyPackedArray<Entity>::Handle EntityHandle;
-		static const EntityHandle INVALID_HANDLE = UINT_MAX;
+		static const EntityHandle INVALID_HANDLE = TightlyPackedArray<Entity>::INVALID_HANDLE;
     
         ///
         /// Reserve an entity for use in the game world.
@@ -55,6 +55,24 @@ class EntitySystem : public SystemBase
         ///
         void RemoveEntity(const EntityHandle &handle);
 
+		///
+		/// Reserve several entities at once, e.g. when spawning a wave.
+		///
+		/// @param handles Receives the handles of the new entities.
+		/// @param count Number of entities to create.
+		/// @return Status (can run out of memory, in which case no entity is created).
+		///
+		Result CreateEntities(EntityHandle *handles, uint32 count);
+
+		///
+		/// Remove several entities at once, packing the remaining entities in a single pass. This
+		/// cannot be called while the entities are being updated.
+		///
+		/// @param handles Handles of the entities to remove.
+		/// @param count Number of handles in 'handles'.
+		///
+		void RemoveEntities(const EntityHandle *handles, uint32 count);
+
 		///
 		/// Get an entity from the system that has already been created.
 		///
@@ -62,6 +80,15 @@ class EntitySystem : public SystemBase
 		/// @return Reference to the internal entity.
 		///
 		Entity &GetEntity(const EntityHandle &handle);
+
+		///
+		/// Check if a handle still references an entity. Handles of removed entities never become
+		/// valid again, so systems can hold on to handles across frames and check them here.
+		///
+		/// @param handle Handle to check.
+		/// @return True if the entity has not been removed.
+		///
+		bool IsValidEntity(const EntityHandle &handle) const;
     
     private:
     